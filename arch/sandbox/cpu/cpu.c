@@ -10,6 +10,7 @@
 #include <errno.h>
 #include <log.h>
 #include <os.h>
+#include <profile.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <asm/malloc.h>
@@ -389,6 +390,21 @@ ulong timer_get_boot_us(void)
 	return (count - base_count) / 1000;
 }
 
+#if IS_ENABLED(CONFIG_PROFILER)
+int arch_profile_start(uint interval_us)
+{
+	if (os_profile_start(interval_us, profile_tick))
+		return -EPERM;
+
+	return 0;
+}
+
+void arch_profile_stop(void)
+{
+	os_profile_stop();
+}
+#endif
+
 int sandbox_load_other_fdt(void **fdtp, int *sizep)
 {
 	const char *orig;
@@ -330,7 +330,8 @@ static void os_sigint_handler(int sig)
 	raise(SIGINT);
 }
 
-static void os_signal_handler(int sig, siginfo_t *info, void *con)
+/* Get the program counter from a signal context */
+static unsigned long os_context_pc(void *con)
 {
 	ucontext_t __maybe_unused *context = con;
 	unsigned long pc;
@@ -349,7 +350,48 @@ static void os_signal_handler(int sig, siginfo_t *info, void *con)
 	pc = 0;
 #endif
 
-	os_signal_action(sig, pc);
+	return pc;
+}
+
+static void os_signal_handler(int sig, siginfo_t *info, void *con)
+{
+	os_signal_action(sig, os_context_pc(con));
+}
+
+static void (*os_profile_handler)(unsigned long pc);
+
+static void os_profile_signal(int sig, siginfo_t *info, void *con)
+{
+	os_profile_handler(os_context_pc(con));
+}
+
+int os_profile_start(unsigned int interval_us,
+		     void (*handler)(unsigned long pc))
+{
+	struct itimerval timer;
+	struct sigaction act;
+
+	os_profile_handler = handler;
+	act.sa_sigaction = os_profile_signal;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	if (sigaction(SIGPROF, &act, NULL))
+		return -1;
+
+	timer.it_interval.tv_sec = interval_us / 1000000;
+	timer.it_interval.tv_usec = interval_us % 1000000;
+	timer.it_value = timer.it_interval;
+
+	return setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+void os_profile_stop(void)
+{
+	struct itimerval timer;
+
+	memset(&timer, '\0', sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	signal(SIGPROF, SIG_IGN);
 }
 
 int os_setup_signal_handlers(void)
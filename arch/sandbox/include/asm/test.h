@@ -239,6 +239,15 @@ uint sandbox_spi_get_speed(struct udevice *dev);
  */
 uint sandbox_spi_get_mode(struct udevice *dev);
 
+/**
+ * sandbox_mmc_get_cmd_count() - Get the number of times a command was sent
+ *
+ * @dev: Sandbox MMC device to check
+ * @cmdidx: Command index (MMC_CMD_...)
+ * Return: number of times the command was sent since the device was probed
+ */
+uint sandbox_mmc_get_cmd_count(struct udevice *dev, uint cmdidx);
+
 /**
  * sandbox_get_pch_spi_protect() - Get the PCI SPI protection status
  *
@@ -784,6 +784,15 @@ int bootdev_setup_iter(struct bootflow_iter *iter, const char *label,
 		if (!ok)
 			return log_msg_ret("ord", -ENOMEM);
 		log_debug("setup labels %p\n", iter->labels);
+
+		/*
+		 * Get slow media going now, so they are ready by the time their
+		 * turn comes. Any error is reported when the hunt completes.
+		 */
+		if (iter->flags & BOOTFLOWIF_HUNT) {
+			ret = bootdev_hunt_start(iter->labels, show);
+			log_debug("- bootdev_hunt_start() ret %d\n", ret);
+		}
 		if (iter->labels) {
 			iter->cur_label = -1;
 			ret = bootdev_next_label(iter, &dev, &method_flags);
@@ -833,36 +842,50 @@ static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show)
 	return 0;
 }
 
+/**
+ * bootdev_hunter_match() - Check whether a hunter matches a label
+ *
+ * @info: Hunter to check
+ * @spec: Label to match, e.g. "mmc0", or NULL for any. Any trailing number is
+ *	ignored
+ * Return: true if the hunter can find bootdevs for @spec
+ */
+static bool bootdev_hunter_match(struct bootdev_hunter *info, const char *spec)
+{
+	const char *name = uclass_get_name(info->uclass);
+	const char *end;
+	size_t len;
+
+	if (!spec)
+		return true;
+	trailing_strtoln_end(spec, NULL, &end);
+	len = end - spec;
+
+	log_debug("looking at %.*s for %s\n", (int)max(strlen(name), len),
+		  spec, name);
+	if (!strncmp(spec, name, max(strlen(name), len)))
+		return true;
+
+	return info->uclass == UCLASS_ETH &&
+		(!strcmp("dhcp", spec) || !strcmp("pxe", spec));
+}
+
 int bootdev_hunt(const char *spec, bool show)
 {
 	struct bootdev_hunter *start;
-	const char *end;
 	int n_ent, i;
 	int result;
-	size_t len;
 
 	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
 	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
 	result = 0;
 
-	len = SIZE_MAX;
-	if (spec) {
-		trailing_strtoln_end(spec, NULL, &end);
-		len = end - spec;
-	}
-
 	for (i = 0; i < n_ent; i++) {
 		struct bootdev_hunter *info = start + i;
-		const char *name = uclass_get_name(info->uclass);
 		int ret;
 
-		log_debug("looking at %.*s for %s\n",
-			  (int)max(strlen(name), len), spec, name);
-		if (spec && strncmp(spec, name, max(strlen(name), len))) {
-			if (info->uclass != UCLASS_ETH ||
-			    (strcmp("dhcp", spec) && strcmp("pxe", spec)))
-				continue;
-		}
+		if (!bootdev_hunter_match(info, spec))
+			continue;
 		ret = bootdev_hunt_drv(info, i, show);
 		if (ret)
 			result = ret;
@@ -871,6 +894,53 @@ int bootdev_hunt(const char *spec, bool show)
 	return result;
 }
 
+int bootdev_hunt_start(const char *const *labels, bool show)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+	int result;
+	int ret;
+
+	/*
+	 * Without a boot order each hunter runs when its priority is reached
+	 * and the scan may stop long before the slow ones, so leave them be
+	 */
+	if (!IS_ENABLED(CONFIG_BOOTSTD_HUNT_START) || !labels)
+		return 0;
+
+	ret = bootstd_get_priv(&std);
+	if (ret)
+		return log_msg_ret("std", ret);
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	result = 0;
+
+	for (i = 0; i < n_ent; i++) {
+		struct bootdev_hunter *info = start + i;
+		const char *const *label;
+
+		if (!info->start || (std->hunters_used & BIT(i)))
+			continue;
+		for (label = labels; *label; label++) {
+			if (bootdev_hunter_match(info, *label))
+				break;
+		}
+		if (!*label)
+			continue;
+
+		log_debug("Starting hunter: %s\n",
+			  uclass_get_name(info->uclass));
+		ret = info->start(info, show);
+		log_debug("  - start result %d\n", ret);
+		if (ret && ret != -ENOENT)
+			result = ret;
+	}
+
+	return result;
+}
+
 int bootdev_unhunt(enum uclass_id id)
 {
 	struct bootdev_hunter *start;
@@ -529,6 +529,14 @@ int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 	if (IS_ENABLED(CONFIG_OF_HAS_PRIOR_STAGE) &&
 	    (bflow->flags & BOOTFLOWF_USE_PRIOR_FDT))
 		printf("Using prior-stage device tree\n");
+	/* Only record what a full scan would find */
+	if (CONFIG_IS_ENABLED(BOOTSTD_CACHE) && iter &&
+	    !(iter->flags & (BOOTFLOWIF_SINGLE_DEV | BOOTFLOWIF_SINGLE_UCLASS |
+			     BOOTFLOWIF_SINGLE_MEDIA |
+			     BOOTFLOWIF_SINGLE_PARTITION))) {
+		ret = bootflow_cache_save(bflow);
+		log_debug("bootflow_cache_save() ret %d\n", ret);
+	}
 	ret = bootflow_boot(bflow);
 	if (!IS_ENABLED(CONFIG_BOOTSTD_FULL)) {
 		printf("Boot failed (err=%d)\n", ret);
@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Remember the last bootflow which was booted, so it can be booted directly
+ * next time, without scanning all bootdevs
+ */
+
+#define LOG_CATEGORY UCLASS_BOOTSTD
+
+#include <blk.h>
+#include <bootdev.h>
+#include <bootflow.h>
+#include <bootstd.h>
+#include <dm.h>
+#include <env.h>
+#include <log.h>
+#include <malloc.h>
+#include <part.h>
+#include <u-boot/crc.h>
+#include <dm/device-internal.h>
+#include <dm/uclass-internal.h>
+
+/* Number of fields in the record */
+#define CACHE_FIELDS	9
+
+/**
+ * bootflow_cache_get_uuid() - Get the UUID of the partition used by a bootflow
+ *
+ * @blk: Block device containing the partition
+ * @part: Partition number (0 for the whole device)
+ * @uuid: Returns the UUID, or "-" if there is none
+ */
+static void bootflow_cache_get_uuid(struct udevice *blk, int part,
+				    char uuid[UUID_STR_LEN + 1])
+{
+	struct disk_partition info;
+
+	strcpy(uuid, "-");
+	if (!CONFIG_IS_ENABLED(PARTITION_UUIDS) || !part)
+		return;
+	if (part_get_info(dev_get_uclass_plat(blk), part, &info))
+		return;
+	if (*disk_partition_uuid(&info))
+		strlcpy(uuid, disk_partition_uuid(&info), UUID_STR_LEN + 1);
+}
+
+/**
+ * bootflow_cache_crc() - Get the CRC32 of the file read by a bootflow
+ *
+ * Some bootmeths only read the file when booting, in which case the size
+ * alone is used to check it
+ *
+ * @bflow: Bootflow to check
+ * Return: CRC32 of the file, or 0 if it has not been read
+ */
+static u32 bootflow_cache_crc(const struct bootflow *bflow)
+{
+	if (!bflow->buf)
+		return 0;
+
+	return crc32(0, (const uchar *)bflow->buf, bflow->size);
+}
+
+/**
+ * bootflow_cache_order() - Get the CRC32 of the bootdev and bootmeth ordering
+ *
+ * This covers the boot_targets and bootmeths variables, or the devicetree
+ * ordering if they are not set, so that the record is not used once the
+ * ordering changes
+ *
+ * @crcp: Returns the CRC32
+ * Return: 0 if OK, -ve on error
+ */
+static int bootflow_cache_order(u32 *crcp)
+{
+	const char *const *labels;
+	struct bootstd_priv *std;
+	struct udevice *bootstd;
+	const char *name;
+	u32 crc = 0;
+	bool ok;
+	int i, ret;
+
+	ret = uclass_first_device_err(UCLASS_BOOTSTD, &bootstd);
+	if (ret)
+		return log_msg_ret("std", ret);
+	std = dev_get_priv(bootstd);
+
+	labels = bootstd_get_bootdev_order(bootstd, &ok);
+	if (!ok)
+		return log_msg_ret("ord", -ENOMEM);
+	for (i = 0; labels && labels[i]; i++) {
+		name = labels[i];
+		crc = crc32(crc, (const uchar *)name, strlen(name) + 1);
+	}
+
+	/* An empty name separates the two lists */
+	crc = crc32(crc, (const uchar *)"", 1);
+	for (i = 0; i < std->bootmeth_count; i++) {
+		name = std->bootmeth_order[i]->name;
+		crc = crc32(crc, (const uchar *)name, strlen(name) + 1);
+	}
+	*crcp = crc;
+
+	return 0;
+}
+
+int bootflow_cache_save(const struct bootflow *bflow)
+{
+	char uuid[UUID_STR_LEN + 1];
+	char rec[BOOTFLOW_CACHE_MAX];
+	struct blk_desc *desc;
+	const char *old;
+	u32 order;
+	int ret;
+
+	/* Only bootflows on block devices can be checked cheaply */
+	if (!bflow->dev || !bflow->blk || !bflow->fname ||
+	    strchr(bflow->fname, ' '))
+		return log_msg_ret("sav", -EOPNOTSUPP);
+
+	ret = bootflow_cache_order(&order);
+	if (ret)
+		return log_msg_ret("ord", ret);
+	desc = dev_get_uclass_plat(bflow->blk);
+	bootflow_cache_get_uuid(bflow->blk, bflow->part, uuid);
+	ret = snprintf(rec, sizeof(rec), "%s %x %s %s %x %08x %s %s %08x",
+		       bflow->dev->name, bflow->part, bflow->method->name,
+		       bflow->fname, bflow->size, bootflow_cache_crc(bflow),
+		       uuid, blk_get_uclass_name(desc->uclass_id), order);
+	if (ret >= sizeof(rec))
+		return log_msg_ret("len", -E2BIG);
+
+	/* Avoid writing to storage unless something changed */
+	old = env_get(BOOTFLOW_CACHE_VAR);
+	if (old && !strcmp(old, rec))
+		return 0;
+
+	ret = env_set(BOOTFLOW_CACHE_VAR, rec);
+	if (ret)
+		return log_msg_ret("set", ret);
+	if (IS_ENABLED(CONFIG_BOOTSTD_CACHE_SAVE)) {
+		ret = env_save();
+		if (ret)
+			return log_msg_ret("env", ret);
+	}
+
+	return 0;
+}
+
+/**
+ * bootflow_cache_find_dev() - Find the bootdev named in the record
+ *
+ * If the bootdev does not exist yet, only the hunter for its media uclass is
+ * run, so that unrelated media (such as the network) are left alone
+ *
+ * @name: Name of the bootdev
+ * @uc_name: Name of the media uclass, e.g. "mmc"
+ * @flags: Iterator flags (BOOTFLOWIF_...)
+ * @devp: Returns the probed bootdev
+ * Return: 0 if OK, -ENODEV if not found, other -ve on error
+ */
+static int bootflow_cache_find_dev(const char *name, const char *uc_name,
+				   int flags, struct udevice **devp)
+{
+	int ret;
+
+	ret = uclass_find_device_by_name(UCLASS_BOOTDEV, name, devp);
+	if (ret && (flags & BOOTFLOWIF_HUNT)) {
+		bootdev_hunt(uc_name, flags & BOOTFLOWIF_SHOW);
+		ret = uclass_find_device_by_name(UCLASS_BOOTDEV, name, devp);
+	}
+	if (ret)
+		return log_msg_ret("dev", -ENODEV);
+
+	return device_probe(*devp);
+}
+
+int bootflow_cache_read(int flags, struct bootflow *bflow)
+{
+	char *field[CACHE_FIELDS];
+	char uuid[UUID_STR_LEN + 1];
+	struct bootflow_iter iter;
+	struct udevice *dev, *meth, *blk;
+	const char *rec;
+	char *buf, *p;
+	u32 order;
+	int ret, i;
+
+	rec = env_get(BOOTFLOW_CACHE_VAR);
+	if (!rec)
+		return log_msg_ret("rec", -ENOENT);
+	buf = strdup(rec);
+	if (!buf)
+		return log_msg_ret("buf", -ENOMEM);
+
+	for (i = 0, p = buf; i < CACHE_FIELDS; i++) {
+		field[i] = strsep(&p, " ");
+		if (!field[i] || !*field[i])
+			break;
+	}
+	if (i != CACHE_FIELDS || p) {
+		ret = log_msg_ret("fmt", -EINVAL);
+		goto err;
+	}
+
+	/* The ordering may now exclude this bootdev or bootmeth */
+	ret = bootflow_cache_order(&order);
+	if (ret)
+		goto err;
+	if (order != hextoul(field[8], NULL)) {
+		ret = log_msg_ret("ord", -ESTALE);
+		goto err;
+	}
+
+	ret = bootflow_cache_find_dev(field[0], field[7], flags, &dev);
+	if (ret)
+		goto err;
+	ret = uclass_get_device_by_name(UCLASS_BOOTMETH, field[2], &meth);
+	if (ret) {
+		ret = log_msg_ret("met", ret);
+		goto err;
+	}
+
+	bootflow_iter_init(&iter, 0);
+	iter.dev = dev;
+	iter.part = hextoul(field[1], NULL);
+	iter.method = meth;
+	iter.first_bootable = -1;
+
+	/* Make sure this is still the same partition */
+	ret = bootdev_get_sibling_blk(dev, &blk);
+	if (ret) {
+		ret = log_msg_ret("blk", ret);
+		goto err;
+	}
+	bootflow_cache_get_uuid(blk, iter.part, uuid);
+	if (strcmp(uuid, field[6])) {
+		ret = log_msg_ret("uid", -ESTALE);
+		goto err;
+	}
+
+	ret = bootdev_get_bootflow(dev, &iter, bflow);
+	if (ret) {
+		bootflow_free(bflow);
+		ret = log_msg_ret("get", ret);
+		goto err;
+	}
+
+	/* ...and that the file is the same */
+	if (bflow->state != BOOTFLOWST_READY || !bflow->fname ||
+	    strcmp(bflow->fname, field[3]) ||
+	    bflow->size != hextoul(field[4], NULL) ||
+	    bootflow_cache_crc(bflow) != hextoul(field[5], NULL)) {
+		bootflow_free(bflow);
+		ret = log_msg_ret("chg", -ESTALE);
+		goto err;
+	}
+	free(buf);
+
+	return 0;
+
+err:
+	free(buf);
+
+	return ret;
+}
+
+int bootflow_cache_boot(int flags)
+{
+	struct bootflow bflow;
+	int ret;
+
+	ret = bootflow_cache_read(flags, &bflow);
+	if (ret) {
+		if (ret != -ENOENT && (flags & BOOTFLOWIF_SHOW))
+			printf("Cached bootflow not usable (err=%dE), scanning\n",
+			       ret);
+		return log_msg_ret("rd", ret);
+	}
+
+	ret = bootflow_run_boot(NULL, &bflow);
+	bootflow_free(&bflow);
+
+	return ret;
+}
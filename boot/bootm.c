@@ -251,13 +251,21 @@ static void boot_start_lmb(struct bootm_headers *images)
 	lmb_init_and_reserve_range(&images->lmb, mem_start,
 				   mem_size, NULL);
 }
+
+static void boot_stop_lmb(struct bootm_headers *images)
+{
+	lmb_uninit(&images->lmb);
+}
 #else
 #define lmb_reserve(lmb, base, size)
 static inline void boot_start_lmb(struct bootm_headers *images) { }
+static inline void boot_stop_lmb(struct bootm_headers *images) { }
 #endif
 
 static int bootm_start(void)
 {
+	/* Free any regions left over from the previous bootm */
+	boot_stop_lmb(&images);
 	memset((void *)&images, 0, sizeof(images));
 	images.verify = env_get_yesno("verify");
 
@@ -706,7 +714,8 @@ static int bootm_load_os(struct bootm_headers *images, int boot_progress)
 			printf("Moving Image from 0x%lx to 0x%lx, end=%lx\n",
 			       load, relocated_addr,
 			       relocated_addr + image_size);
-			memmove((void *)relocated_addr, load_buf, image_size);
+			memmove_wd((void *)relocated_addr, load_buf,
+				   image_size, CHUNKSZ);
 		}
 
 		images->ep = relocated_addr;
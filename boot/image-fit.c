@@ -2283,7 +2283,7 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 		len = load_end - load;
 	} else if (load != data) {
 		loadbuf = map_sysmem(load, len);
-		memcpy(loadbuf, buf, len);
+		memmove_wd(loadbuf, buf, len, CHUNKSZ);
 	}
 
 	if (image_type == IH_TYPE_RAMDISK && comp != IH_COMP_NONE)
@@ -39,6 +39,9 @@ int bootstd_prog_boot(void)
 	flags = BOOTFLOWIF_HUNT | BOOTFLOWIF_SHOW | BOOTFLOWIF_SKIP_GLOBAL;
 
 	bootstd_clear_glob();
+	if (CONFIG_IS_ENABLED(BOOTSTD_CACHE))
+		bootflow_cache_boot(flags);
+
 	for (i = 0, ret = bootflow_scan_first(NULL, NULL, &iter, flags, &bflow);
 	     i < 1000 && ret != -ENODEV;
 	     i++, ret = bootflow_scan_next(&iter, &bflow)) {
@@ -201,6 +201,12 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		bootdev_clear_bootflows(dev);
 	else
 		bootstd_clear_glob();
+
+	/* Try the last bootflow which was booted, before scanning */
+	if (CONFIG_IS_ENABLED(BOOTSTD_CACHE) && boot && !menu && !all &&
+	    !dev && !label)
+		bootflow_cache_boot(flags);
+
 	for (i = 0,
 	     ret = bootflow_scan_first(dev, label, &iter, flags, &bflow);
 	     i < 1000 && ret != -ENODEV;
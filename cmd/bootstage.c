@@ -59,10 +59,31 @@ static int do_bootstage_stash(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+static int do_bootstage_trace(struct cmd_tbl *cmdtp, int flag, int argc,
+			      char *const argv[])
+{
+	enum bootstage_trace_fmt fmt = BOOTSTAGE_TRACE_FOLDED;
+
+	if (argc > 1) {
+		if (!strcmp(argv[1], "json"))
+			fmt = BOOTSTAGE_TRACE_JSON;
+		else if (strcmp(argv[1], "folded"))
+			return CMD_RET_USAGE;
+	}
+	bootstage_trace_print(fmt);
+
+	return 0;
+}
+#endif
+
 static struct cmd_tbl cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+	U_BOOT_CMD_MKENT(trace, 2, 1, do_bootstage_trace, "", ""),
+#endif
 };
 
 /*
@@ -93,4 +114,7 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	"report                      - Print a report\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
 	"unstash [<start> [<size>]]  - Unstash data from memory"
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+	"\ntrace [folded | json]       - Print initcall and probe timings"
+#endif
 );
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Bounce buffer statistics
+ */
+
+#include <common.h>
+#include <bouncebuf.h>
+#include <command.h>
+
+static int do_bouncebuf_show(struct cmd_tbl *cmdtp, int flag, int argc,
+			     char *const argv[])
+{
+	struct bounce_buffer_stats stats;
+
+	bounce_buffer_stats(&stats);
+
+	printf("sessions: %lu\n"
+	       "bounced: %lu\n"
+	       "bounced bytes: %llu\n"
+	       "shifted bytes: %llu\n",
+	       stats.sessions, stats.bounced,
+	       (unsigned long long)stats.bounced_bytes,
+	       (unsigned long long)stats.shifted_bytes);
+
+	return 0;
+}
+
+static int do_bouncebuf_reset(struct cmd_tbl *cmdtp, int flag, int argc,
+			      char *const argv[])
+{
+	bounce_buffer_reset_stats();
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(bouncebuf,
+	"show - show statistics\n"
+	"bouncebuf reset - reset statistics");
+
+U_BOOT_CMD_WITH_SUBCMDS(bouncebuf, "bounce buffer statistics",
+	bouncebuf_help_text,
+	U_BOOT_SUBCMD_MKENT(show, 1, 1, do_bouncebuf_show),
+	U_BOOT_SUBCMD_MKENT(reset, 1, 1, do_bouncebuf_reset));
@@ -11,12 +11,66 @@
 
 #include <common.h>
 #include <command.h>
+#include <div64.h>
 #include <env.h>
 #include <mapmem.h>
+#include <time.h>
 #include <asm/io.h>
+#include <u-boot/crc.h>
 
 #include <lzma/LzmaTools.h>
 
+static const struct lzmadec_bench {
+	const char *name;
+	int (*decompress)(unsigned char *out, SizeT *out_size,
+			  const unsigned char *in, SizeT in_size);
+} lzmadec_bench_decoders[] = {
+	{ "generic", lzmaBuffToBuffDecompressGeneric },
+	{ "fast", lzmaBuffToBuffDecompress },
+};
+
+static int do_lzmadec_bench(int argc, char *const argv[])
+{
+	SizeT dst_len = ~0UL, size;
+	ulong src, dst, us;
+	uint crc, first_crc = 0;
+	int ret, i;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	src = hextoul(argv[0], NULL);
+	dst = hextoul(argv[1], NULL);
+	if (argc > 2)
+		dst_len = hextoul(argv[2], NULL);
+
+	printf("%-8s %10s %-8s %10s %10s\n", "Decoder", "Size", "CRC32",
+	       "Time (us)", "MB/s");
+	for (i = 0; i < ARRAY_SIZE(lzmadec_bench_decoders); i++) {
+		const struct lzmadec_bench *bench = &lzmadec_bench_decoders[i];
+		unsigned char *buf = map_sysmem(dst, dst_len);
+
+		size = dst_len;
+		us = timer_get_us();
+		ret = bench->decompress(buf, &size, map_sysmem(src, 0), ~0UL);
+		us = max(timer_get_us() - us, 1UL);
+		if (ret != SZ_OK) {
+			printf("%s: error %d\n", bench->name, ret);
+			return CMD_RET_FAILURE;
+		}
+		crc = crc32(0, buf, size);
+		printf("%-8s %10lx %08x %10lu %10llu\n", bench->name,
+		       (ulong)size, crc, us, lldiv((u64)size, us));
+		if (i && crc != first_crc) {
+			printf("Output differs from %s decoder\n",
+			       lzmadec_bench_decoders[0].name);
+			return CMD_RET_FAILURE;
+		}
+		first_crc = crc;
+	}
+
+	return 0;
+}
+
 static int do_lzmadec(struct cmd_tbl *cmdtp, int flag, int argc,
 		      char *const argv[])
 {
@@ -24,6 +78,10 @@ static int do_lzmadec(struct cmd_tbl *cmdtp, int flag, int argc,
 	SizeT src_len = ~0UL, dst_len = ~0UL;
 	int ret;
 
+	if (IS_ENABLED(CONFIG_LZMADEC_BENCH) && argc > 1 &&
+	    !strcmp(argv[1], "-b"))
+		return do_lzmadec_bench(argc - 2, argv + 2);
+
 	switch (argc) {
 	case 4:
 		dst_len = hextoul(argv[3], NULL);
@@ -48,8 +106,18 @@ static int do_lzmadec(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#ifdef CONFIG_LZMADEC_BENCH
+#define LZMADEC_MAXARGS	5
+#else
+#define LZMADEC_MAXARGS	4
+#endif
+
 U_BOOT_CMD(
-	lzmadec,    4,    1,    do_lzmadec,
+	lzmadec,    LZMADEC_MAXARGS,    1,    do_lzmadec,
 	"lzma uncompress a memory region",
 	"srcaddr dstaddr [dstsize]"
+#ifdef CONFIG_LZMADEC_BENCH
+	"\nlzmadec -b srcaddr dstaddr [dstsize]\n"
+	"    - time the generic and fast decoders and check they agree"
+#endif
 );
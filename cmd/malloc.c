@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * malloc() usage and statistics
+ */
+
+#include <command.h>
+#include <display_options.h>
+#include <malloc.h>
+#include <vsprintf.h>
+
+static void show_size(const char *name, ulong size)
+{
+	printf("%-14s= ", name);
+	print_size(size, "\n");
+}
+
+static int do_malloc_info(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	struct malloc_info info;
+	int i;
+
+	malloc_get_info(&info);
+	show_size("total bytes", info.total_bytes);
+	show_size("system bytes", info.system_bytes);
+	show_size("peak bytes", info.peak_bytes);
+	show_size("in use bytes", info.in_use_bytes);
+	show_size("free bytes", info.free_bytes);
+	show_size("largest free", info.largest_free);
+	if (IS_ENABLED(CONFIG_SYS_MALLOC_SMALL_CACHE))
+		show_size("cached bytes", info.cached_bytes);
+	printf("%-14s= %lu\n", "free chunks", info.free_chunks);
+	if (info.free_bytes) {
+		printf("%-14s= %lu%%\n", "fragmentation",
+		       100 - (ulong)((u64)info.largest_free * 100 /
+				     info.free_bytes));
+	}
+
+	printf("%-14s= %lu", "allocations", info.calls);
+	if (IS_ENABLED(CONFIG_SYS_MALLOC_SMALL_CACHE))
+		printf(" (%lu from cache)", info.cache_hits);
+	printf("\n\n%12s  %10s\n", "chunk size", "count");
+	for (i = 0; i < MALLOC_INFO_CLASSES; i++) {
+		ulong size = 16UL << i;
+		char buf[12];
+
+		if (!info.class_count[i])
+			continue;
+		if (i == MALLOC_INFO_CLASSES - 1)
+			snprintf(buf, sizeof(buf), "> %lu", size / 2);
+		else
+			snprintf(buf, sizeof(buf), "<= %lu", size);
+		printf("%12s  %10lu\n", buf, info.class_count[i]);
+	}
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(malloc,
+	"info - show malloc() usage and statistics");
+
+U_BOOT_CMD_WITH_SUBCMDS(malloc, "malloc() information", malloc_help_text,
+	U_BOOT_SUBCMD_MKENT(info, 1, 1, do_malloc_info));
@@ -17,6 +17,8 @@
 #include <command.h>
 #include <console.h>
 #include <display_options.h>
+#include <div64.h>
+#include <dma.h>
 #ifdef CONFIG_MTD_NOR_FLASH
 #include <flash.h>
 #endif
@@ -25,12 +27,14 @@
 #include <mapmem.h>
 #include <rand.h>
 #include <watchdog.h>
+#include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <linux/bitops.h>
 #include <linux/compiler.h>
 #include <linux/ctype.h>
 #include <linux/delay.h>
+#include <u-boot/crc.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -359,13 +363,69 @@ static int do_mem_cp(struct cmd_tbl *cmdtp, int flag, int argc,
 	}
 #endif
 
-	memmove(dst, src, count * size);
+	if (dma_memcpy_offload(dst, src, count * size, 0))
+		memmove(dst, src, count * size);
 
 	unmap_sysmem(src);
 	unmap_sysmem(dst);
 	return 0;
 }
 
+#ifdef CONFIG_CMD_CPBENCH
+static void print_copy_rate(const char *name, ulong len, ulong us)
+{
+	printf("%s: %lu us", name, us);
+	if (us)
+		printf(", %llu KiB/s", (u64)len * 1000000 / 1024 / us);
+	printf("\n");
+}
+
+static int do_mem_cpbench(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	ulong addr, dest, len, cpu_us, dma_us;
+	void *src, *dst;
+	int ret;
+
+	if (argc != 4)
+		return CMD_RET_USAGE;
+
+	addr = hextoul(argv[1], NULL) + base_address;
+	dest = hextoul(argv[2], NULL) + base_address;
+	len = hextoul(argv[3], NULL);
+	if (!len)
+		return CMD_RET_USAGE;
+	if ((addr | dest | len) & (ARCH_DMA_MINALIGN - 1)) {
+		printf("Addresses and count must be aligned to %d bytes\n",
+		       ARCH_DMA_MINALIGN);
+		return CMD_RET_FAILURE;
+	}
+
+	src = map_sysmem(addr, len);
+	dst = map_sysmem(dest, len);
+
+	cpu_us = timer_get_us();
+	memmove(dst, src, len);
+	cpu_us = timer_get_us() - cpu_us;
+
+	dma_us = timer_get_us();
+	ret = dma_memcpy(dst, src, len);
+	dma_us = timer_get_us() - dma_us;
+
+	unmap_sysmem(src);
+	unmap_sysmem(dst);
+
+	print_copy_rate("cpu", len, cpu_us);
+	if (ret < 0) {
+		printf("dma: failed (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+	print_copy_rate("dma", len, dma_us);
+
+	return 0;
+}
+#endif
+
 #ifdef CONFIG_CMD_MEM_SEARCH
 static int do_mem_search(struct cmd_tbl *cmdtp, int flag, int argc,
 			 char *const argv[])
@@ -1241,6 +1301,71 @@ mod_mem(struct cmd_tbl *cmdtp, int incrflag, int flag, int argc,
 
 #ifdef CONFIG_CMD_CRC32
 
+#ifdef CONFIG_CRC32_BENCH
+static uint crc_bench_crc32(const uchar *buf, ulong len)
+{
+	return crc32(0, buf, len);
+}
+
+#ifdef CONFIG_CRC32C
+static uint crc_bench_crc32c(const uchar *buf, ulong len)
+{
+	return ~crc32c(~0U, buf, len);
+}
+#endif
+
+static uint crc_bench_crc16_ccitt(const uchar *buf, ulong len)
+{
+	return crc16_ccitt(0, buf, len);
+}
+
+static const struct crc_bench {
+	const char *name;
+	uint (*calc)(const uchar *buf, ulong len);
+} crc_bench_algos[] = {
+	{ "crc32", crc_bench_crc32 },
+#ifdef CONFIG_CRC32C
+	{ "crc32c", crc_bench_crc32c },
+#endif
+	{ "crc16-ccitt", crc_bench_crc16_ccitt },
+};
+
+static int do_mem_crc_bench(int argc, char *const argv[])
+{
+	ulong addr, len, us;
+	const uchar *buf;
+	uint loops, i, j;
+	uint crc = 0;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	addr = hextoul(argv[0], NULL);
+	len = hextoul(argv[1], NULL);
+	loops = argc > 2 ? dectoul(argv[2], NULL) : 1;
+	if (!loops || len > INT_MAX)
+		return CMD_RET_USAGE;
+
+	buf = map_sysmem(addr, len);
+	printf("%-12s %-8s %10s %10s\n", "Algorithm", "CRC", "Time (us)",
+	       "MB/s");
+	for (i = 0; i < ARRAY_SIZE(crc_bench_algos); i++) {
+		const struct crc_bench *bench = &crc_bench_algos[i];
+
+		us = timer_get_us();
+		for (j = 0; j < loops; j++)
+			crc = bench->calc(buf, len);
+		us = max(timer_get_us() - us, 1UL);
+		printf("%-12s %08x %10lu %10llu\n", bench->name, crc, us,
+		       lldiv((u64)len * loops, us));
+		if (ctrlc())
+			break;
+	}
+	unmap_sysmem(buf);
+
+	return 0;
+}
+#endif
+
 static int do_mem_crc(struct cmd_tbl *cmdtp, int flag, int argc,
 		      char *const argv[])
 {
@@ -1253,6 +1378,10 @@ static int do_mem_crc(struct cmd_tbl *cmdtp, int flag, int argc,
 
 	av = argv + 1;
 	ac = argc - 1;
+#ifdef CONFIG_CRC32_BENCH
+	if (!strcmp(*av, "-b"))
+		return do_mem_crc_bench(ac - 1, av + 1);
+#endif
 #ifdef CONFIG_CRC32_VERIFY
 	if (strcmp(*av, "-v") == 0) {
 		flags |= HASH_FLAG_VERIFY | HASH_FLAG_ENV;
@@ -1342,6 +1471,14 @@ U_BOOT_CMD(
 	"[.b, .w, .l" HELP_Q "] source target count"
 );
 
+#ifdef CONFIG_CMD_CPBENCH
+U_BOOT_CMD(
+	cpbench,	4,	0,	do_mem_cpbench,
+	"compare CPU and DMA memory copy speed",
+	"source target count\n    - copy 'count' bytes with each method"
+);
+#endif
+
 U_BOOT_CMD(
 	cmp,	4,	1,	do_mem_cmp,
 	"memory compare",
@@ -1360,25 +1497,25 @@ U_BOOT_CMD(
 
 #ifdef CONFIG_CMD_CRC32
 
-#ifndef CONFIG_CRC32_VERIFY
+#if defined(CONFIG_CRC32_VERIFY) || defined(CONFIG_CRC32_BENCH)
+#define CRC32_MAXARGS	5
+#else
+#define CRC32_MAXARGS	4
+#endif
 
 U_BOOT_CMD(
-	crc32,	4,	1,	do_mem_crc,
+	crc32,	CRC32_MAXARGS,	1,	do_mem_crc,
 	"checksum calculation",
 	"address count [addr]\n    - compute CRC32 checksum [save at addr]"
+#ifdef CONFIG_CRC32_VERIFY
+	"\n-v address count crc\n    - verify crc of memory area"
+#endif
+#ifdef CONFIG_CRC32_BENCH
+	"\n-b address count [loops]\n"
+	"    - time each CRC algorithm over memory area, 'loops' times"
+#endif
 );
 
-#else	/* CONFIG_CRC32_VERIFY */
-
-U_BOOT_CMD(
-	crc32,	5,	1,	do_mem_crc,
-	"checksum calculation",
-	"address count [addr]\n    - compute CRC32 checksum [save at addr]\n"
-	"-v address count crc\n    - verify crc of memory area"
-);
-
-#endif	/* CONFIG_CRC32_VERIFY */
-
 #endif
 
 #ifdef CONFIG_CMD_MEMINFO
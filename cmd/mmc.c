@@ -429,7 +429,8 @@ static int do_mmc_sparse_write(struct cmd_tbl *cmdtp, int flag,
 	sparse.mssg = NULL;
 	sprintf(dest, "0x" LBAF, sparse.start * sparse.blksz);
 
-	if (write_sparse_image(&sparse, dest, addr, NULL))
+	/* The image size is not given, so rely on its chunk headers */
+	if (write_sparse_image(&sparse, dest, addr, SIZE_MAX, NULL))
 		return CMD_RET_FAILURE;
 	else
 		return CMD_RET_SUCCESS;
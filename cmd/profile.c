@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Statistical profiler command
+ */
+
+#include <command.h>
+#include <errno.h>
+#include <malloc.h>
+#include <profile.h>
+#include <vsprintf.h>
+
+enum {
+	DEFAULT_INTERVAL_US	= 1000,
+	DEFAULT_COUNT		= 20,
+};
+
+static int do_profile_start(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	enum profile_src src = PROFILE_SRC_TIMER;
+	uint interval_us = DEFAULT_INTERVAL_US;
+	int ret;
+
+	if (argc > 1 && !strcmp(argv[1], "-p")) {
+		src = PROFILE_SRC_POLL;
+		argc--;
+		argv++;
+	}
+	if (argc > 1)
+		interval_us = dectoul(argv[1], NULL);
+	if (!interval_us)
+		return CMD_RET_USAGE;
+
+	ret = profile_start(src, interval_us);
+	if (ret == -ENOSYS && src == PROFILE_SRC_TIMER) {
+		printf("No profiling timer, sampling calls to schedule()\n");
+		src = PROFILE_SRC_POLL;
+		ret = profile_start(src, interval_us);
+	}
+	if (ret) {
+		printf("Cannot start profiling (err=%dE)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_profile_stop(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	profile_stop();
+
+	return 0;
+}
+
+static int do_profile_show(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	struct profile_entry *ent;
+	struct profile_info info;
+	int count = DEFAULT_COUNT;
+	const char *unit;
+	int i;
+
+	if (argc > 1)
+		count = dectoul(argv[1], NULL);
+	if (count <= 0)
+		return CMD_RET_USAGE;
+
+	profile_get_info(&info);
+	unit = info.src == PROFILE_SRC_POLL ? "us" : "samples";
+	if (info.src == PROFILE_SRC_POLL)
+		printf("poll: %lu us in %lu samples, %lu us dropped",
+		       info.total, info.samples, info.dropped);
+	else
+		printf("timer: %lu samples, %lu dropped", info.samples,
+		       info.dropped);
+	printf("%s\n", info.active ? " (running)" : "");
+	if (!info.total)
+		return 0;
+
+	ent = calloc(count, sizeof(*ent));
+	if (!ent)
+		return CMD_RET_FAILURE;
+	count = profile_get_top(ent, count);
+	if (count < 0) {
+		free(ent);
+		return CMD_RET_FAILURE;
+	}
+
+	printf("%12s  %6s  %s\n", unit, "%", "Address");
+	for (i = 0; i < count; i++) {
+		ulong permille = ent[i].weight * 1000 / info.total;
+
+		printf("%12lu  %4lu.%lu  %08lx\n", ent[i].weight,
+		       permille / 10, permille % 10, ent[i].pc);
+	}
+	free(ent);
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(profile,
+	"start [-p] [<interval_us>] - discard samples and start sampling\n"
+	"      -p: sample calls to schedule() instead of using a timer\n"
+	"profile stop - stop sampling\n"
+	"profile show [<count>] - show the addresses with most samples");
+
+U_BOOT_CMD_WITH_SUBCMDS(profile, "statistical profiler", profile_help_text,
+	U_BOOT_SUBCMD_MKENT(start, 3, 1, do_profile_start),
+	U_BOOT_SUBCMD_MKENT(stop, 1, 1, do_profile_stop),
+	U_BOOT_SUBCMD_MKENT(show, 2, 1, do_profile_show));
@@ -14,6 +14,7 @@
 #include <common.h>
 #include <bootstage.h>
 #include <hang.h>
+#include <kallsyms.h>
 #include <log.h>
 #include <malloc.h>
 #include <sort.h>
@@ -36,15 +37,48 @@ struct bootstage_record {
 	enum bootstage_id id;
 };
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+enum {
+	SPAN_COUNT	= CONFIG_BOOTSTAGE_TRACE_COUNT,
+	SPAN_NAME_LEN	= 16,
+};
+
+/**
+ * struct bootstage_span - Timing of one initcall or device probe
+ *
+ * @start_us: Time when the span started
+ * @time_us: Duration of the span, or 0 if it is still open
+ * @addr: Address of the initcall, if @name is empty
+ * @parent: Span number of the parent span + 1, or 0 if none
+ * @kind: Kind of span (enum bootstage_span_kind)
+ * @name: Name of the span, truncated if needed
+ */
+struct bootstage_span {
+	u32 start_us;
+	u32 time_us;
+	ulong addr;
+	u16 parent;
+	u8 kind;
+	char name[SPAN_NAME_LEN];
+};
+#endif
+
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
 	struct bootstage_record record[RECORD_COUNT];
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+	uint span_count;	/* Number of spans recorded */
+	uint span_dropped;	/* Number of spans not recorded, due to space */
+	uint span_cur;		/* Currently open span + 1, or 0 if none */
+	struct bootstage_span span[SPAN_COUNT];
+#endif
 };
 
 enum {
 	BOOTSTAGE_VERSION	= 0,
 	BOOTSTAGE_MAGIC		= 0xb00757a3,
+	BOOTSTAGE_TRACE_MAGIC	= 0xb00757ac,
 	BOOTSTAGE_DIGITS	= 9,
 };
 
@@ -56,6 +90,12 @@ struct bootstage_hdr {
 	u32 next_id;		/* Next ID to use for bootstage */
 };
 
+/* Follows the name strings in a stash, if there are any spans */
+struct bootstage_trace_hdr {
+	u32 magic;		/* BOOTSTAGE_TRACE_MAGIC */
+	u32 count;		/* Number of spans */
+};
+
 int bootstage_relocate(void)
 {
 	struct bootstage_data *data = gd->bootstage;
@@ -381,6 +421,215 @@ static void append_data(char **ptrp, char *end, const void *data, int size)
 	memcpy(ptr, data, size);
 }
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+int bootstage_span_begin(enum bootstage_span_kind kind, const char *name,
+			 ulong addr)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+
+	if (!data)
+		return -ENOENT;
+	if (data->span_count >= SPAN_COUNT) {
+		data->span_dropped++;
+		return -ENOSPC;
+	}
+	span = &data->span[data->span_count];
+	span->time_us = 0;
+	span->addr = addr;
+	span->parent = data->span_cur;
+	span->kind = kind;
+	if (name)
+		strlcpy(span->name, name, sizeof(span->name));
+	else
+		span->name[0] = '\0';
+	data->span_cur = ++data->span_count;
+	span->start_us = timer_get_boot_us();
+
+	return data->span_count - 1;
+}
+
+void bootstage_span_end(int num)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+	u32 now = timer_get_boot_us();
+
+	if (num < 0 || !data || num >= data->span_count)
+		return;
+	span = &data->span[num];
+
+	/* Make sure a zero-length span does not look like an open one */
+	span->time_us = max(now - span->start_us, 1U);
+	data->span_cur = span->parent;
+}
+
+static const char *get_span_name(char *buf, int len,
+				 const struct bootstage_span *span)
+{
+	if (span->name[0])
+		return span->name;
+	if (IS_ENABLED(CONFIG_KALLSYMS)) {
+		const char *sym;
+		ulong base;
+
+		sym = symbol_lookup(span->addr, &base);
+		if (sym && base == span->addr)
+			return sym;
+	}
+	snprintf(buf, len, "%lx", span->addr);
+
+	return buf;
+}
+
+/* Get the duration of a span, treating open spans as ending now */
+static u32 get_span_time(const struct bootstage_span *span)
+{
+	if (span->time_us)
+		return span->time_us;
+
+	return (u32)timer_get_boot_us() - span->start_us;
+}
+
+static void print_span_stack(const struct bootstage_data *data, uint num)
+{
+	const struct bootstage_span *span = &data->span[num];
+	char buf[20];
+
+	if (span->parent) {
+		print_span_stack(data, span->parent - 1);
+		putc(';');
+	}
+	puts(get_span_name(buf, sizeof(buf), span));
+}
+
+static void print_trace_folded(const struct bootstage_data *data)
+{
+	uint i, j;
+
+	for (i = 0; i < data->span_count; i++) {
+		u32 self = get_span_time(&data->span[i]);
+		u32 child;
+
+		/*
+		 * Children always come after their parent. Timer rounding can
+		 * make them add up to more than the parent, so stop at zero.
+		 */
+		for (j = i + 1; j < data->span_count; j++) {
+			if (data->span[j].parent == i + 1) {
+				child = get_span_time(&data->span[j]);
+				self -= min(self, child);
+			}
+		}
+		print_span_stack(data, i);
+		printf(" %u\n", self);
+	}
+
+	/* Flame-graph tools skip lines which do not end in a number */
+	if (data->span_dropped)
+		printf("# %u spans dropped, increase CONFIG_BOOTSTAGE_TRACE_COUNT\n",
+		       data->span_dropped);
+}
+
+static void print_trace_json(const struct bootstage_data *data)
+{
+	static const char *const kind_name[] = {
+		[BOOTSTAGE_SPAN_INITCALL]	= "initcall",
+		[BOOTSTAGE_SPAN_EVENT]		= "event",
+		[BOOTSTAGE_SPAN_PROBE]		= "probe",
+	};
+	const struct bootstage_record *rec;
+	const char *sep = "";
+	char buf[20];
+	uint i;
+
+	puts("{\"traceEvents\":[\n");
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (rec->start_us || (rec->id != BOOTSTAGE_ID_AWAKE &&
+				      !rec->time_us))
+			continue;
+		printf("%s{\"name\":\"%s\",\"cat\":\"mark\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%lu,\"pid\":1,\"tid\":1}",
+		       sep, get_record_name(buf, sizeof(buf), rec),
+		       rec->time_us);
+		sep = ",\n";
+	}
+	for (i = 0; i < data->span_count; i++) {
+		const struct bootstage_span *span = &data->span[i];
+
+		printf("%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,\"pid\":1,\"tid\":1}",
+		       sep, get_span_name(buf, sizeof(buf), span),
+		       kind_name[span->kind], span->start_us,
+		       get_span_time(span));
+		sep = ",\n";
+	}
+	puts("\n],");
+	if (data->span_dropped)
+		printf("\"otherData\":{\"droppedSpans\":%u},",
+		       data->span_dropped);
+	puts("\"displayTimeUnit\":\"ms\"}\n");
+}
+
+void bootstage_trace_print(enum bootstage_trace_fmt fmt)
+{
+	const struct bootstage_data *data = gd->bootstage;
+
+	if (fmt == BOOTSTAGE_TRACE_JSON)
+		print_trace_json(data);
+	else
+		print_trace_folded(data);
+}
+
+static void stash_spans(char **ptrp, char *end)
+{
+	const struct bootstage_data *data = gd->bootstage;
+	struct bootstage_trace_hdr thdr;
+
+	if (!data->span_count)
+		return;
+	thdr.magic = BOOTSTAGE_TRACE_MAGIC;
+	thdr.count = data->span_count;
+	append_data(ptrp, end, &thdr, sizeof(thdr));
+	append_data(ptrp, end, data->span, data->span_count *
+		    sizeof(struct bootstage_span));
+}
+
+static void unstash_spans(const char *ptr, const char *end)
+{
+	const struct bootstage_trace_hdr *thdr = (void *)ptr;
+	struct bootstage_data *data = gd->bootstage;
+	const struct bootstage_span *from;
+	uint i, base = data->span_count;
+
+	if (ptr + sizeof(*thdr) > end || thdr->magic != BOOTSTAGE_TRACE_MAGIC)
+		return;
+	from = (void *)(thdr + 1);
+	if ((char *)(from + thdr->count) > end)
+		return;
+
+	for (i = 0; i < thdr->count; i++, from++) {
+		struct bootstage_span *span;
+
+		if (data->span_count >= SPAN_COUNT) {
+			data->span_dropped += thdr->count - i;
+			break;
+		}
+		span = &data->span[data->span_count++];
+		*span = *from;
+		if (span->parent)
+			span->parent += base;
+	}
+	debug("Unstashed %d spans\n", data->span_count - base);
+}
+#else
+static inline void stash_spans(char **ptrp, char *end)
+{
+}
+
+static inline void unstash_spans(const char *ptr, const char *end)
+{
+}
+#endif
+
 int bootstage_stash(void *base, int size)
 {
 	const struct bootstage_data *data = gd->bootstage;
@@ -416,6 +665,8 @@ int bootstage_stash(void *base, int size)
 		append_data(&ptr, end, name, strlen(name) + 1);
 	}
 
+	stash_spans(&ptr, end);
+
 	/* Check for buffer overflow */
 	if (ptr > end) {
 		debug("%s: Not enough space for bootstage stash\n", __func__);
@@ -493,6 +744,7 @@ int bootstage_unstash(const void *base, int size)
 		/* Assume no data corruption here */
 		ptr += strlen(ptr) + 1;
 	}
+	unstash_spans(ptr, (char *)base + hdr->size);
 
 	/* Mark the records as read */
 	data->rec_count += hdr->count;
@@ -14,6 +14,8 @@
 #include <asm/cache.h>
 #include <linux/dma-mapping.h>
 
+static struct bounce_buffer_stats bb_stats;
+
 static int addr_aligned(struct bounce_buffer *state)
 {
 	const ulong align_mask = ARCH_DMA_MINALIGN - 1;
@@ -24,8 +26,12 @@ static int addr_aligned(struct bounce_buffer *state)
 		return 0;
 	}
 
-	/* Check if length is aligned */
-	if (state->len != state->len_aligned) {
+	/*
+	 * Check if length is aligned. If the device only reads the buffer,
+	 * flushing the cache line it shares with whatever follows is
+	 * harmless, so there is no need to copy it.
+	 */
+	if (state->len != state->len_aligned && state->flags != GEN_BB_READ) {
 		debug("Unaligned buffer length %zu\n", state->len);
 		return 0;
 	}
@@ -45,12 +51,20 @@ int bounce_buffer_start_extalign(struct bounce_buffer *state, void *data,
 	state->len_aligned = roundup(len, alignment);
 	state->flags = flags;
 
+	if (CONFIG_IS_ENABLED(CMD_BOUNCEBUF))
+		bb_stats.sessions++;
+
 	if (!addr_is_aligned(state)) {
 		state->bounce_buffer = memalign(alignment,
 						state->len_aligned);
 		if (!state->bounce_buffer)
 			return -ENOMEM;
 
+		if (CONFIG_IS_ENABLED(CMD_BOUNCEBUF)) {
+			bb_stats.bounced++;
+			bb_stats.bounced_bytes += state->len;
+		}
+
 		if (state->flags & GEN_BB_READ)
 			memcpy(state->bounce_buffer, state->user_buffer,
 				state->len);
@@ -94,3 +108,19 @@ int bounce_buffer_stop(struct bounce_buffer *state)
 
 	return 0;
 }
+
+void bounce_buffer_add_shifted(size_t len)
+{
+	if (CONFIG_IS_ENABLED(CMD_BOUNCEBUF))
+		bb_stats.shifted_bytes += len;
+}
+
+void bounce_buffer_stats(struct bounce_buffer_stats *stats)
+{
+	*stats = bb_stats;
+}
+
+void bounce_buffer_reset_stats(void)
+{
+	memset(&bb_stats, '\0', sizeof(bb_stats));
+}
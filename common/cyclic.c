@@ -11,6 +11,7 @@
 #include <cyclic.h>
 #include <log.h>
 #include <malloc.h>
+#include <profile.h>
 #include <time.h>
 #include <linux/errno.h>
 #include <linux/list.h>
@@ -101,6 +102,9 @@ void cyclic_run(void)
 
 void schedule(void)
 {
+	if (IS_ENABLED(CONFIG_PROFILER))
+		profile_poll((ulong)__builtin_return_address(0));
+
 	/* The HW watchdog is not integrated into the cyclic IF (yet) */
 	if (IS_ENABLED(CONFIG_HW_WATCHDOG))
 		hw_watchdog_reset();
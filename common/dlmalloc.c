@@ -601,6 +601,32 @@ ulong mem_malloc_brk = 0;
 static bool malloc_testing;	/* enable test mode */
 static int malloc_max_allocs;	/* return NULL after this many calls to malloc() */
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SMALL_CACHE)
+#define SMALL_CACHE_MAX		CONFIG_SYS_MALLOC_SMALL_CACHE_MAX
+#define SMALL_CACHE_LISTS	(SMALL_CACHE_MAX / MALLOC_ALIGNMENT + 1)
+
+/*
+ * Freed chunks of up to SMALL_CACHE_MAX bytes are kept on a list for each
+ * chunk size and handed straight back by malloc(), rather than being
+ * coalesced by free() and split again by malloc(). They stay marked as in
+ * use, so the rest of dlmalloc never sees them. The first word of each cached
+ * chunk points to the next one.
+ */
+static struct small_cache {
+	Void_t *head;	/* first chunk (as a user pointer), or NULL */
+	uint count;	/* number of chunks on the list */
+} small_cache[SMALL_CACHE_LISTS];
+static ulong small_cache_bytes;	/* total size of all cached chunks */
+static bool small_cache_flushing;
+#endif
+
+#if CONFIG_IS_ENABLED(CMD_MALLOC)
+/* Statistics for 'malloc info' */
+static ulong malloc_calls;
+static ulong malloc_cache_hits;
+static ulong malloc_class_count[MALLOC_INFO_CLASSES];
+#endif
+
 void *sbrk(ptrdiff_t increment)
 {
 	ulong old = mem_malloc_brk;
@@ -627,6 +653,16 @@ void mem_malloc_init(ulong start, ulong size)
 	mem_malloc_end = start + size;
 	mem_malloc_brk = start;
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SMALL_CACHE)
+	memset(small_cache, '\0', sizeof(small_cache));
+	small_cache_bytes = 0;
+#endif
+#if CONFIG_IS_ENABLED(CMD_MALLOC)
+	malloc_calls = 0;
+	malloc_cache_hits = 0;
+	memset(malloc_class_count, '\0', sizeof(malloc_class_count));
+#endif
+
 #ifdef CONFIG_SYS_MALLOC_DEFAULT_TO_INIT
 	malloc_init();
 #endif
@@ -1285,6 +1321,114 @@ static void malloc_extend_top(nb) INTERNAL_SIZE_T nb;
 
 */
 
+#if CONFIG_IS_ENABLED(CMD_MALLOC)
+static void malloc_count(INTERNAL_SIZE_T nb)
+{
+  int cls = fls((nb - 1) >> 4);
+
+  malloc_calls++;
+  malloc_class_count[min(cls, MALLOC_INFO_CLASSES - 1)]++;
+}
+#else
+static inline void malloc_count(INTERNAL_SIZE_T nb)
+{
+}
+#endif
+
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SMALL_CACHE)
+STATIC_IF_MCHECK void fREe_impl(Void_t* mem);
+
+/* Take a chunk of size nb from the cache, or return NULL if there is none */
+static Void_t *small_cache_get(INTERNAL_SIZE_T nb, size_t bytes)
+{
+  struct small_cache *list;
+  Void_t *mem;
+
+  if (nb > SMALL_CACHE_MAX)
+    return NULL;
+  list = &small_cache[nb / MALLOC_ALIGNMENT];
+  mem = list->head;
+  if (!mem)
+    return NULL;
+
+  list->head = *(Void_t **)mem;
+  list->count--;
+  small_cache_bytes -= nb;
+  check_inuse_chunk(mem2chunk(mem));
+#if CONFIG_IS_ENABLED(CMD_MALLOC)
+  malloc_cache_hits++;
+#endif
+  VALGRIND_MALLOCLIKE_BLOCK(mem, bytes, SIZE_SZ, false);
+
+  return mem;
+}
+
+/* Put a chunk of size sz in the cache; return false if it does not fit */
+static bool small_cache_put(Void_t *mem, INTERNAL_SIZE_T sz)
+{
+  struct small_cache *list;
+
+  if (sz > SMALL_CACHE_MAX || small_cache_flushing)
+    return false;
+  list = &small_cache[sz / MALLOC_ALIGNMENT];
+  if (list->count >= CONFIG_SYS_MALLOC_SMALL_CACHE_DEPTH)
+    return false;
+
+  VALGRIND_FREELIKE_BLOCK(mem, SIZE_SZ);
+  *(Void_t **)mem = list->head;
+  list->head = mem;
+  list->count++;
+  small_cache_bytes += sz;
+
+  return true;
+}
+
+/*
+ * Really free all cached chunks, so that they can be coalesced. Returns true
+ * if there were any.
+ */
+static bool small_cache_flush(void)
+{
+  bool any = small_cache_bytes;
+  int i;
+
+  small_cache_flushing = true;
+  for (i = 0; i < SMALL_CACHE_LISTS; i++)
+  {
+    struct small_cache *list = &small_cache[i];
+
+    while (list->head)
+    {
+      Void_t *mem = list->head;
+
+      list->head = *(Void_t **)mem;
+      VALGRIND_MALLOCLIKE_BLOCK(mem, 0, SIZE_SZ, false);
+      fREe_impl(mem);
+    }
+    list->count = 0;
+  }
+  small_cache_bytes = 0;
+  small_cache_flushing = false;
+
+  return any;
+}
+#else
+static inline Void_t *small_cache_get(INTERNAL_SIZE_T nb, size_t bytes)
+{
+  return NULL;
+}
+
+static inline bool small_cache_put(Void_t *mem, INTERNAL_SIZE_T sz)
+{
+  return false;
+}
+
+static inline bool small_cache_flush(void)
+{
+  return false;
+}
+#endif
+
 STATIC_IF_MCHECK
 #if __STD_C
 Void_t* mALLOc_impl(size_t bytes)
@@ -1304,6 +1448,7 @@ Void_t* mALLOc_impl(bytes) size_t bytes;
   mchunkptr fwd;                     /* misc temp for linking */
   mchunkptr bck;                     /* misc temp for linking */
   mbinptr q;                         /* misc temp */
+  Void_t *mem;                       /* chunk from the small cache */
 
   INTERNAL_SIZE_T nb;
 
@@ -1327,6 +1472,11 @@ Void_t* mALLOc_impl(bytes) size_t bytes;
 
   nb = request2size(bytes);  /* padded request size; */
 
+  malloc_count(nb);
+  mem = small_cache_get(nb, bytes);
+  if (mem)
+    return mem;
+
   /* Check for exact match in a bin */
 
   if (is_small_request(nb))  /* Faster version for small requests */
@@ -1533,7 +1683,12 @@ Void_t* mALLOc_impl(bytes) size_t bytes;
     /* Try to extend */
     malloc_extend_top(nb);
     if ( (remainder_size = chunksize(top) - nb) < (long)MINSIZE)
+    {
+      /* Give cached chunks back, in case that makes enough space */
+      if (small_cache_flush())
+	return mALLOc_impl(bytes);
       return NULL; /* propagate failure */
+    }
   }
 
   victim = top;
@@ -1614,6 +1769,9 @@ void fREe_impl(mem) Void_t* mem;
   check_inuse_chunk(p);
 
   sz = hd & ~PREV_INUSE;
+  if (small_cache_put(mem, sz))
+    return;
+
   next = chunk_at_offset(p, sz);
   nextsz = chunksize(next);
   VALGRIND_FREELIKE_BLOCK(mem, SIZE_SZ);
@@ -2459,6 +2617,11 @@ static void malloc_update_mallinfo(void)
     }
   }
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SMALL_CACHE)
+  /* Cached chunks are free as far as the caller is concerned */
+  avail += small_cache_bytes;
+#endif
+
   current_mallinfo.ordblks = navail;
   current_mallinfo.uordblks = sbrked_mem - avail;
   current_mallinfo.fordblks = avail;
@@ -2503,6 +2666,45 @@ void malloc_stats(void)
 }
 #endif	/* DEBUG */
 
+void malloc_get_info(struct malloc_info *info)
+{
+  INTERNAL_SIZE_T size;
+  mbinptr b;
+  mchunkptr p;
+  int i;
+
+  memset(info, '\0', sizeof(*info));
+  info->total_bytes = mem_malloc_end - mem_malloc_start;
+  info->system_bytes = sbrked_mem;
+  info->peak_bytes = max_sbrked_mem;
+
+  /* The top chunk can grow into the part of the region not yet used */
+  info->free_bytes = chunksize(top) + mem_malloc_end - mem_malloc_brk;
+  info->largest_free = info->free_bytes;
+  for (i = 1; i < NAV; ++i)
+  {
+    b = bin_at(i);
+    for (p = last(b); p != b; p = p->bk)
+    {
+      size = chunksize(p);
+      info->free_bytes += size;
+      info->largest_free = max(info->largest_free, (ulong)size);
+      info->free_chunks++;
+    }
+  }
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SMALL_CACHE)
+  info->cached_bytes = small_cache_bytes;
+#endif
+  info->in_use_bytes = info->total_bytes - info->free_bytes -
+	info->cached_bytes;
+
+#if CONFIG_IS_ENABLED(CMD_MALLOC)
+  info->calls = malloc_calls;
+  info->cache_hits = malloc_cache_hits;
+  memcpy(info->class_count, malloc_class_count, sizeof(info->class_count));
+#endif
+}
+
 /*
   mallinfo returns a copy of updated current mallinfo.
 */
@@ -6,13 +6,17 @@
  */
 
 #include <common.h>
+#include <kallsyms.h>
 
-/* We need the weak marking as this symbol is provided specially */
+/*
+ * We need the weak marking as this symbol is provided specially: it is only
+ * linked in once the symbol table has been generated from a first link
+ */
 extern const char system_map[] __attribute__((weak));
 
 /* Given an address, return a pointer to the symbol name and store
  * the base address in caddr.  So if the symbol map had an entry:
- *		03fb9b7c_spi_cs_deactivate
+ *		03fb9b7c _spi_cs_deactivate
  * Then the following call:
  *		unsigned long base;
  *		const char *sym = symbol_lookup(0x03fb9b80, &base);
@@ -29,10 +33,12 @@ const char *symbol_lookup(unsigned long addr, unsigned long *caddr)
 	sym = system_map;
 	csym = NULL;
 	*caddr = 0;
+	if (!sym)
+		return NULL;
 
 	while (*sym) {
 		sym_addr = hextoul(sym, &esym);
-		sym = esym;
+		sym = esym + 1;
 		if (sym_addr > addr)
 			break;
 		*caddr = sym_addr;
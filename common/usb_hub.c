@@ -46,19 +46,41 @@
 
 #define HUB_SHORT_RESET_TIME	20
 #define HUB_LONG_RESET_TIME	200
+#define HUB_RESET_RECOVERY_TIME	10
 
 #define HUB_DEBOUNCE_TIMEOUT	CONFIG_USB_HUB_DEBOUNCE_TIMEOUT
 
 #define PORT_OVERCURRENT_MAX_SCAN_COUNT		3
 
+/**
+ * enum usb_scan_state - What a port on the scanning list is waiting for
+ *
+ * @USB_SCAN_CONNECT: Power to become good and a device to connect
+ * @USB_SCAN_RESET: The port reset to finish
+ * @USB_SCAN_RECOVER: The device to recover from the reset, after which it is
+ *	given an address
+ */
+enum usb_scan_state {
+	USB_SCAN_CONNECT,
+	USB_SCAN_RESET,
+	USB_SCAN_RECOVER,
+};
+
 struct usb_device_scan {
 	struct usb_device *dev;		/* USB hub device to scan */
 	struct usb_hub_device *hub;	/* USB hub struct */
 	int port;			/* USB port to scan */
+	enum usb_scan_state state;	/* What the port is waiting for */
+	ulong timeout;			/* End of reset or recovery, in ms */
+	int tries;			/* Number of resets so far */
+	int speed;			/* Device speed, once reset */
+	unsigned short portstatus;	/* Port status when connected */
+	unsigned short portchange;	/* Port change when connected */
 	struct list_head list;
 };
 
 static LIST_HEAD(usb_scan_list);
+static bool usb_scan_running;
 
 __weak void usb_hub_reset_devices(struct usb_hub_device *hub, int port)
 {
@@ -344,11 +366,20 @@ static int usb_hub_port_reset(struct usb_device *dev, int port,
 	return 0;
 }
 
-int usb_hub_port_connect_change(struct usb_device *dev, int port)
+/**
+ * usb_hub_port_connected() - Check whether a device is connected to a port
+ *
+ * This also clears the port's connection-change status
+ *
+ * @dev:	Hub device
+ * @port:	Port number (note ports are numbered from 0 here)
+ * Return: 0 if a device is connected, -ENOTCONN if not, other -ve on error
+ */
+static int usb_hub_port_connected(struct usb_device *dev, int port)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
 	unsigned short portstatus;
-	int ret, speed;
+	int ret;
 
 	/* Check status */
 	ret = usb_get_port_status(dev, port + 1, portsts);
@@ -376,35 +407,37 @@ int usb_hub_port_connect_change(struct usb_device *dev, int port)
 			return -ENOTCONN;
 	}
 
-	/* Reset the port */
-	ret = usb_hub_port_reset(dev, port, &portstatus);
-	if (ret < 0) {
-		if (ret != -ENXIO)
-			printf("cannot reset port %i!?\n", port + 1);
-		return ret;
-	}
+	return 0;
+}
 
+static int usb_hub_port_speed(unsigned short portstatus)
+{
 	switch (portstatus & USB_PORT_STAT_SPEED_MASK) {
 	case USB_PORT_STAT_SUPER_SPEED:
-		speed = USB_SPEED_SUPER;
-		break;
+		return USB_SPEED_SUPER;
 	case USB_PORT_STAT_HIGH_SPEED:
-		speed = USB_SPEED_HIGH;
-		break;
+		return USB_SPEED_HIGH;
 	case USB_PORT_STAT_LOW_SPEED:
-		speed = USB_SPEED_LOW;
-		break;
+		return USB_SPEED_LOW;
 	default:
-		speed = USB_SPEED_FULL;
-		break;
+		return USB_SPEED_FULL;
 	}
+}
 
-	/*
-	 * USB 2.0 7.1.7.5: devices must be able to accept a SetAddress()
-	 * request (refer to Section 11.24.2 and Section 9.4 respectively)
-	 * after the reset recovery time 10 ms
-	 */
-	mdelay(10);
+/**
+ * usb_hub_port_new_device() - Set up the device on a port which has been reset
+ *
+ * The caller must allow the device to recover from the reset first
+ *
+ * @dev:	Hub device
+ * @port:	Port number (note ports are numbered from 0 here)
+ * @speed:	Speed of the device (enum usb_device_speed)
+ * Return: 0 if OK, -ve on error, in which case the port is disabled
+ */
+static int usb_hub_port_new_device(struct usb_device *dev, int port,
+				   int speed)
+{
+	int ret;
 
 #if CONFIG_IS_ENABLED(DM_USB)
 	struct udevice *child;
@@ -439,6 +472,229 @@ int usb_hub_port_connect_change(struct usb_device *dev, int port)
 	return ret;
 }
 
+int usb_hub_port_connect_change(struct usb_device *dev, int port)
+{
+	unsigned short portstatus;
+	int ret;
+
+	ret = usb_hub_port_connected(dev, port);
+	if (ret)
+		return ret;
+
+	/* Reset the port */
+	ret = usb_hub_port_reset(dev, port, &portstatus);
+	if (ret < 0) {
+		if (ret != -ENXIO)
+			printf("cannot reset port %i!?\n", port + 1);
+		return ret;
+	}
+
+	/*
+	 * USB 2.0 7.1.7.5: devices must be able to accept a SetAddress()
+	 * request (refer to Section 11.24.2 and Section 9.4 respectively)
+	 * after the reset recovery time 10 ms
+	 */
+	mdelay(HUB_RESET_RECOVERY_TIME);
+
+	return usb_hub_port_new_device(dev, port,
+				       usb_hub_port_speed(portstatus));
+}
+
+/**
+ * usb_scan_delay_end() - Work out when a delay starting now finishes
+ *
+ * @ms:	Delay in milliseconds
+ * Return: timer value (see get_timer()) at the end of the delay
+ */
+static ulong usb_scan_delay_end(uint ms)
+{
+#ifdef CONFIG_SANDBOX
+	if (state_get_skip_delays())
+		return 0;
+#endif
+
+	return get_timer(0) + ms;
+}
+
+/**
+ * usb_scan_bus_busy() - Check if a port on the same bus is being reset
+ *
+ * A device answers on address 0 from the time its port is reset until it is
+ * given an address, so only one port on each bus may be reset at a time.
+ * Ports on other buses are reset alongside it.
+ *
+ * @usb_scan:	Port which is ready to be reset
+ * Return: true if another port on the same bus is being reset
+ */
+static bool usb_scan_bus_busy(struct usb_device_scan *usb_scan)
+{
+	struct usb_device_scan *other;
+
+	list_for_each_entry(other, &usb_scan_list, list) {
+		if (other->state == USB_SCAN_CONNECT)
+			continue;
+#if CONFIG_IS_ENABLED(DM_USB)
+		if (other->dev->controller_dev ==
+		    usb_scan->dev->controller_dev)
+			return true;
+#else
+		if (other->dev->controller == usb_scan->dev->controller)
+			return true;
+#endif
+	}
+
+	return false;
+}
+
+/**
+ * usb_scan_port_reset() - Start resetting a port on the scanning list
+ *
+ * @usb_scan:	Port to reset
+ * Return: 0 if OK, -ve on error
+ */
+static int usb_scan_port_reset(struct usb_device_scan *usb_scan)
+{
+	int delay = usb_scan->tries ? HUB_LONG_RESET_TIME :
+		HUB_SHORT_RESET_TIME;
+	int ret;
+
+	debug("%s: resetting port %d...\n", __func__, usb_scan->port + 1);
+	ret = usb_set_port_feature(usb_scan->dev, usb_scan->port + 1,
+				   USB_PORT_FEAT_RESET);
+	if (ret < 0)
+		return ret;
+	usb_scan->state = USB_SCAN_RESET;
+	usb_scan->timeout = usb_scan_delay_end(delay);
+
+	return 0;
+}
+
+/**
+ * usb_scan_port_reset_done() - Check a port once its reset time is up
+ *
+ * This is the non-blocking counterpart of usb_hub_port_reset(). If the port
+ * is enabled, it moves on to waiting for the device to recover. If not, the
+ * reset is retried with a longer delay, up to MAX_TRIES times.
+ *
+ * @usb_scan:	Port being reset
+ * Return: 0 if OK, -ve if the port could not be enabled
+ */
+static int usb_scan_port_reset_done(struct usb_device_scan *usb_scan)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
+	struct usb_device *dev = usb_scan->dev;
+	int port = usb_scan->port;
+	unsigned short portstatus;
+
+	if (usb_get_port_status(dev, port + 1, portsts) < 0) {
+		debug("get_port_status failed status %lX\n", dev->status);
+		return -EIO;
+	}
+	portstatus = le16_to_cpu(portsts->wPortStatus);
+	debug("portstatus %x, change %x, %s\n", portstatus,
+	      le16_to_cpu(portsts->wPortChange), portspeed(portstatus));
+
+	if (!(portstatus & USB_PORT_STAT_ENABLE)) {
+		if (++usb_scan->tries == MAX_TRIES) {
+			debug("Cannot enable port %i after %i retries, disabling port.\n",
+			      port + 1, MAX_TRIES);
+			debug("Maybe the USB cable is bad?\n");
+			return -EIO;
+		}
+
+		return usb_scan_port_reset(usb_scan);
+	}
+
+	usb_clear_port_feature(dev, port + 1, USB_PORT_FEAT_C_RESET);
+	usb_scan->speed = usb_hub_port_speed(portstatus);
+	usb_scan->state = USB_SCAN_RECOVER;
+	usb_scan->timeout = usb_scan_delay_end(HUB_RESET_RECOVERY_TIME);
+
+	return 0;
+}
+
+/**
+ * usb_scan_port_done() - Finish with a port on the scanning list
+ *
+ * This handles any other changes seen on the port when the device connected
+ * and removes the port from the list, unless it must be scanned again
+ *
+ * @usb_scan:	Port to finish
+ * Return: 0
+ */
+static int usb_scan_port_done(struct usb_device_scan *usb_scan)
+{
+	unsigned short portstatus = usb_scan->portstatus;
+	unsigned short portchange = usb_scan->portchange;
+	struct usb_hub_device *hub = usb_scan->hub;
+	struct usb_device *dev = usb_scan->dev;
+	int i = usb_scan->port;
+
+	usb_scan->state = USB_SCAN_CONNECT;
+	if (portchange & USB_PORT_STAT_C_ENABLE) {
+		debug("port %d enable change, status %x\n", i + 1, portstatus);
+		usb_clear_port_feature(dev, i + 1, USB_PORT_FEAT_C_ENABLE);
+		/*
+		 * EM interference sometimes causes bad shielded USB
+		 * devices to be shutdown by the hub, this hack enables
+		 * them again. Works at least with mouse driver
+		 */
+		if (!(portstatus & USB_PORT_STAT_ENABLE) &&
+		    (portstatus & USB_PORT_STAT_CONNECTION) &&
+		    usb_device_has_child_on_port(dev, i)) {
+			debug("already running port %i disabled by hub (EMI?), re-enabling...\n",
+			      i + 1);
+			usb_hub_port_connect_change(dev, i);
+		}
+	}
+
+	if (portstatus & USB_PORT_STAT_SUSPEND) {
+		debug("port %d suspend change\n", i + 1);
+		usb_clear_port_feature(dev, i + 1, USB_PORT_FEAT_SUSPEND);
+	}
+
+	if (portchange & USB_PORT_STAT_C_OVERCURRENT) {
+		debug("port %d over-current change\n", i + 1);
+		usb_clear_port_feature(dev, i + 1,
+				       USB_PORT_FEAT_C_OVER_CURRENT);
+		/* Only power-on this one port */
+		usb_set_port_feature(dev, i + 1, USB_PORT_FEAT_POWER);
+		hub->overcurrent_count[i]++;
+
+		/*
+		 * If the max-scan-count is not reached, return without removing
+		 * the device from scan-list. This will re-issue a new scan.
+		 */
+		if (hub->overcurrent_count[i] <=
+		    PORT_OVERCURRENT_MAX_SCAN_COUNT)
+			return 0;
+
+		/* Otherwise the device will get removed */
+		printf("Port %d over-current occurred %d times\n", i + 1,
+		       hub->overcurrent_count[i]);
+	}
+
+	/*
+	 * We're done with this device, so let's remove this device from
+	 * scanning list
+	 */
+	list_del(&usb_scan->list);
+	free(usb_scan);
+
+	return 0;
+}
+
+/**
+ * usb_scan_port() - Move a port on the scanning list on to its next step
+ *
+ * Each port waits for its power to become good and for a device to connect,
+ * then is reset and the device given time to recover, before being set up.
+ * None of these steps blocks, so ports on all hubs on the list, and their
+ * resets if they are on different buses, wait at the same time.
+ *
+ * @usb_scan:	Port to scan
+ * Return: 0
+ */
 static int usb_scan_port(struct usb_device_scan *usb_scan)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
@@ -453,6 +709,30 @@ static int usb_scan_port(struct usb_device_scan *usb_scan)
 	hub = usb_scan->hub;
 	i = usb_scan->port;
 
+	switch (usb_scan->state) {
+	case USB_SCAN_CONNECT:
+		break;
+	case USB_SCAN_RESET:
+		if (get_timer(0) < usb_scan->timeout)
+			return 0;
+		ret = usb_scan_port_reset_done(usb_scan);
+		if (ret) {
+			printf("cannot reset port %i!?\n", i + 1);
+			return usb_scan_port_done(usb_scan);
+		}
+		return 0;
+	case USB_SCAN_RECOVER:
+		/*
+		 * USB 2.0 7.1.7.5: devices must be able to accept a
+		 * SetAddress() request (refer to Section 11.24.2 and Section
+		 * 9.4 respectively) after the reset recovery time 10 ms
+		 */
+		if (get_timer(0) < usb_scan->timeout)
+			return 0;
+		usb_hub_port_new_device(dev, i, usb_scan->speed);
+		return usb_scan_port_done(usb_scan);
+	}
+
 	/*
 	 * Don't talk to the device before the query delay is expired.
 	 * This is needed for voltages to stabalize.
@@ -498,6 +778,10 @@ static int usb_scan_port(struct usb_device_scan *usb_scan)
 		return 0;
 	}
 
+	/* Wait for the bus to be free before resetting the port */
+	if (usb_scan_bus_busy(usb_scan))
+		return 0;
+
 	if (portchange & USB_PORT_STAT_C_RESET) {
 		debug("port %d reset change\n", i + 1);
 		usb_clear_port_feature(dev, i + 1, USB_PORT_FEAT_C_RESET);
@@ -512,73 +796,36 @@ static int usb_scan_port(struct usb_device_scan *usb_scan)
 	/* A new USB device is ready at this point */
 	debug("devnum=%d port=%d: USB dev found\n", dev->devnum, i + 1);
 
-	usb_hub_port_connect_change(dev, i);
-
-	if (portchange & USB_PORT_STAT_C_ENABLE) {
-		debug("port %d enable change, status %x\n", i + 1, portstatus);
-		usb_clear_port_feature(dev, i + 1, USB_PORT_FEAT_C_ENABLE);
-		/*
-		 * EM interference sometimes causes bad shielded USB
-		 * devices to be shutdown by the hub, this hack enables
-		 * them again. Works at least with mouse driver
-		 */
-		if (!(portstatus & USB_PORT_STAT_ENABLE) &&
-		    (portstatus & USB_PORT_STAT_CONNECTION) &&
-		    usb_device_has_child_on_port(dev, i)) {
-			debug("already running port %i disabled by hub (EMI?), re-enabling...\n",
-			      i + 1);
-			usb_hub_port_connect_change(dev, i);
-		}
-	}
-
-	if (portstatus & USB_PORT_STAT_SUSPEND) {
-		debug("port %d suspend change\n", i + 1);
-		usb_clear_port_feature(dev, i + 1, USB_PORT_FEAT_SUSPEND);
-	}
-
-	if (portchange & USB_PORT_STAT_C_OVERCURRENT) {
-		debug("port %d over-current change\n", i + 1);
-		usb_clear_port_feature(dev, i + 1,
-				       USB_PORT_FEAT_C_OVER_CURRENT);
-		/* Only power-on this one port */
-		usb_set_port_feature(dev, i + 1, USB_PORT_FEAT_POWER);
-		hub->overcurrent_count[i]++;
-
-		/*
-		 * If the max-scan-count is not reached, return without removing
-		 * the device from scan-list. This will re-issue a new scan.
-		 */
-		if (hub->overcurrent_count[i] <=
-		    PORT_OVERCURRENT_MAX_SCAN_COUNT)
+	usb_scan->portstatus = portstatus;
+	usb_scan->portchange = portchange;
+	ret = usb_hub_port_connected(dev, i);
+	if (!ret) {
+		usb_scan->tries = 0;
+		ret = usb_scan_port_reset(usb_scan);
+		if (!ret)
 			return 0;
-
-		/* Otherwise the device will get removed */
-		printf("Port %d over-current occurred %d times\n", i + 1,
-		       hub->overcurrent_count[i]);
+		if (ret != -ENXIO)
+			printf("cannot reset port %i!?\n", i + 1);
 	}
 
-	/*
-	 * We're done with this device, so let's remove this device from
-	 * scanning list
-	 */
-	list_del(&usb_scan->list);
-	free(usb_scan);
-
-	return 0;
+	return usb_scan_port_done(usb_scan);
 }
 
 static int usb_device_list_scan(void)
 {
 	struct usb_device_scan *usb_scan;
 	struct usb_device_scan *tmp;
-	static int running;
 	int ret = 0;
 
-	/* Only run this loop once for each controller */
-	if (running)
+	/*
+	 * Hubs found while scanning add their ports to the list being scanned,
+	 * as do root hubs between usb_hub_scan_start() and
+	 * usb_hub_scan_finish()
+	 */
+	if (usb_scan_running)
 		return 0;
 
-	running = 1;
+	usb_scan_running = true;
 
 	while (1) {
 		/* We're done, once the list is empty again */
@@ -598,14 +845,39 @@ static int usb_device_list_scan(void)
 out:
 	/*
 	 * This USB controller has finished scanning all its connected
-	 * USB devices. Set "running" back to 0, so that other USB controllers
+	 * USB devices. Clear usb_scan_running, so that other USB controllers
 	 * will scan their devices too.
 	 */
-	running = 0;
+	usb_scan_running = false;
 
 	return ret;
 }
 
+#if CONFIG_IS_ENABLED(DM_USB)
+void usb_hub_scan_start(void)
+{
+	usb_scan_running = true;
+}
+
+int usb_hub_scan_finish(void)
+{
+	usb_scan_running = false;
+
+	return usb_device_list_scan();
+}
+
+void usb_hub_scan_abort(void)
+{
+	struct usb_device_scan *usb_scan, *tmp;
+
+	list_for_each_entry_safe(usb_scan, tmp, &usb_scan_list, list) {
+		list_del(&usb_scan->list);
+		free(usb_scan);
+	}
+	usb_scan_running = false;
+}
+#endif
+
 static struct usb_hub_device *usb_get_hub_device(struct usb_device *dev)
 {
 	struct usb_hub_device *hub;
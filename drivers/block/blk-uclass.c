@@ -12,9 +12,11 @@
 #include <log.h>
 #include <malloc.h>
 #include <part.h>
+#include <asm/cache.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
+#include <linux/dma-mapping.h>
 #include <linux/err.h>
 
 #define blk_get_ops(dev)	((struct blk_ops *)(dev)->driver->ops)
@@ -428,6 +430,69 @@ static int blk_buffer_aligned(struct bounce_buffer *state)
 	return 1;	/* Default, any buffer is OK */
 }
 
+/*
+ * Read into a buffer the device cannot DMA to directly, without bouncing
+ * all of it: transfer all but the last block to the next DMA-aligned
+ * address inside the buffer, move the data down into place and bounce only
+ * the last block. This keeps the bounce buffer small for large reads.
+ *
+ * Return: number of blocks read, -EAGAIN if the buffer cannot be handled
+ * this way, other -ve on error
+ */
+static long blk_read_shifted(struct udevice *dev, lbaint_t start,
+			     lbaint_t blkcnt, void *buf)
+{
+	struct blk_desc *desc = dev_get_uclass_plat(dev);
+	const struct blk_ops *ops = blk_get_ops(dev);
+	struct blk_bounce_buffer bbstate = { .dev = dev };
+	void *aligned = PTR_ALIGN(buf, ARCH_DMA_MINALIGN);
+	size_t len = (blkcnt - 1) * desc->blksz;
+	ulong blks_read;
+	int ret;
+
+	if (blkcnt < 2 || aligned - buf >= desc->blksz ||
+	    desc->blksz % ARCH_DMA_MINALIGN)
+		return -EAGAIN;
+
+	/* Nothing to do if the device can use the buffer as it is */
+	bbstate.state.user_buffer = buf;
+	bbstate.state.len = blkcnt * desc->blksz;
+	bbstate.state.len_aligned = bbstate.state.len;
+	bbstate.state.flags = GEN_BB_WRITE;
+	if (blk_buffer_aligned(&bbstate.state))
+		return -EAGAIN;
+
+	/* Check that it can transfer to the shifted buffer */
+	bbstate.state.user_buffer = aligned;
+	bbstate.state.len = len;
+	bbstate.state.len_aligned = len;
+	if (!blk_buffer_aligned(&bbstate.state))
+		return -EAGAIN;
+
+	dma_map_single(aligned, len, DMA_BIDIRECTIONAL);
+	blks_read = ops->read(dev, start, blkcnt - 1, aligned);
+	dma_unmap_single((dma_addr_t)(uintptr_t)aligned, len,
+			 DMA_BIDIRECTIONAL);
+	if ((long)blks_read < 0)
+		return blks_read;
+	memmove(buf, aligned, blks_read * desc->blksz);
+	bounce_buffer_add_shifted(blks_read * desc->blksz);
+	if (blks_read != blkcnt - 1)
+		return blks_read;
+
+	ret = bounce_buffer_start_extalign(&bbstate.state, buf + len,
+					   desc->blksz, GEN_BB_WRITE,
+					   desc->blksz, blk_buffer_aligned);
+	if (ret)
+		return blks_read;
+
+	blks_read += ops->read(dev, start + blks_read, 1,
+			       bbstate.state.bounce_buffer);
+	bounce_buffer_stop(&bbstate.state);
+
+	return blks_read;
+}
+
 long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
 {
 	struct blk_desc *desc = dev_get_uclass_plat(dev);
@@ -443,18 +508,25 @@ long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
 
 	if (IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb) {
 		struct blk_bounce_buffer bbstate = { .dev = dev };
-		int ret;
-
-		ret = bounce_buffer_start_extalign(&bbstate.state, buf,
-						   blkcnt * desc->blksz,
-						   GEN_BB_WRITE, desc->blksz,
-						   blk_buffer_aligned);
-		if (ret)
-			return ret;
+		long ret;
+
+		ret = blk_read_shifted(dev, start, blkcnt, buf);
+		if (ret == -EAGAIN) {
+			ret = bounce_buffer_start_extalign(&bbstate.state, buf,
+							   blkcnt * desc->blksz,
+							   GEN_BB_WRITE, desc->blksz,
+							   blk_buffer_aligned);
+			if (ret)
+				return ret;
 
-		blks_read = ops->read(dev, start, blkcnt, bbstate.state.bounce_buffer);
+			ret = ops->read(dev, start, blkcnt,
+					bbstate.state.bounce_buffer);
 
-		bounce_buffer_stop(&bbstate.state);
+			bounce_buffer_stop(&bbstate.state);
+		}
+		if (ret < 0)
+			return ret;
+		blks_read = ret;
 	} else {
 		blks_read = ops->read(dev, start, blkcnt, buf);
 	}
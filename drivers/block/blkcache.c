@@ -165,6 +165,18 @@ void blkcache_stats(struct block_cache_stats *stats)
 	_stats.misses = 0;
 }
 
+unsigned int blkcache_max_blocks(void)
+{
+	return _stats.max_entries ? _stats.max_blocks_per_entry : 0;
+}
+
+void blkcache_grow(unsigned int blocks)
+{
+	/* existing entries stay valid, since each records its own size */
+	if (_stats.max_entries && _stats.max_blocks_per_entry < blocks)
+		_stats.max_blocks_per_entry = blocks;
+}
+
 void blkcache_free(void)
 {
 	blkcache_invalidate(-1, 0);
@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <cpu_func.h>
 #include <event.h>
 #include <log.h>
@@ -481,6 +482,7 @@ static int device_get_dma_constraints(struct udevice *dev)
 int device_probe(struct udevice *dev)
 {
 	const struct driver *drv;
+	int span = -1;
 	int ret;
 
 	if (!dev)
@@ -516,6 +518,9 @@ int device_probe(struct udevice *dev)
 			return 0;
 	}
 
+	/* Time the probe itself, now that any parents have been probed */
+	span = bootstage_span_begin(BOOTSTAGE_SPAN_PROBE, dev->name, 0);
+
 	dev_or_flags(dev, DM_FLAG_ACTIVATED);
 
 	if (CONFIG_IS_ENABLED(POWER_DOMAIN) && dev->parent &&
@@ -600,6 +605,7 @@ int device_probe(struct udevice *dev)
 	ret = device_notify(dev, EVT_DM_POST_PROBE);
 	if (ret)
 		goto fail_event;
+	bootstage_span_end(span);
 
 	return 0;
 fail_event:
@@ -609,6 +615,7 @@ fail_uclass:
 			__func__, dev->name);
 	}
 fail:
+	bootstage_span_end(span);
 	dev_bic_flags(dev, DM_FLAG_ACTIVATED);
 
 	device_free(dev);
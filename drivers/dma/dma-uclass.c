@@ -22,6 +22,7 @@
 #include <linux/dma-mapping.h>
 #include <dt-structs.h>
 #include <errno.h>
+#include <watchdog.h>
 #include <linux/printk.h>
 
 #ifdef CONFIG_DMA_CHANNELS
@@ -261,6 +262,47 @@ int dma_memcpy(void *dst, void *src, size_t len)
 	return ret;
 }
 
+#if CONFIG_IS_ENABLED(DMA_MEMCPY_OFFLOAD)
+int dma_memcpy_offload(void *dst, void *src, size_t len, ulong chunksz)
+{
+	const ulong align_mask = ARCH_DMA_MINALIGN - 1;
+	int ret;
+
+	if (len < CONFIG_DMA_MEMCPY_OFFLOAD_MIN)
+		return -EINVAL;
+
+	/* The engine does not define a copy direction, so avoid overlaps */
+	if (dst < src + len && src < dst + len)
+		return -EINVAL;
+
+	/*
+	 * dma_map_single() invalidates whole cache lines of the destination,
+	 * which would lose any data sharing a line with either end of it
+	 */
+	if (((ulong)dst | (ulong)src | len | chunksz) & align_mask)
+		return -EINVAL;
+
+	if (!chunksz)
+		chunksz = len;
+
+	while (len > 0) {
+		size_t tail = (len > chunksz) ? chunksz : len;
+
+		schedule();
+		ret = dma_memcpy(dst, src, tail);
+		if (ret < 0) {
+			log_debug("DMA copy failed (err=%d), using CPU\n", ret);
+			return ret;
+		}
+		dst += tail;
+		src += tail;
+		len -= tail;
+	}
+
+	return 0;
+}
+#endif
+
 UCLASS_DRIVER(dma) = {
 	.id		= UCLASS_DMA,
 	.name		= "dma",
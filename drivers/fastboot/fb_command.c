@@ -11,6 +11,7 @@
 #include <fastboot-internal.h>
 #include <fb_mmc.h>
 #include <fb_nand.h>
+#include <image-sparse.h>
 #include <part.h>
 #include <stdlib.h>
 #include <linux/printk.h>
@@ -30,6 +31,31 @@ static u32 fastboot_bytes_received;
  */
 static u32 fastboot_bytes_expected;
 
+/**
+ * stream_part - partition selected by "oem stream", or empty if none
+ */
+static char stream_part[FASTBOOT_COMMAND_LEN];
+
+/**
+ * stream_active - the current download is being streamed to stream_part
+ */
+static bool stream_active;
+
+/**
+ * stream_done - a streamed download is waiting for its flash command
+ */
+static bool stream_done;
+
+/**
+ * stream_ret - result of the streamed write, 0 if OK
+ */
+static int stream_ret;
+
+/**
+ * stream_response - response to send for the streamed write
+ */
+static char stream_response[FASTBOOT_RESPONSE_LEN];
+
 static void okay(char *, char *);
 static void getvar(char *, char *);
 static void download(char *, char *);
@@ -43,6 +69,7 @@ static void oem_partconf(char *, char *);
 static void oem_bootbus(char *, char *);
 static void oem_console(char *, char *);
 static void oem_board(char *, char *);
+static void oem_stream(char *, char *);
 static void run_ucmd(char *, char *);
 static void run_acmd(char *, char *);
 
@@ -118,6 +145,10 @@ static const struct {
 		.command = "oem board",
 		.dispatch = CONFIG_IS_ENABLED(FASTBOOT_OEM_BOARD, (oem_board), (NULL))
 	},
+	[FASTBOOT_COMMAND_OEM_STREAM] = {
+		.command = "oem stream",
+		.dispatch = CONFIG_IS_ENABLED(FASTBOOT_FLASH_STREAM, (oem_stream), (NULL))
+	},
 	[FASTBOOT_COMMAND_UCMD] = {
 		.command = "UCmd",
 		.dispatch = CONFIG_IS_ENABLED(FASTBOOT_UUU_SUPPORT, (run_ucmd), (NULL))
@@ -244,7 +275,8 @@ static void download(char *cmd_parameter, char *response)
 	 *
 	 * where cmd_parameter is an 8 digit hexadecimal number
 	 */
-	if (fastboot_bytes_expected > fastboot_buf_size) {
+	/* A streamed sparse image does not need to fit in the buffer */
+	if (fastboot_bytes_expected > fastboot_buf_size && !stream_part[0]) {
 		fastboot_fail(cmd_parameter, response);
 	} else {
 		printf("Starting download of %d bytes\n",
@@ -263,6 +295,31 @@ u32 fastboot_data_remaining(void)
 	return fastboot_bytes_expected - fastboot_bytes_received;
 }
 
+/**
+ * stream_data_start() - Decide whether to stream the current download
+ *
+ * @fastboot_data: Pointer to the first received fastboot data
+ * @fastboot_data_len: Length of received fastboot data
+ * @response: Pointer to fastboot response buffer
+ *
+ * The download is streamed to the partition selected by "oem stream" if it
+ * is a sparse image. Otherwise it is stored in fastboot_buf_addr as usual,
+ * which fails if it does not fit.
+ */
+static void stream_data_start(const void *fastboot_data,
+			      unsigned int fastboot_data_len, char *response)
+{
+	if (fastboot_data_len >= sizeof(sparse_header_t) &&
+	    is_sparse_image((void *)fastboot_data)) {
+		stream_active = true;
+		stream_done = false;
+		stream_ret = fastboot_mmc_flash_stream_start(stream_part,
+							     stream_response);
+	} else if (fastboot_bytes_expected > fastboot_buf_size) {
+		fastboot_fail("image too large to download", response);
+	}
+}
+
 /**
  * fastboot_data_download() - Copy image data to fastboot_buf_addr.
  *
@@ -291,9 +348,25 @@ void fastboot_data_download(const void *fastboot_data,
 			      response);
 		return;
 	}
-	/* Download data to fastboot_buf_addr */
-	memcpy(fastboot_buf_addr + fastboot_bytes_received,
-	       fastboot_data, fastboot_data_len);
+
+	if (CONFIG_IS_ENABLED(FASTBOOT_FLASH_STREAM) && stream_part[0] &&
+	    !fastboot_bytes_received) {
+		stream_data_start(fastboot_data, fastboot_data_len, response);
+		if (*response)
+			return;
+	}
+
+	if (CONFIG_IS_ENABLED(FASTBOOT_FLASH_STREAM) && stream_active) {
+		/* Write it out now; any error is reported by flash */
+		if (!stream_ret)
+			stream_ret = fastboot_mmc_flash_stream_write(fastboot_data,
+								     fastboot_data_len,
+								     stream_response);
+	} else {
+		/* Download data to fastboot_buf_addr */
+		memcpy(fastboot_buf_addr + fastboot_bytes_received,
+		       fastboot_data, fastboot_data_len);
+	}
 
 	pre_dot_num = fastboot_bytes_received / BYTES_PER_DOT;
 	fastboot_bytes_received += fastboot_data_len;
@@ -323,6 +396,13 @@ void fastboot_data_complete(char *response)
 	env_set_hex("filesize", image_size);
 	fastboot_bytes_expected = 0;
 	fastboot_bytes_received = 0;
+
+	if (CONFIG_IS_ENABLED(FASTBOOT_FLASH_STREAM) && stream_active) {
+		stream_ret = fastboot_mmc_flash_stream_finish(stream_response);
+		stream_active = false;
+		stream_done = true;
+		image_size = 0;
+	}
 }
 
 /**
@@ -336,6 +416,14 @@ void fastboot_data_complete(char *response)
  */
 static void __maybe_unused flash(char *cmd_parameter, char *response)
 {
+	if (stream_done && cmd_parameter && !strcmp(cmd_parameter, stream_part)) {
+		/* The image was already written while it was downloaded */
+		strlcpy(response, stream_response, FASTBOOT_RESPONSE_LEN);
+		stream_done = false;
+		stream_part[0] = '\0';
+		return;
+	}
+
 	if (IS_ENABLED(CONFIG_FASTBOOT_FLASH_MMC))
 		fastboot_mmc_flash_write(cmd_parameter, fastboot_buf_addr,
 					 image_size, response);
@@ -572,3 +660,30 @@ static void __maybe_unused oem_board(char *cmd_parameter, char *response)
 {
 	fastboot_oem_board(cmd_parameter, (void *)fastboot_buf_addr, image_size, response);
 }
+
+/**
+ * oem_stream() - Stream the next sparse image download to a partition
+ *
+ * @cmd_parameter: Pointer to partition name
+ * @response: Pointer to fastboot response buffer
+ *
+ * The next download is written to the partition indicated by cmd_parameter
+ * while it is being received, if it is a sparse image. The flash command
+ * for that partition then reports the result.
+ */
+static void __maybe_unused oem_stream(char *cmd_parameter, char *response)
+{
+	if (!cmd_parameter || !*cmd_parameter) {
+		fastboot_fail("Expected partition name", response);
+		return;
+	}
+
+	if (strlen(cmd_parameter) >= sizeof(stream_part)) {
+		fastboot_fail("Partition name too long", response);
+		return;
+	}
+
+	strcpy(stream_part, cmd_parameter);
+	stream_done = false;
+	fastboot_okay(NULL, response);
+}
@@ -13,10 +13,13 @@
 #include <image-sparse.h>
 #include <image.h>
 #include <log.h>
+#include <malloc.h>
 #include <part.h>
 #include <mmc.h>
 #include <div64.h>
+#include <asm/cache.h>
 #include <linux/compat.h>
+#include <linux/math64.h>
 #include <android_image.h>
 
 #define BOOT_PARTITION_NAME "boot"
@@ -165,6 +168,98 @@ static lbaint_t fb_mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+/**
+ * fb_mmc_write_zero() - Write zeroes to a range of blocks
+ *
+ * @block_dev: Pointer to block device
+ * @start: First block to write
+ * @blkcnt: Count of blocks
+ * Return: number of blocks written
+ */
+static lbaint_t fb_mmc_write_zero(struct blk_desc *block_dev, lbaint_t start,
+				  lbaint_t blkcnt)
+{
+	lbaint_t buf_blks, blks = 0, n, done;
+	void *buf;
+
+	if (!blkcnt)
+		return 0;
+	buf_blks = min_t(lbaint_t, blkcnt,
+			 CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / block_dev->blksz);
+	buf = memalign(ARCH_DMA_MINALIGN,
+		       ALIGN(buf_blks * block_dev->blksz, ARCH_DMA_MINALIGN));
+	if (!buf)
+		return 0;
+	memset(buf, '\0', buf_blks * block_dev->blksz);
+
+	while (blks < blkcnt) {
+		n = min(blkcnt - blks, buf_blks);
+		done = fb_mmc_blk_write(block_dev, start + blks, n, buf);
+		blks += done;
+		if (done != n)
+			break;
+	}
+	free(buf);
+
+	return blks;
+}
+
+/*
+ * Without trim, an eMMC erases whole erase groups, which would wipe blocks
+ * next to the run that are already written. So only erase the whole erase
+ * groups in the run and write zeroes to the rest
+ */
+static lbaint_t fb_mmc_sparse_erase(struct sparse_storage *info,
+		lbaint_t blk, lbaint_t blkcnt)
+{
+	struct fb_mmc_sparse *sparse = info->priv;
+	struct blk_desc *dev_desc = sparse->dev_desc;
+	struct mmc *mmc = find_mmc_device(dev_desc->devnum);
+	lbaint_t head, mid, blks;
+	u32 start_rem, rem;
+
+	if (!mmc)
+		return 0;
+	if (mmc->can_trim || mmc->erase_grp_size <= 1)
+		return fb_mmc_blk_write(dev_desc, blk, blkcnt, NULL);
+
+	div_u64_rem(blk, mmc->erase_grp_size, &start_rem);
+	head = start_rem ? min_t(lbaint_t, blkcnt,
+				 mmc->erase_grp_size - start_rem) : 0;
+	div_u64_rem(blkcnt - head, mmc->erase_grp_size, &rem);
+	mid = blkcnt - head - rem;
+
+	blks = fb_mmc_write_zero(dev_desc, blk, head);
+	if (blks != head)
+		return blks;
+	if (mid) {
+		if (fb_mmc_blk_write(dev_desc, blk + head, mid, NULL) != mid)
+			return blks;
+		blks += mid;
+	}
+
+	return blks + fb_mmc_write_zero(dev_desc, blk + blks, blkcnt - blks);
+}
+
+static void fb_mmc_sparse_init(struct sparse_storage *sparse,
+			       struct fb_mmc_sparse *sparse_priv,
+			       struct blk_desc *dev_desc,
+			       struct disk_partition *info)
+{
+	sparse_priv->dev_desc = dev_desc;
+
+	sparse->blksz = info->blksz;
+	sparse->start = info->start;
+	sparse->size = info->size;
+	sparse->write = fb_mmc_sparse_write;
+	sparse->reserve = fb_mmc_sparse_reserve;
+	sparse->erase = NULL;
+	if (IS_ENABLED(CONFIG_FASTBOOT_MMC_SPARSE_ERASE_ZERO))
+		sparse->erase = fb_mmc_sparse_erase;
+	sparse->mssg = fastboot_fail;
+	sparse->priv = sparse_priv;
+}
+
 static void write_raw_image(struct blk_desc *dev_desc,
 			    struct disk_partition *info, const char *part_name,
 			    void *buffer, u32 download_bytes, char *response)
@@ -614,21 +709,13 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 		struct sparse_storage sparse;
 		int err;
 
-		sparse_priv.dev_desc = dev_desc;
-
-		sparse.blksz = info.blksz;
-		sparse.start = info.start;
-		sparse.size = info.size;
-		sparse.write = fb_mmc_sparse_write;
-		sparse.reserve = fb_mmc_sparse_reserve;
-		sparse.mssg = fastboot_fail;
+		fb_mmc_sparse_init(&sparse, &sparse_priv, dev_desc, &info);
 
 		printf("Flashing sparse image at offset " LBAFU "\n",
 		       sparse.start);
 
-		sparse.priv = &sparse_priv;
 		err = write_sparse_image(&sparse, cmd, download_buffer,
-					 response);
+					 download_bytes, response);
 		if (!err)
 			fastboot_okay(NULL, response);
 	} else {
@@ -637,6 +724,77 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 	}
 }
 
+#if CONFIG_IS_ENABLED(FASTBOOT_FLASH_STREAM)
+static struct fb_mmc_sparse stream_priv;
+static struct sparse_storage stream_sparse;
+static struct sparse_stream stream;
+static char stream_part_name[PART_NAME_LEN];
+
+/**
+ * fastboot_mmc_flash_stream_start() - Start streaming a sparse image to eMMC
+ *
+ * @cmd: Named partition to write image to
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve on error
+ */
+int fastboot_mmc_flash_stream_start(const char *cmd, char *response)
+{
+	struct blk_desc *dev_desc;
+	struct disk_partition info = {0};
+
+	stream.info = NULL;
+	if (fastboot_mmc_get_part_info(cmd, &dev_desc, &info, response) < 0)
+		return -ENOENT;
+
+	fb_mmc_sparse_init(&stream_sparse, &stream_priv, dev_desc, &info);
+	strlcpy(stream_part_name, cmd, sizeof(stream_part_name));
+
+	printf("Streaming sparse image at offset " LBAFU "\n",
+	       stream_sparse.start);
+	sparse_stream_start(&stream, &stream_sparse, stream_part_name);
+
+	return 0;
+}
+
+/**
+ * fastboot_mmc_flash_stream_write() - Write the next piece of a sparse image
+ *
+ * @data: Pointer to received image data
+ * @len: Length of received image data
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve on error
+ */
+int fastboot_mmc_flash_stream_write(const void *data, u32 len, char *response)
+{
+	if (!stream.info)
+		return -ENODEV;
+
+	return sparse_stream_write(&stream, data, len, response);
+}
+
+/**
+ * fastboot_mmc_flash_stream_finish() - Complete a streamed sparse image
+ *
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve on error
+ */
+int fastboot_mmc_flash_stream_finish(char *response)
+{
+	int ret;
+
+	/* Nothing to complete if the partition could not be found */
+	if (!stream.info)
+		return -ENODEV;
+
+	ret = sparse_stream_finish(&stream, response);
+	stream.info = NULL;
+	if (!ret)
+		fastboot_okay(NULL, response);
+
+	return ret;
+}
+#endif
+
 /**
  * fastboot_mmc_flash_erase() - Erase eMMC for fastboot
  *
@@ -207,7 +207,7 @@ void fastboot_nand_flash_write(const char *cmd, void *download_buffer,
 
 		sparse.priv = &sparse_priv;
 		ret = write_sparse_image(&sparse, cmd, download_buffer,
-					 response);
+					 download_bytes, response);
 		if (!ret)
 			fastboot_okay(NULL, response);
 	} else {
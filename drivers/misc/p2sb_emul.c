@@ -21,15 +21,21 @@
  *
  * @command:	Current PCI command value
  * @bar:	Current base address values
+ * @hidden:	true if the device is hidden, so reads as all ones
  */
 struct p2sb_emul_plat {
 	u16 command;
 	u32 bar[6];
+	bool hidden;
 };
 
 enum {
 	/* This emulator supports 16 different devices */
 	MEMMAP_SIZE	= 16 << PCR_PORTID_SHIFT,
+
+	/* Register to hide the device, as on Intel SoCs */
+	P2SB_E1		= 0xe1,
+	P2SB_HIDE	= BIT(0),
 };
 
 static struct pci_bar {
@@ -54,10 +60,18 @@ static int sandbox_p2sb_emul_read_config(const struct udevice *emul,
 {
 	struct p2sb_emul_plat *plat = dev_get_plat(emul);
 
+	if (plat->hidden && offset != P2SB_E1) {
+		*valuep = pci_get_ff(size);
+		return 0;
+	}
+
 	switch (offset) {
 	case PCI_COMMAND:
 		*valuep = plat->command;
 		break;
+	case P2SB_E1:
+		*valuep = plat->hidden ? P2SB_HIDE : 0;
+		break;
 	case PCI_HEADER_TYPE:
 		*valuep = PCI_HEADER_TYPE_NORMAL;
 		break;
@@ -67,6 +81,11 @@ static int sandbox_p2sb_emul_read_config(const struct udevice *emul,
 	case PCI_DEVICE_ID:
 		*valuep = SANDBOX_PCI_P2SB_EMUL_ID;
 		break;
+	case PCI_CLASS_REVISION:
+		*valuep = pci_conv_32_to_size(SANDBOX_PCI_CLASS_CODE << 24 |
+					      SANDBOX_PCI_CLASS_SUB_CODE << 16,
+					      offset, size);
+		break;
 	case PCI_CLASS_DEVICE:
 		if (size == PCI_SIZE_8) {
 			*valuep = SANDBOX_PCI_CLASS_SUB_CODE;
@@ -111,6 +130,9 @@ static int sandbox_p2sb_emul_write_config(struct udevice *emul, uint offset,
 	case PCI_COMMAND:
 		plat->command = value;
 		break;
+	case P2SB_E1:
+		plat->hidden = value & P2SB_HIDE;
+		break;
 	case PCI_BASE_ADDRESS_0:
 	case PCI_BASE_ADDRESS_1: {
 		int barnum;
@@ -123,6 +123,11 @@ static int sandbox_swap_case_read_config(const struct udevice *emul,
 	case PCI_DEVICE_ID:
 		*valuep = SANDBOX_PCI_SWAP_CASE_EMUL_ID;
 		break;
+	case PCI_CLASS_REVISION:
+		*valuep = pci_conv_32_to_size(SANDBOX_PCI_CLASS_CODE << 24 |
+					      SANDBOX_PCI_CLASS_SUB_CODE << 16,
+					      offset, size);
+		break;
 	case PCI_CLASS_DEVICE:
 		if (size == PCI_SIZE_8) {
 			*valuep = SANDBOX_PCI_CLASS_SUB_CODE;
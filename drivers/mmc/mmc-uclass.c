@@ -517,6 +517,8 @@ static int mmc_blk_remove(struct udevice *dev)
 	struct mmc_uclass_priv *upriv = dev_get_uclass_priv(mmc_dev);
 	struct mmc *mmc = upriv->mmc;
 
+	mmc_flush_cache(mmc);
+
 	return mmc_deinit(mmc);
 }
 
@@ -329,6 +329,17 @@ int mmc_set_blocklen(struct mmc *mmc, int len)
 				   MMC_QUIRK_RETRY_SET_BLOCKLEN, 4);
 }
 
+int mmc_set_block_count(struct mmc *mmc, lbaint_t blkcnt)
+{
+	struct mmc_cmd cmd;
+
+	cmd.cmdidx = MMC_CMD_SET_BLOCK_COUNT;
+	cmd.resp_type = MMC_RSP_R1;
+	cmd.cmdarg = blkcnt & 0xffff;
+
+	return mmc_send_cmd(mmc, &cmd, NULL);
+}
+
 #ifdef MMC_SUPPORTS_TUNING
 static const u8 tuning_blk_pattern_4bit[] = {
 	0xff, 0x0f, 0xff, 0x00, 0xff, 0xcc, 0xc3, 0xcc,
@@ -424,12 +435,20 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 {
 	struct mmc_cmd cmd;
 	struct mmc_data data;
+	bool stop = blkcnt > 1;
 
 	if (blkcnt > 1)
 		cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
 	else
 		cmd.cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
 
+	/* A pre-defined transfer ends by itself, without CMD12 */
+	if (stop && blkcnt <= 0xffff && mmc_can_cmd23(mmc)) {
+		if (mmc_set_block_count(mmc, blkcnt))
+			return 0;
+		stop = false;
+	}
+
 	if (mmc->high_capacity)
 		cmd.cmdarg = start;
 	else
@@ -445,7 +464,7 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 	if (mmc_send_cmd(mmc, &cmd, &data))
 		return 0;
 
-	if (blkcnt > 1) {
+	if (stop) {
 		if (mmc_send_stop_transmission(mmc, false)) {
 #if !defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBCOMMON_SUPPORT)
 			pr_err("mmc fail to send stop cmd\n");
@@ -822,6 +841,9 @@ static int __mmc_switch(struct mmc *mmc, u8 set, u8 index, u8 value,
 	if (is_part_switch  && mmc->part_switch_time)
 		timeout_ms = mmc->part_switch_time * 10;
 
+	if (set == EXT_CSD_CMD_SET_NORMAL && index == EXT_CSD_FLUSH_CACHE)
+		timeout_ms = MMC_CACHE_FLUSH_TIMEOUT_MS;
+
 	cmd.cmdidx = MMC_CMD_SWITCH;
 	cmd.resp_type = MMC_RSP_R1b;
 	cmd.cmdarg = (MMC_SWITCH_MODE_WRITE_BYTE << 24) |
@@ -2471,6 +2493,28 @@ static int mmc_startup_v4(struct mmc *mmc)
 	mmc->can_trim =
 		!!(ext_csd[EXT_CSD_SEC_FEATURE] & EXT_CSD_SEC_FEATURE_TRIM_EN);
 
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+	if (mmc->version >= MMC_VERSION_4_5)
+		mmc->cache_size = ext_csd[EXT_CSD_CACHE_SIZE] << 0
+				| ext_csd[EXT_CSD_CACHE_SIZE + 1] << 8
+				| ext_csd[EXT_CSD_CACHE_SIZE + 2] << 16
+				| ext_csd[EXT_CSD_CACHE_SIZE + 3] << 24;
+
+	/*
+	 * Let the card acknowledge writes from its cache. It is flushed when
+	 * the block device is removed, e.g. before booting an OS, or when the
+	 * card is initialised again.
+	 */
+	mmc->cache_on = false;
+	if (CONFIG_IS_ENABLED(MMC_WRITE_CACHE) && mmc->cache_size) {
+		if (mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL,
+			       EXT_CSD_CACHE_CTRL, 1))
+			pr_warn("MMC: cannot enable the write cache\n");
+		else
+			mmc->cache_on = true;
+	}
+#endif
+
 	return 0;
 error:
 	if (mmc->ext_csd) {
@@ -2852,6 +2896,9 @@ int mmc_get_op_cond(struct mmc *mmc, bool quiet)
 	if (mmc->has_init)
 		return 0;
 
+	/* Do not lose what is in the cache when the card is reset */
+	mmc_flush_cache(mmc);
+
 	err = mmc_power_init(mmc);
 	if (err)
 		return err;
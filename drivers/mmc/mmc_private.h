@@ -17,6 +17,32 @@ int mmc_poll_for_busy(struct mmc *mmc, int timeout);
 
 int mmc_set_blocklen(struct mmc *mmc, int len);
 
+/**
+ * mmc_can_cmd23() - Check whether multi-block transfers can use CMD23
+ *
+ * With CMD23 (SET_BLOCK_COUNT) the card knows the length of a transfer up
+ * front, so it can be ended without CMD12 (STOP_TRANSMISSION).
+ *
+ * @mmc: MMC device
+ * Return: true if both host and card support it
+ */
+static inline bool mmc_can_cmd23(struct mmc *mmc)
+{
+	if (!(mmc->host_caps & MMC_CAP_CMD23) || mmc_host_is_spi(mmc))
+		return false;
+
+	return IS_MMC(mmc) || (mmc->scr[0] & SD_SCR_CMD23_SUPPORT);
+}
+
+/**
+ * mmc_set_block_count() - Send CMD23 ahead of a multi-block transfer
+ *
+ * @mmc: MMC device
+ * @blkcnt: Number of blocks in the following transfer, at most 0xffff
+ * Return: 0 if OK, -ve on error
+ */
+int mmc_set_block_count(struct mmc *mmc, lbaint_t blkcnt);
+
 #if CONFIG_IS_ENABLED(BLK)
 ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
@@ -37,6 +63,14 @@ ulong mmc_bwrite(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 ulong mmc_berase(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt);
 #endif
 
+/**
+ * mmc_flush_cache() - Write back the eMMC volatile cache, if it is enabled
+ *
+ * @mmc: MMC device
+ * Return: 0 if OK, -ve on error
+ */
+int mmc_flush_cache(struct mmc *mmc);
+
 #else /* CONFIG_SPL_MMC_WRITE is not defined */
 
 /* declare dummies to reduce code size. */
@@ -67,6 +101,11 @@ static inline ulong mmc_bwrite(struct blk_desc *block_dev, lbaint_t start,
 }
 #endif
 
+static inline int mmc_flush_cache(struct mmc *mmc)
+{
+	return 0;
+}
+
 #endif /* CONFIG_SPL_BUILD */
 
 #ifdef CONFIG_MMC_TRACE
@@ -66,6 +66,39 @@ err_out:
 	return err;
 }
 
+/*
+ * Erase blkcnt blocks from start using the given erase arguments, issuing
+ * up to CONFIG_MMC_ERASE_GRP_BATCH erase groups (or one SD allocation unit)
+ * per command and waiting for the card to finish each one.
+ */
+static lbaint_t mmc_erase_range(struct mmc *mmc, lbaint_t start,
+				lbaint_t blkcnt, u32 erase_args)
+{
+	lbaint_t blk = 0, blk_r, max;
+	int timeout_ms = 1000;
+
+	if (IS_SD(mmc) && mmc->ssr.au) {
+		max = mmc->ssr.au;
+	} else {
+		max = mmc->erase_grp_size * CONFIG_MMC_ERASE_GRP_BATCH;
+		timeout_ms *= CONFIG_MMC_ERASE_GRP_BATCH;
+	}
+
+	while (blk < blkcnt) {
+		blk_r = min(blkcnt - blk, max);
+		if (mmc_erase_t(mmc, start + blk, blk_r, erase_args))
+			break;
+
+		blk += blk_r;
+
+		/* Waiting for the ready status */
+		if (mmc_poll_for_busy(mmc, timeout_ms))
+			return 0;
+	}
+
+	return blk;
+}
+
 #if CONFIG_IS_ENABLED(BLK)
 ulong mmc_berase(struct udevice *dev, lbaint_t start, lbaint_t blkcnt)
 #else
@@ -77,10 +110,9 @@ ulong mmc_berase(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt)
 #endif
 	int dev_num = block_dev->devnum;
 	int err = 0;
-	u32 start_rem, blkcnt_rem, erase_args = 0;
+	u32 start_rem, blkcnt_rem;
 	struct mmc *mmc = find_mmc_device(dev_num);
-	lbaint_t blk = 0, blk_r = 0;
-	int timeout_ms = 1000;
+	lbaint_t grp_size, head, mid, blk;
 
 	if (!mmc)
 		return -1;
@@ -95,46 +127,50 @@ ulong mmc_berase(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt)
 	 * unaligned.  We discard the whole numbers and only care about the
 	 * remainder.
 	 */
-	err = div_u64_rem(start, mmc->erase_grp_size, &start_rem);
-	err = div_u64_rem(blkcnt, mmc->erase_grp_size, &blkcnt_rem);
-	if (start_rem || blkcnt_rem) {
-		if (mmc->can_trim) {
-			/* Trim function applies the erase operation to write
-			 * blocks instead of erase groups.
-			 */
-			erase_args = MMC_TRIM_ARG;
-		} else {
-			/* The card ignores all LSB's below the erase group
-			 * size, rounding down the addess to a erase group
-			 * boundary.
-			 */
-			printf("\n\nCaution! Your devices Erase group is 0x%x\n"
-			       "The erase range would be change to "
-			       "0x" LBAF "~0x" LBAF "\n\n",
-			       mmc->erase_grp_size, start & ~(mmc->erase_grp_size - 1),
-			       ((start + blkcnt + mmc->erase_grp_size - 1)
-			       & ~(mmc->erase_grp_size - 1)) - 1);
-		}
+	grp_size = mmc->erase_grp_size;
+	err = div_u64_rem(start, grp_size, &start_rem);
+	err = div_u64_rem(blkcnt, grp_size, &blkcnt_rem);
+	if (!start_rem && !blkcnt_rem)
+		return mmc_erase_range(mmc, start, blkcnt, 0);
+
+	if (!mmc->can_trim) {
+		/* The card ignores all LSB's below the erase group
+		 * size, rounding down the addess to a erase group
+		 * boundary.
+		 */
+		printf("\n\nCaution! Your devices Erase group is 0x%x\n"
+		       "The erase range would be change to "
+		       "0x" LBAF "~0x" LBAF "\n\n",
+		       mmc->erase_grp_size, start & ~(mmc->erase_grp_size - 1),
+		       ((start + blkcnt + mmc->erase_grp_size - 1)
+		       & ~(mmc->erase_grp_size - 1)) - 1);
+		return mmc_erase_range(mmc, start, blkcnt, 0);
 	}
 
-	while (blk < blkcnt) {
-		if (IS_SD(mmc) && mmc->ssr.au) {
-			blk_r = ((blkcnt - blk) > mmc->ssr.au) ?
-				mmc->ssr.au : (blkcnt - blk);
-		} else {
-			blk_r = ((blkcnt - blk) > mmc->erase_grp_size) ?
-				mmc->erase_grp_size : (blkcnt - blk);
-		}
-		err = mmc_erase_t(mmc, start + blk, blk_r, erase_args);
-		if (err)
-			break;
-
-		blk += blk_r;
-
-		/* Waiting for the ready status */
-		if (mmc_poll_for_busy(mmc, timeout_ms))
-			return 0;
+	/*
+	 * Trim function applies the erase operation to write blocks instead
+	 * of erase groups. Use it for the unaligned head and tail only, so
+	 * that whole erase groups in between are erased in one go.
+	 */
+	head = start_rem ? min(blkcnt, grp_size - start_rem) : 0;
+	mid = blkcnt - head;
+	div_u64_rem(mid, grp_size, &blkcnt_rem);
+	mid -= blkcnt_rem;
+
+	blk = 0;
+	if (head) {
+		if (mmc_erase_range(mmc, start, head, MMC_TRIM_ARG) != head)
+			return blk;
+		blk += head;
 	}
+	if (mid) {
+		if (mmc_erase_range(mmc, start + blk, mid, 0) != mid)
+			return blk;
+		blk += mid;
+	}
+	if (blk < blkcnt)
+		blk += mmc_erase_range(mmc, start + blk, blkcnt - blk,
+				       MMC_TRIM_ARG);
 
 	return blk;
 }
@@ -145,6 +181,7 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 	struct mmc_cmd cmd;
 	struct mmc_data data;
 	int timeout_ms = 1000;
+	bool stop;
 
 	if ((start + blkcnt) > mmc_get_blk_desc(mmc)->lba) {
 		printf("MMC: block number 0x" LBAF " exceeds max(0x" LBAF ")\n",
@@ -159,6 +196,19 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 	else
 		cmd.cmdidx = MMC_CMD_WRITE_MULTIPLE_BLOCK;
 
+	/* SPI multiblock writes terminate using a special
+	 * token, not a STOP_TRANSMISSION request. A pre-defined
+	 * transfer started with CMD23 does not need one either.
+	 */
+	stop = !mmc_host_is_spi(mmc) && blkcnt > 1;
+	if (stop && blkcnt <= 0xffff && mmc_can_cmd23(mmc)) {
+		if (mmc_set_block_count(mmc, blkcnt)) {
+			printf("mmc fail to set block count\n");
+			return 0;
+		}
+		stop = false;
+	}
+
 	if (mmc->high_capacity)
 		cmd.cmdarg = start;
 	else
@@ -176,10 +226,7 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 		return 0;
 	}
 
-	/* SPI multiblock writes terminate using a special
-	 * token, not a STOP_TRANSMISSION request.
-	 */
-	if (!mmc_host_is_spi(mmc) && blkcnt > 1) {
+	if (stop) {
 		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
 		cmd.cmdarg = 0;
 		cmd.resp_type = MMC_RSP_R1b;
@@ -234,3 +281,17 @@ ulong mmc_bwrite(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 
 	return blkcnt;
 }
+
+int mmc_flush_cache(struct mmc *mmc)
+{
+	int err;
+
+	if (!mmc->cache_on)
+		return 0;
+
+	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_FLUSH_CACHE, 1);
+	if (err)
+		printf("mmc cache flush failed\n");
+
+	return err;
+}
@@ -19,15 +19,24 @@ void sdhci_adma_write_desc(struct sdhci_host *host, void **next_desc,
 	if (end)
 		attr |= ADMA_DESC_ATTR_END;
 
-	desc->attr = attr;
+	/* Bits 17:16 of a 26-bit length live in the top of the attributes */
+	desc->attr = attr | ((len >> 16) & 0x3) << 6;
 	desc->len = len & 0xffff;
-	desc->reserved = 0;
+	desc->len_hi = (len >> 18) & 0xff;
 	desc->addr_lo = lower_32_bits(addr);
 #ifdef CONFIG_MMC_SDHCI_ADMA_64BIT
 	desc->addr_hi = upper_32_bits(addr);
+#ifdef CONFIG_MMC_SDHCI_ADMA_V4
+	desc->reserved = 0;
+#endif
 #endif
 
 	*next_desc += ADMA_DESC_LEN;
+#if defined(CONFIG_MMC_SDHCI_ADMA_64BIT) && defined(CONFIG_MMC_SDHCI_ADMA_V4)
+	/* Outside v4 mode 64-bit descriptors are 96 bits long */
+	if (!host || !(host->flags & USE_ADMA_V4))
+		*next_desc -= sizeof(desc->reserved);
+#endif
 }
 
 static inline void __sdhci_adma_write_desc(struct sdhci_host *host,
@@ -49,7 +58,8 @@ static inline void __sdhci_adma_write_desc(struct sdhci_host *host,
  * @addr:	DMA address to write to or read from
  *
  * Fill the ADMA table according to the MMC data to read from or write to the
- * given DMA address.
+ * given DMA address. In v4 mode each descriptor covers up to 64MiB, so even
+ * a maximal transfer needs only a handful of them.
  * Please note, that the table size depends on CONFIG_SYS_MMC_MAX_BLK_COUNT and
  * we don't have to check for overflow.
  */
@@ -59,14 +69,19 @@ void sdhci_prepare_adma_table(struct sdhci_host *host,
 {
 	dma_addr_t addr = start_addr;
 	uint trans_bytes = data->blocksize * data->blocks;
+	uint max_len = ADMA_MAX_LEN;
 	void *next_desc = table;
-	int i = DIV_ROUND_UP(trans_bytes, ADMA_MAX_LEN);
+	int i;
+
+	if (host && (host->flags & USE_ADMA_V4))
+		max_len = ADMA_V4_MAX_LEN;
 
+	i = DIV_ROUND_UP(trans_bytes, max_len);
 	while (--i) {
 		__sdhci_adma_write_desc(host, &next_desc, addr,
-					ADMA_MAX_LEN, false);
-		addr += ADMA_MAX_LEN;
-		trans_bytes -= ADMA_MAX_LEN;
+					max_len, false);
+		addr += max_len;
+		trans_bytes -= max_len;
 	}
 
 	__sdhci_adma_write_desc(host, &next_desc, addr, trans_bytes, true);
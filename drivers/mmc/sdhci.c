@@ -86,12 +86,22 @@ static void sdhci_prepare_dma(struct sdhci_host *host, struct mmc_data *data,
 
 	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
 	ctrl &= ~SDHCI_CTRL_DMA_MASK;
-	if (host->flags & USE_ADMA64)
+	/* In v4 mode 64-bit addressing is selected in HOST_CONTROL2 */
+	if ((host->flags & USE_ADMA64) && !(host->flags & USE_ADMA_V4))
 		ctrl |= SDHCI_CTRL_ADMA64;
-	else if (host->flags & USE_ADMA)
+	else if (host->flags & (USE_ADMA | USE_ADMA64))
 		ctrl |= SDHCI_CTRL_ADMA32;
 	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
 
+	if (host->flags & USE_ADMA_V4) {
+		u16 ctrl2 = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+
+		ctrl2 |= SDHCI_CTRL_V4_MODE | SDHCI_CTRL_ADMA2_LEN_MODE;
+		if (host->flags & USE_ADMA64)
+			ctrl2 |= SDHCI_CTRL_64BIT_ADDR;
+		sdhci_writew(host, ctrl2, SDHCI_HOST_CONTROL2);
+	}
+
 	if (host->flags & USE_SDMA &&
 	    (host->force_align_buffer ||
 	     (host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR &&
@@ -292,7 +302,13 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
 				data->blocksize),
 				SDHCI_BLOCK_SIZE);
-		sdhci_writew(host, data->blocks, SDHCI_BLOCK_COUNT);
+		if (data->blocks > 0xffff && (host->flags & USE_ADMA_V4)) {
+			/* a zero 16-bit count selects the 32-bit register */
+			sdhci_writew(host, 0, SDHCI_BLOCK_COUNT);
+			sdhci_writel(host, data->blocks, SDHCI_32BIT_BLK_CNT);
+		} else {
+			sdhci_writew(host, data->blocks, SDHCI_BLOCK_COUNT);
+		}
 		sdhci_writew(host, mode, SDHCI_TRANSFER_MODE);
 	} else if (cmd->resp_type & MMC_RSP_BUSY) {
 		sdhci_writeb(host, 0xe, SDHCI_TIMEOUT_CONTROL);
@@ -913,6 +929,15 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 	else
 		host->version = sdhci_readw(host, SDHCI_HOST_VERSION);
 
+	if (CONFIG_IS_ENABLED(MMC_SDHCI_ADMA) &&
+	    IS_ENABLED(CONFIG_MMC_SDHCI_ADMA_V4)) {
+		if (SDHCI_GET_VERSION(host) >= SDHCI_SPEC_410)
+			host->flags |= USE_ADMA_V4;
+		else
+			debug("%s: %s: no ADMA v4 mode, using ADMA2\n",
+			      __func__, host->name);
+	}
+
 	cfg->name = host->name;
 #ifndef CONFIG_DM_MMC
 	cfg->ops = &sdhci_ops;
@@ -985,6 +1010,10 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 
 	cfg->host_caps |= MMC_MODE_4BIT;
 
+	/* Auto-CMD12 is never used, so CMD23 can be sent ahead of transfers */
+	if (!(host->quirks & SDHCI_QUIRK_BROKEN_CMD23))
+		cfg->host_caps |= MMC_CAP_CMD23;
+
 	/* Since Host Controller Version3.0 */
 	if (SDHCI_GET_VERSION(host) >= SDHCI_SPEC_300) {
 		if (!(caps & SDHCI_CAN_DO_8BIT))
@@ -1027,6 +1056,9 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 		cfg->host_caps |= host->host_caps;
 
 	cfg->b_max = CONFIG_SYS_MMC_MAX_BLK_COUNT;
+	/* Only v4 mode has a 32-bit block count register */
+	if (!(host->flags & USE_ADMA_V4))
+		cfg->b_max = min_t(uint, cfg->b_max, 0xffff);
 
 	return 0;
 }
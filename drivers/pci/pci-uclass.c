@@ -321,11 +321,79 @@ static int pci_write_config(pci_dev_t bdf, int offset, unsigned long value,
 	return pci_bus_write_config(bus, bdf, offset, value, size);
 }
 
+/**
+ * pci_get_cached_config() - Read a config register saved when the bus was scanned
+ *
+ * The class, revision and header type are read from each device when its bus
+ * is scanned and do not change, so there is no need to read them again through
+ * what may be a slow config-space accessor.
+ *
+ * The vendor and device IDs are always read from the device, since some
+ * devices can be hidden, e.g. the Intel P2SB, and then read as all ones.
+ *
+ * @dev:	PCI device to read from
+ * @offset:	Register offset to read
+ * @valuep:	Returns the value read
+ * @size:	Access size
+ * Return: true if the value was found, false if config space must be read
+ */
+static bool pci_get_cached_config(const struct udevice *dev, int offset,
+				  unsigned long *valuep, enum pci_size_t size)
+{
+	struct pci_child_plat *pplat;
+	u32 val;
+
+	if (!device_is_on_pci_bus(dev))
+		return false;
+	pplat = dev_get_parent_plat(dev);
+	if (!pplat->hdr_cached)
+		return false;
+
+	switch (offset & ~3) {
+	case PCI_CLASS_REVISION:
+		val = pplat->revision | pplat->class << 8;
+		break;
+	case PCI_CACHE_LINE_SIZE:
+		/* The other registers in this word may be written */
+		if (offset != PCI_HEADER_TYPE || size != PCI_SIZE_8)
+			return false;
+		val = pplat->header_type << 16;
+		break;
+	default:
+		return false;
+	}
+	*valuep = pci_conv_32_to_size(val, offset, size);
+
+	return true;
+}
+
+/**
+ * pci_drop_cached_config() - Stop using cached registers after a write to them
+ *
+ * @dev:	PCI device being written to
+ * @offset:	Register offset being written
+ * @size:	Access size
+ */
+static void pci_drop_cached_config(struct udevice *dev, int offset,
+				   enum pci_size_t size)
+{
+	struct pci_child_plat *pplat;
+	int end = offset + (1 << size);
+
+	if (!device_is_on_pci_bus(dev))
+		return;
+	pplat = dev_get_parent_plat(dev);
+	if ((offset < PCI_CLASS_REVISION + 4 && end > PCI_CLASS_REVISION) ||
+	    (offset <= PCI_HEADER_TYPE && end > PCI_HEADER_TYPE))
+		pplat->hdr_cached = false;
+}
+
 int dm_pci_write_config(struct udevice *dev, int offset, unsigned long value,
 			enum pci_size_t size)
 {
 	struct udevice *bus;
 
+	pci_drop_cached_config(dev, offset, size);
 	for (bus = dev; device_is_on_pci_bus(bus);)
 		bus = bus->parent;
 	return pci_bus_write_config(bus, dm_pci_get_bdf(dev), offset, value,
@@ -397,6 +465,8 @@ int dm_pci_read_config(const struct udevice *dev, int offset,
 {
 	const struct udevice *bus;
 
+	if (pci_get_cached_config(dev, offset, valuep, size))
+		return 0;
 	for (bus = dev; device_is_on_pci_bus(bus);)
 		bus = bus->parent;
 	return pci_bus_read_config(bus, dm_pci_get_bdf(dev), offset, valuep,
@@ -859,24 +929,59 @@ __weak extern void board_pci_fixup_dev(struct udevice *bus, struct udevice *dev)
 {
 }
 
+/**
+ * pci_bus_only_one_child() - Check whether a bus can only have one device
+ *
+ * A PCI Express link below a Root Port or Downstream Port leads to a single
+ * device, so only device 0 need be checked. This saves a config read for each
+ * of the other 31 devices, which with some controllers means waiting for a
+ * timeout each time.
+ *
+ * @bus:	Bus to check
+ * Return: true if only device 0 can be present on the bus
+ */
+static bool pci_bus_only_one_child(struct udevice *bus)
+{
+	int pcie_off, type;
+	u16 flags;
+
+	if (!device_is_on_pci_bus(bus))
+		return false;
+	pcie_off = dm_pci_find_capability(bus, PCI_CAP_ID_EXP);
+	if (!pcie_off)
+		return false;
+	dm_pci_read_config16(bus, pcie_off + PCI_EXP_FLAGS, &flags);
+	type = (flags & PCI_EXP_FLAGS_TYPE) >> 4;
+
+	return type == PCI_EXP_TYPE_ROOT_PORT ||
+		type == PCI_EXP_TYPE_DOWNSTREAM ||
+		type == PCI_EXP_TYPE_PCIE_BRIDGE;
+}
+
 int pci_bind_bus_devices(struct udevice *bus)
 {
 	ulong vendor, device;
 	ulong header_type;
 	pci_dev_t bdf, end;
 	bool found_multi;
+	bool only_one, ari_found;
 	int ari_off;
 	int ret;
 
 	found_multi = false;
+	ari_found = false;
+	only_one = pci_bus_only_one_child(bus);
 	end = PCI_BDF(dev_seq(bus), PCI_MAX_PCI_DEVICES - 1,
 		      PCI_MAX_PCI_FUNCTIONS - 1);
 	for (bdf = PCI_BDF(dev_seq(bus), 0, 0); bdf <= end;
 	     bdf += PCI_BDF(0, 0, 1)) {
 		struct pci_child_plat *pplat;
 		struct udevice *dev;
-		ulong class;
+		ulong class, class_rev;
 
+		/* ARI functions may have any device number */
+		if (only_one && PCI_DEV(bdf) && !ari_found)
+			break;
 		if (!PCI_FUNC(bdf))
 			found_multi = false;
 		if (PCI_FUNC(bdf) && !found_multi)
@@ -898,9 +1003,9 @@ int pci_bind_bus_devices(struct udevice *bus)
 		      dev_seq(bus), bus->name, PCI_DEV(bdf), PCI_FUNC(bdf));
 		pci_bus_read_config(bus, bdf, PCI_DEVICE_ID, &device,
 				    PCI_SIZE_16);
-		pci_bus_read_config(bus, bdf, PCI_CLASS_REVISION, &class,
+		pci_bus_read_config(bus, bdf, PCI_CLASS_REVISION, &class_rev,
 				    PCI_SIZE_32);
-		class >>= 8;
+		class = class_rev >> 8;
 
 		/* Find this device in the device tree */
 		ret = pci_bus_find_devfn(bus, PCI_MASK_BUS(bdf), &dev);
@@ -938,6 +1043,9 @@ int pci_bind_bus_devices(struct udevice *bus)
 		pplat->vendor = vendor;
 		pplat->device = device;
 		pplat->class = class;
+		pplat->revision = class_rev & 0xff;
+		pplat->header_type = header_type;
+		pplat->hdr_cached = true;
 
 		if (IS_ENABLED(CONFIG_PCI_ARID)) {
 			ari_off = dm_pci_find_ext_capability(dev,
@@ -960,6 +1068,7 @@ int pci_bind_bus_devices(struct udevice *bus)
 						      PCI_DEV(ari_cap),
 						      PCI_FUNC(ari_cap));
 					bdf = bdf - 0x100;
+					ari_found = true;
 				}
 			}
 		}
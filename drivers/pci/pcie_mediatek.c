@@ -15,6 +15,7 @@
 #include <malloc.h>
 #include <pci.h>
 #include <reset.h>
+#include <time.h>
 #include <asm/io.h>
 #include <dm/devres.h>
 #include <linux/bitops.h>
@@ -116,6 +117,9 @@
 
 #define PCI_VENDOR_ID_MEDIATEK	0x14c3
 
+/* 100ms timeout value should be enough for Gen1/2 training */
+#define PCIE_LINK_TIMEOUT_MS	100
+
 enum MTK_PCIE_GEN {PCIE_V1, PCIE_V2, PCIE_V3};
 
 struct mtk_pcie_port {
@@ -327,22 +331,48 @@ static void mtk_pcie_port_free(struct mtk_pcie_port *port)
 	free(port);
 }
 
-static int mtk_pcie_startup_port(struct mtk_pcie_port *port)
+/**
+ * mtk_pcie_wait_link() - Wait for a port's link to come up
+ *
+ * All ports start link training before any of them is waited for, so they
+ * share a single timeout, measured from when the last one was started
+ *
+ * @reg: Link-status register
+ * @mask: Bit which is set when the link is up
+ * @start: Time when link training was started, from get_timer()
+ * Return: 0 if the link is up, -ETIMEDOUT if not
+ */
+static int mtk_pcie_wait_link(void __iomem *reg, u32 mask, ulong start)
+{
+	while (!(readl(reg) & mask)) {
+		if (get_timer(start) > PCIE_LINK_TIMEOUT_MS)
+			return -ETIMEDOUT;
+		udelay(10);
+	}
+
+	return 0;
+}
+
+static void mtk_pcie_start_port(struct mtk_pcie_port *port)
 {
 	struct mtk_pcie *pcie = port->pcie;
-	u32 val;
-	int err;
 
 	/* assert port PERST_N */
 	setbits_le32(pcie->base + PCIE_SYS_CFG, PCIE_PORT_PERST(port->slot));
 	/* de-assert port PERST_N */
 	clrbits_le32(pcie->base + PCIE_SYS_CFG, PCIE_PORT_PERST(port->slot));
+}
+
+static int mtk_pcie_startup_port(struct mtk_pcie_port *port, ulong start)
+{
+	struct mtk_pcie *pcie = port->pcie;
+	u32 val;
+	int err;
 
-	/* 100ms timeout value should be enough for Gen1/2 training */
-	err = readl_poll_timeout(port->base + PCIE_LINK_STATUS, val,
-				 !!(val & PCIE_PORT_LINKUP), 100000);
+	err = mtk_pcie_wait_link(port->base + PCIE_LINK_STATUS,
+				 PCIE_PORT_LINKUP, start);
 	if (err)
-		return -ETIMEDOUT;
+		return err;
 
 	/* disable interrupt */
 	clrbits_le32(pcie->base + PCIE_INT_ENABLE,
@@ -370,13 +400,10 @@ static int mtk_pcie_startup_port(struct mtk_pcie_port *port)
 	return 0;
 }
 
-static int mtk_pcie_startup_port_v2(struct mtk_pcie_port *port)
+static void mtk_pcie_start_port_v2(struct mtk_pcie_port *port)
 {
 	struct mtk_pcie *pcie = port->pcie;
-	struct udevice *dev = pcie->priv;
-	struct pci_region *pci_mem;
 	u32 val;
-	int err;
 
 	/* MT7622/MT7629 platforms need to enable LTSSM and ASPM from PCIe subsys */
 	if (pcie->base) {
@@ -401,10 +428,13 @@ static int mtk_pcie_startup_port_v2(struct mtk_pcie_port *port)
 	val = readl(port->base + PCIE_RST_CTRL);
 	val |= PCIE_PHY_RSTB | PCIE_PIPE_SRSTB | PCIE_MAC_SRSTB | PCIE_CRSTB;
 	writel(val, port->base + PCIE_RST_CTRL);
+}
 
-	mdelay(100);
-	val |= PCIE_PERSTB;
-	writel(val, port->base + PCIE_RST_CTRL);
+static void mtk_pcie_release_port_v2(struct mtk_pcie_port *port)
+{
+	u32 val;
+
+	setbits_le32(port->base + PCIE_RST_CTRL, PCIE_PERSTB);
 
 	/* Set up vendor ID and class code */
 	val = PCI_VENDOR_ID_MEDIATEK;
@@ -412,13 +442,20 @@ static int mtk_pcie_startup_port_v2(struct mtk_pcie_port *port)
 
 	val = PCI_CLASS_BRIDGE_PCI;
 	writew(val, port->base + PCIE_CONF_CLASS_ID);
+}
+
+static int mtk_pcie_startup_port_v2(struct mtk_pcie_port *port, ulong start)
+{
+	struct mtk_pcie *pcie = port->pcie;
+	struct udevice *dev = pcie->priv;
+	struct pci_region *pci_mem;
+	u32 val;
+	int err;
 
-	/* 100ms timeout value should be enough for Gen1/2 training */
-	err = readl_poll_timeout(port->base + PCIE_LINK_STATUS_V2, val,
-				 !!(val & PCIE_PORT_LINKUP_V2),
-				 100 * 1000);
+	err = mtk_pcie_wait_link(port->base + PCIE_LINK_STATUS_V2,
+				 PCIE_PORT_LINKUP_V2, start);
 	if (err)
-		return -ETIMEDOUT;
+		return err;
 
 	pci_get_regions(dev, NULL, &pci_mem, NULL);
 
@@ -461,12 +498,10 @@ static void mtk_pcie_enable_port(struct mtk_pcie_port *port)
 	if (err)
 		goto err_phy_on;
 
-	if (!mtk_pcie_startup_port(port))
-		return;
+	mtk_pcie_start_port(port);
 
-	pr_err("Port%d link down\n", port->slot);
+	return;
 
-	generic_phy_power_off(&port->phy);
 err_phy_on:
 	generic_phy_exit(&port->phy);
 err_phy_init:
@@ -476,6 +511,19 @@ err_sys_clk:
 	mtk_pcie_port_free(port);
 }
 
+static void mtk_pcie_link_port(struct mtk_pcie_port *port, ulong start)
+{
+	if (!mtk_pcie_startup_port(port, start))
+		return;
+
+	pr_err("Port%d link down\n", port->slot);
+
+	generic_phy_power_off(&port->phy);
+	generic_phy_exit(&port->phy);
+	clk_disable(&port->sys_ck);
+	mtk_pcie_port_free(port);
+}
+
 static void mtk_pcie_enable_port_v2(struct mtk_pcie_port *port)
 {
 	int err = 0;
@@ -516,12 +564,20 @@ static void mtk_pcie_enable_port_v2(struct mtk_pcie_port *port)
 		goto exit;
 	}
 
-	err = mtk_pcie_startup_port_v2(port);
-	if (!err)
+	mtk_pcie_start_port_v2(port);
+
+	return;
+
+exit:
+	mtk_pcie_port_free(port);
+}
+
+static void mtk_pcie_link_port_v2(struct mtk_pcie_port *port, ulong start)
+{
+	if (!mtk_pcie_startup_port_v2(port, start))
 		return;
 
 	pr_err("Port%d link down\n", port->slot);
-exit:
 	mtk_pcie_port_free(port);
 }
 
@@ -637,6 +693,7 @@ static int mtk_pcie_probe(struct udevice *dev)
 	struct mtk_pcie *pcie = dev_get_priv(dev);
 	struct mtk_pcie_port *port, *tmp;
 	ofnode subnode;
+	ulong start;
 	int err;
 
 	INIT_LIST_HEAD(&pcie->ports);
@@ -672,9 +729,15 @@ static int mtk_pcie_probe(struct udevice *dev)
 			return err;
 	}
 
-	/* enable each port, and then check link status */
+	/*
+	 * Enable each port, and then check link status. All ports train
+	 * their links at the same time, so only wait once.
+	 */
 	list_for_each_entry_safe(port, tmp, &pcie->ports, list)
 		mtk_pcie_enable_port(port);
+	start = get_timer(0);
+	list_for_each_entry_safe(port, tmp, &pcie->ports, list)
+		mtk_pcie_link_port(port, start);
 
 	return 0;
 }
@@ -686,6 +749,7 @@ static int mtk_pcie_probe_v2(struct udevice *dev)
 	struct fdt_pci_addr addr;
 	ofnode subnode;
 	unsigned int slot;
+	ulong start;
 	int err;
 
 	INIT_LIST_HEAD(&pcie->ports);
@@ -710,9 +774,21 @@ static int mtk_pcie_probe_v2(struct udevice *dev)
 			return err;
 	}
 
-	/* enable each port, and then check link status */
+	/*
+	 * Enable each port, and then check link status. The ports are brought
+	 * out of reset together so that the 100ms PERST# delay and the link
+	 * training happen once for all of them, rather than once per port.
+	 */
 	list_for_each_entry_safe(port, tmp, &pcie->ports, list)
 		mtk_pcie_enable_port_v2(port);
+	if (list_empty(&pcie->ports))
+		return 0;
+	mdelay(100);
+	list_for_each_entry_safe(port, tmp, &pcie->ports, list)
+		mtk_pcie_release_port_v2(port);
+	start = get_timer(0);
+	list_for_each_entry_safe(port, tmp, &pcie->ports, list)
+		mtk_pcie_link_port_v2(port, start);
 
 	return 0;
 }
@@ -21,8 +21,19 @@
 
 static bool asynch_allowed;
 
+/**
+ * struct usb_uclass_priv - information about the USB stack as a whole
+ *
+ * @companion_device_count: Number of devices handed over to companion
+ *	controllers during the scan
+ * @scan_pending: true if usb_init_start() has probed the controllers but the
+ *	buses have not yet been scanned by usb_init_finish()
+ * @bus_count: Number of controllers probed by usb_init_start()
+ */
 struct usb_uclass_priv {
 	int companion_device_count;
+	bool scan_pending;
+	int bus_count;
 };
 
 int usb_lock_async(struct usb_device *udev, int lock)
@@ -188,6 +199,13 @@ int usb_stop(void)
 
 	uc_priv = uclass_get_priv(uc);
 
+	/* Forget any ports still waiting to be scanned */
+	if (uc_priv->scan_pending) {
+		if (IS_ENABLED(CONFIG_USB_SCAN_PARALLEL))
+			usb_hub_scan_abort();
+		uc_priv->scan_pending = false;
+	}
+
 	uclass_foreach_dev(bus, uc) {
 		ret = device_remove(bus, DM_REMOVE_NORMAL);
 		if (ret && !err)
@@ -222,29 +240,98 @@ int usb_stop(void)
 	return err;
 }
 
+static void usb_show_scan_result(struct udevice *bus, int ret)
+{
+	struct usb_bus_priv *priv = dev_get_uclass_priv(bus);
+
+	if (ret)
+		printf("failed, error %d\n", ret);
+	else if (priv->next_addr == 0)
+		printf("No USB Device found\n");
+	else
+		printf("%d USB Device(s) found\n", priv->next_addr);
+}
+
 static void usb_scan_bus(struct udevice *bus, bool recurse)
 {
-	struct usb_bus_priv *priv;
 	struct udevice *dev;
 	int ret;
 
-	priv = dev_get_uclass_priv(bus);
-
 	assert(recurse);	/* TODO: Support non-recusive */
 
-	printf("scanning bus %s for devices... ", bus->name);
+	printf("Bus %s: scanning bus %s for devices... ", bus->name, bus->name);
 	debug("\n");
 	ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
-	if (ret)
-		printf("failed, error %d\n", ret);
-	else if (priv->next_addr == 0)
-		printf("No USB Device found\n");
-	else
-		printf("%d USB Device(s) found\n", priv->next_addr);
+	usb_show_scan_result(bus, ret);
+}
+
+/**
+ * usb_scan_buses_start() - Start scanning active controllers for devices
+ *
+ * With CONFIG_USB_SCAN_PARALLEL the root hub of each controller is probed,
+ * which powers on its ports and lists them for scanning. Otherwise this does
+ * nothing.
+ *
+ * @uc:		USB uclass
+ * @companion:	true to scan companion controllers, false to scan the others
+ */
+static void usb_scan_buses_start(struct uclass *uc, bool companion)
+{
+	struct usb_bus_priv *priv;
+	struct udevice *bus, *dev;
+
+	if (!IS_ENABLED(CONFIG_USB_SCAN_PARALLEL))
+		return;
+
+	usb_hub_scan_start();
+	uclass_foreach_dev(bus, uc) {
+		priv = dev_get_uclass_priv(bus);
+		if (device_active(bus) && priv->companion == companion)
+			priv->scan_err = usb_scan_device(bus, 0, USB_SPEED_FULL,
+							 &dev);
+	}
+}
+
+/**
+ * usb_scan_buses_finish() - Finish scanning active controllers for devices
+ *
+ * With CONFIG_USB_SCAN_PARALLEL the ports of all controllers listed by
+ * usb_scan_buses_start() are scanned together. Otherwise each controller is
+ * scanned in turn.
+ *
+ * @uc:		USB uclass
+ * @companion:	true to scan companion controllers, false to scan the others
+ */
+static void usb_scan_buses_finish(struct uclass *uc, bool companion)
+{
+	struct usb_bus_priv *priv;
+	struct udevice *bus;
+
+	if (!IS_ENABLED(CONFIG_USB_SCAN_PARALLEL)) {
+		uclass_foreach_dev(bus, uc) {
+			priv = dev_get_uclass_priv(bus);
+			if (device_active(bus) && priv->companion == companion)
+				usb_scan_bus(bus, true);
+		}
+		return;
+	}
+
+	usb_hub_scan_finish();
+
+	uclass_foreach_dev(bus, uc) {
+		priv = dev_get_uclass_priv(bus);
+		if (device_active(bus) && priv->companion == companion) {
+			printf("Bus %s: scanning bus %s for devices... ",
+			       bus->name, bus->name);
+			usb_show_scan_result(bus, priv->scan_err);
+		}
+	}
 }
 
-static void remove_inactive_children(struct uclass *uc, struct udevice *bus)
+static void remove_inactive_children(struct uclass *uc)
 {
+	struct udevice *bus;
+
 	uclass_foreach_dev(bus, uc) {
 		struct udevice *dev, *next;
 
@@ -288,27 +375,26 @@ static int usb_probe_companion(struct udevice *bus)
 	return 0;
 }
 
-int usb_init(void)
+int usb_init_start(void)
 {
 	int controllers_initialized = 0;
 	struct usb_uclass_priv *uc_priv;
-	struct usb_bus_priv *priv;
 	struct udevice *bus;
 	struct uclass *uc;
 	int ret;
 
-	asynch_allowed = 1;
-
 	ret = uclass_get(UCLASS_USB, &uc);
 	if (ret)
 		return ret;
 
 	uc_priv = uclass_get_priv(uc);
+	if (uc_priv->scan_pending)
+		return 0;
 
-	uclass_foreach_dev(bus, uc) {
-		/* init low_level USB */
-		printf("Bus %s: ", bus->name);
+	asynch_allowed = 1;
+	uc_priv->bus_count = 0;
 
+	uclass_foreach_dev(bus, uc) {
 		/*
 		 * For Sandbox, we need scan the device tree each time when we
 		 * start the USB stack, in order to re-create the emulated USB
@@ -322,20 +408,23 @@ int usb_init(void)
 		    IS_ENABLED(CONFIG_USB_ONBOARD_HUB)) {
 			ret = dm_scan_fdt_dev(bus);
 			if (ret) {
-				printf("USB device scan from fdt failed (%d)", ret);
+				printf("Bus %s: USB device scan from fdt failed (%d)",
+				       bus->name, ret);
 				continue;
 			}
 		}
 
+		/* init low_level USB */
 		ret = device_probe(bus);
 		if (ret == -ENODEV) {	/* No such device. */
-			puts("Port not available.\n");
+			printf("Bus %s: Port not available.\n", bus->name);
 			controllers_initialized++;
 			continue;
 		}
 
 		if (ret) {		/* Other error. */
-			printf("probe failed, error %d\n", ret);
+			printf("Bus %s: probe failed, error %d\n", bus->name,
+			       ret);
 			continue;
 		}
 
@@ -344,21 +433,40 @@ int usb_init(void)
 			continue;
 
 		controllers_initialized++;
-		usb_started = true;
+		uc_priv->bus_count++;
 	}
 
+	/* if we were not able to find at least one working bus, bail out */
+	if (controllers_initialized == 0)
+		printf("No USB controllers found\n");
+
 	/*
-	 * lowlevel init done, now scan the bus for devices i.e. search HUBs
-	 * and configure them, first scan primary controllers.
+	 * lowlevel init done, now start looking for devices on the primary
+	 * controllers
 	 */
-	uclass_foreach_dev(bus, uc) {
-		if (!device_active(bus))
-			continue;
+	usb_scan_buses_start(uc, false);
+	uc_priv->scan_pending = true;
 
-		priv = dev_get_uclass_priv(bus);
-		if (!priv->companion)
-			usb_scan_bus(bus, true);
-	}
+	return uc_priv->bus_count ? 0 : -ENOENT;
+}
+
+int usb_init_finish(void)
+{
+	struct usb_uclass_priv *uc_priv;
+	struct uclass *uc;
+	int ret;
+
+	ret = uclass_get(UCLASS_USB, &uc);
+	if (ret)
+		return ret;
+
+	uc_priv = uclass_get_priv(uc);
+	if (!uc_priv->scan_pending)
+		return usb_started ? 0 : -ENOENT;
+	uc_priv->scan_pending = false;
+
+	/* Search HUBs and configure them, first on primary controllers */
+	usb_scan_buses_finish(uc, false);
 
 	/*
 	 * Now that the primary controllers have been scanned and have handed
@@ -366,33 +474,36 @@ int usb_init(void)
 	 * the companions if necessary.
 	 */
 	if (uc_priv->companion_device_count) {
-		uclass_foreach_dev(bus, uc) {
-			if (!device_active(bus))
-				continue;
-
-			priv = dev_get_uclass_priv(bus);
-			if (priv->companion)
-				usb_scan_bus(bus, true);
-		}
+		usb_scan_buses_start(uc, true);
+		usb_scan_buses_finish(uc, true);
 	}
 
 	debug("scan end\n");
 
 	/* Remove any devices that were not found on this scan */
-	remove_inactive_children(uc, bus);
+	remove_inactive_children(uc);
 
 	ret = uclass_get(UCLASS_USB_HUB, &uc);
 	if (ret)
 		return ret;
-	remove_inactive_children(uc, bus);
+	remove_inactive_children(uc);
 
-	/* if we were not able to find at least one working bus, bail out */
-	if (controllers_initialized == 0)
-		printf("No USB controllers found\n");
+	usb_started = uc_priv->bus_count > 0;
 
 	return usb_started ? 0 : -ENOENT;
 }
 
+int usb_init(void)
+{
+	int ret;
+
+	ret = usb_init_start();
+	if (ret && ret != -ENOENT)
+		return ret;
+
+	return usb_init_finish();
+}
+
 int usb_setup_ehci_gadget(struct ehci_ctrl **ctlrp)
 {
 	struct usb_plat *plat;
@@ -19,23 +19,20 @@ static int console_set_row(struct udevice *dev, uint row, int clr)
 	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
 	struct console_simple_priv *priv = dev_get_priv(dev);
 	struct video_fontdata *fontdata = priv->fontdata;
-	void *line, *dst, *end;
+	void *line, *end;
 	int pixels = fontdata->height * vid_priv->xsize;
 	int ret;
-	int i;
-	int pbytes;
 
 	ret = check_bpix_support(vid_priv->bpix);
 	if (ret)
 		return ret;
 
 	line = vid_priv->fb + row * fontdata->height * vid_priv->line_length;
-	dst = line;
-	pbytes = VNBYTES(vid_priv->bpix);
-	for (i = 0; i < pixels; i++)
-		fill_pixel_and_goto_next(&dst, clr, pbytes, pbytes);
-	end = dst;
+	video_fill_pixels(line, vid_priv->bpix, clr, pixels);
+	end = line + pixels * VNBYTES(vid_priv->bpix);
 
+	video_damage(dev->parent, 0, row * fontdata->height, vid_priv->xsize,
+		     fontdata->height);
 	ret = vidconsole_sync_copy(dev, line, end);
 	if (ret)
 		return ret;
@@ -57,6 +54,8 @@ static int console_move_rows(struct udevice *dev, uint rowdst,
 	dst = vid_priv->fb + rowdst * fontdata->height * vid_priv->line_length;
 	src = vid_priv->fb + rowsrc * fontdata->height * vid_priv->line_length;
 	size = fontdata->height * vid_priv->line_length * count;
+	video_damage(dev->parent, 0, rowdst * fontdata->height,
+		     vid_priv->xsize, fontdata->height * count);
 	ret = vidconsole_memmove(dev, dst, src, size);
 	if (ret)
 		return ret;
@@ -92,6 +91,7 @@ static int console_putc_xy(struct udevice *dev, uint x_frac, uint y, int cp)
 	if (ret)
 		return ret;
 
+	video_damage(vid, x, y, fontdata->width, fontdata->height);
 	ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
@@ -116,6 +116,7 @@ static int console_set_cursor_visible(struct udevice *dev, bool visible,
 
 	x += index * fontdata->width;
 	start = vid_priv->fb + y * vid_priv->line_length + x * pbytes;
+	video_damage(vid, x, y, VIDCONSOLE_CURSOR_WIDTH, vc_priv->y_charsize);
 
 	/* place the cursor 1 pixel before the start of the next char */
 	x -= 1;
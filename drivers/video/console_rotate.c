@@ -20,17 +20,19 @@ static int console_set_row_1(struct udevice *dev, uint row, int clr)
 	struct console_simple_priv *priv = dev_get_priv(dev);
 	struct video_fontdata *fontdata = priv->fontdata;
 	int pbytes = VNBYTES(vid_priv->bpix);
-	void *start, *dst, *line;
-	int i, j;
+	void *start, *line;
+	int j;
 	int ret;
 
 	start = vid_priv->fb + vid_priv->line_length -
 		(row + 1) * fontdata->height * pbytes;
+	video_damage(dev->parent,
+		     vid_priv->line_length / pbytes -
+		     (row + 1) * fontdata->height,
+		     0, fontdata->height, vid_priv->ysize);
 	line = start;
 	for (j = 0; j < vid_priv->ysize; j++) {
-		dst = line;
-		for (i = 0; i < fontdata->height; i++)
-			fill_pixel_and_goto_next(&dst, clr, pbytes, pbytes);
+		video_fill_pixels(line, vid_priv->bpix, clr, fontdata->height);
 		line += vid_priv->line_length;
 	}
 	ret = vidconsole_sync_copy(dev, start, line);
@@ -55,6 +57,10 @@ static int console_move_rows_1(struct udevice *dev, uint rowdst, uint rowsrc,
 		(rowdst + count) * fontdata->height * pbytes;
 	src = vid_priv->fb + vid_priv->line_length -
 		(rowsrc + count) * fontdata->height * pbytes;
+	video_damage(dev->parent,
+		     vid_priv->line_length / pbytes -
+		     (rowdst + count) * fontdata->height,
+		     0, fontdata->height * count, vid_priv->ysize);
 
 	for (j = 0; j < vid_priv->ysize; j++) {
 		ret = vidconsole_memmove(dev, dst, src,
@@ -92,6 +98,9 @@ static int console_putc_xy_1(struct udevice *dev, uint x_frac, uint y, int cp)
 	ret = fill_char_horizontally(pfont, &line, vid_priv, fontdata, FLIPPED_DIRECTION);
 	if (ret)
 		return ret;
+	video_damage(vid,
+		     vid_priv->line_length / pbytes - x - fontdata->height + 1,
+		     linenum - 1, fontdata->height, fontdata->width);
 
 	/* We draw backwards from 'start, so account for the first line */
 	ret = vidconsole_sync_copy(dev, start - vid_priv->line_length, line);
@@ -107,18 +116,18 @@ static int console_set_row_2(struct udevice *dev, uint row, int clr)
 	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
 	struct console_simple_priv *priv = dev_get_priv(dev);
 	struct video_fontdata *fontdata = priv->fontdata;
-	void *start, *line, *dst, *end;
+	void *start, *end;
 	int pixels = fontdata->height * vid_priv->xsize;
-	int i, ret;
+	int ret;
 	int pbytes = VNBYTES(vid_priv->bpix);
 
 	start = vid_priv->fb + vid_priv->ysize * vid_priv->line_length -
 		(row + 1) * fontdata->height * vid_priv->line_length;
-	line = start;
-	dst = line;
-	for (i = 0; i < pixels; i++)
-		fill_pixel_and_goto_next(&dst, clr, pbytes, pbytes);
-	end = dst;
+	video_damage(dev->parent, 0,
+		     vid_priv->ysize - (row + 1) * fontdata->height,
+		     vid_priv->xsize, fontdata->height);
+	video_fill_pixels(start, vid_priv->bpix, clr, pixels);
+	end = start + pixels * pbytes;
 	ret = vidconsole_sync_copy(dev, start, end);
 	if (ret)
 		return ret;
@@ -141,6 +150,9 @@ static int console_move_rows_2(struct udevice *dev, uint rowdst, uint rowsrc,
 		vid_priv->line_length;
 	src = end - (rowsrc + count) * fontdata->height *
 		vid_priv->line_length;
+	video_damage(dev->parent, 0,
+		     vid_priv->ysize - (rowdst + count) * fontdata->height,
+		     vid_priv->xsize, fontdata->height * count);
 	vidconsole_memmove(dev, dst, src,
 			   fontdata->height * vid_priv->line_length * count);
 
@@ -171,6 +183,9 @@ static int console_putc_xy_2(struct udevice *dev, uint x_frac, uint y, int cp)
 	ret = fill_char_vertically(pfont, &line, vid_priv, fontdata, FLIPPED_DIRECTION);
 	if (ret)
 		return ret;
+	video_damage(vid, x - fontdata->width + 1,
+		     linenum - fontdata->height + 1, fontdata->width,
+		     fontdata->height);
 
 	/* Add 4 bytes to allow for the first pixel writen */
 	ret = vidconsole_sync_copy(dev, start + 4, line);
@@ -186,15 +201,15 @@ static int console_set_row_3(struct udevice *dev, uint row, int clr)
 	struct console_simple_priv *priv = dev_get_priv(dev);
 	struct video_fontdata *fontdata = priv->fontdata;
 	int pbytes = VNBYTES(vid_priv->bpix);
-	void *start, *dst, *line;
-	int i, j, ret;
+	void *start, *line;
+	int j, ret;
 
 	start = vid_priv->fb + row * fontdata->height * pbytes;
+	video_damage(dev->parent, row * fontdata->height, 0, fontdata->height,
+		     vid_priv->ysize);
 	line = start;
 	for (j = 0; j < vid_priv->ysize; j++) {
-		dst = line;
-		for (i = 0; i < fontdata->height; i++)
-			fill_pixel_and_goto_next(&dst, clr, pbytes, pbytes);
+		video_fill_pixels(line, vid_priv->bpix, clr, fontdata->height);
 		line += vid_priv->line_length;
 	}
 	ret = vidconsole_sync_copy(dev, start, line);
@@ -217,6 +232,8 @@ static int console_move_rows_3(struct udevice *dev, uint rowdst, uint rowsrc,
 
 	dst = vid_priv->fb + rowdst * fontdata->height * pbytes;
 	src = vid_priv->fb + rowsrc * fontdata->height * pbytes;
+	video_damage(dev->parent, rowdst * fontdata->height, 0,
+		     fontdata->height * count, vid_priv->ysize);
 
 	for (j = 0; j < vid_priv->ysize; j++) {
 		ret = vidconsole_memmove(dev, dst, src,
@@ -254,6 +271,8 @@ static int console_putc_xy_3(struct udevice *dev, uint x_frac, uint y, int cp)
 	ret = fill_char_horizontally(pfont, &line, vid_priv, fontdata, NORMAL_DIRECTION);
 	if (ret)
 		return ret;
+	video_damage(vid, y, linenum - fontdata->width + 1, fontdata->height,
+		     fontdata->width);
 	/* Add a line to allow for the first pixels writen */
 	ret = vidconsole_sync_copy(dev, start + vid_priv->line_length, line);
 	if (ret)
@@ -11,6 +11,7 @@
 #include <spl.h>
 #include <video.h>
 #include <video_console.h>
+#include <linux/list.h>
 
 /* Functions needed by stb_truetype.h */
 static int tt_floor(double val)
@@ -156,6 +157,45 @@ struct console_tt_metrics {
 	double scale;
 };
 
+enum {
+	/* Number of horizontal positions within a pixel which are rendered */
+	GLYPH_SUBPIXELS		= 4,
+	GLYPH_HASH_SIZE		= 64,
+};
+
+#define GLYPH_CACHE_SIZE	IF_ENABLED_INT(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE, \
+				       CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE_SIZE)
+
+/**
+ * struct console_tt_glyph - A rendered character held in the glyph cache
+ *
+ * @sibling:	Node in the list of glyphs, most recently used first
+ * @next:	Next glyph in the same hash bucket
+ * @met:	Font / size this glyph was rendered with
+ * @cp:		Unicode code point
+ * @shift:	Horizontal offset within the pixel, in 1 / GLYPH_SUBPIXELS
+ * @advance:	Horizontal advance in font units
+ * @width:	Width of bitmap in pixels
+ * @height:	Height of bitmap in pixels
+ * @xoff:	X offset of bitmap from the cursor position
+ * @yoff:	Y offset of bitmap from the baseline
+ * @bits:	8-bit alpha bitmap, @width * @height bytes, or NULL if the
+ *		character draws nothing (e.g. a space)
+ */
+struct console_tt_glyph {
+	struct list_head sibling;
+	struct console_tt_glyph *next;
+	struct console_tt_metrics *met;
+	int cp;
+	int shift;
+	int advance;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	u8 *bits;
+};
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -168,6 +208,11 @@ struct console_tt_metrics {
  *		last character. We record enough characters to go back to the
  *		start of the current command line.
  * @pos_ptr:	Current position in the position history
+ * @glyphs:	List of cached glyphs, most recently used first
+ * @glyph_hash:	Hash table of cached glyphs, indexed by glyph_hash()
+ * @glyph_used:	Number of bytes used by cached glyphs
+ * @glyph_hits:	Number of characters drawn from the glyph cache
+ * @glyph_misses: Number of characters which had to be rendered
  */
 struct console_tt_priv {
 	struct console_tt_metrics *cur_met;
@@ -175,6 +220,11 @@ struct console_tt_priv {
 	int num_metrics;
 	struct pos_info pos[POS_HISTORY_SIZE];
 	int pos_ptr;
+	struct list_head glyphs;
+	struct console_tt_glyph *glyph_hash[GLYPH_HASH_SIZE];
+	uint glyph_used;
+	uint glyph_hits;
+	uint glyph_misses;
 };
 
 /**
@@ -198,35 +248,16 @@ static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 
 	line = vid_priv->fb + row * met->font_size * vid_priv->line_length;
 	end = line + met->font_size * vid_priv->line_length;
+	video_damage(dev->parent, 0, row * met->font_size, vid_priv->xsize,
+		     met->font_size);
 
 	switch (vid_priv->bpix) {
-	case VIDEO_BPP8: {
-		u8 *dst;
-
-		if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-			for (dst = line; dst < (u8 *)end; ++dst)
-				*dst = clr;
-		}
-		break;
-	}
-	case VIDEO_BPP16: {
-		u16 *dst = line;
-
-		if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-			for (dst = line; dst < (u16 *)end; ++dst)
-				*dst = clr;
-		}
+	case VIDEO_BPP8:
+	case VIDEO_BPP16:
+	case VIDEO_BPP32:
+		video_fill_pixels(line, vid_priv->bpix, clr,
+				  (end - line) / VNBYTES(vid_priv->bpix));
 		break;
-	}
-	case VIDEO_BPP32: {
-		u32 *dst = line;
-
-		if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-			for (dst = line; dst < (u32 *)end; ++dst)
-				*dst = clr;
-		}
-		break;
-	}
 	default:
 		return -ENOSYS;
 	}
@@ -249,6 +280,8 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 
 	dst = vid_priv->fb + rowdst * met->font_size * vid_priv->line_length;
 	src = vid_priv->fb + rowsrc * met->font_size * vid_priv->line_length;
+	video_damage(dev->parent, 0, rowdst * met->font_size, vid_priv->xsize,
+		     met->font_size * count);
 	ret = vidconsole_memmove(dev, dst, src, met->font_size *
 				 vid_priv->line_length * count);
 	if (ret)
@@ -262,6 +295,192 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+static uint glyph_hash(struct console_tt_priv *priv,
+		       struct console_tt_metrics *met, int cp, int shift)
+{
+	return ((met - priv->metrics) * 7 + cp * GLYPH_SUBPIXELS + shift) %
+		GLYPH_HASH_SIZE;
+}
+
+static uint glyph_size(struct console_tt_glyph *glyph)
+{
+	return sizeof(*glyph) + (glyph->bits ? glyph->width * glyph->height : 0);
+}
+
+static void glyph_free(struct console_tt_priv *priv,
+		       struct console_tt_glyph *glyph)
+{
+	struct console_tt_glyph **linkp;
+
+	linkp = &priv->glyph_hash[glyph_hash(priv, glyph->met, glyph->cp,
+					     glyph->shift)];
+	while (*linkp != glyph)
+		linkp = &(*linkp)->next;
+	*linkp = glyph->next;
+	list_del(&glyph->sibling);
+	priv->glyph_used -= glyph_size(glyph);
+	free(glyph->bits);
+	free(glyph);
+}
+
+/**
+ * glyph_get() - Get a rendered character, using the cache if possible
+ *
+ * If the character is not in the cache it is rendered and added, dropping the
+ * least recently used characters as needed to stay within the memory budget.
+ *
+ * @priv:	Private data
+ * @met:	Font / size to use
+ * @cp:		Unicode code point
+ * @shift:	Horizontal offset within the pixel, in 1 / GLYPH_SUBPIXELS
+ * Return: glyph, or NULL if it could not be cached
+ */
+static struct console_tt_glyph *glyph_get(struct console_tt_priv *priv,
+					  struct console_tt_metrics *met,
+					  int cp, int shift)
+{
+	struct console_tt_glyph *glyph, **headp;
+	int lsb;
+
+	headp = &priv->glyph_hash[glyph_hash(priv, met, cp, shift)];
+	for (glyph = *headp; glyph; glyph = glyph->next) {
+		if (glyph->met == met && glyph->cp == cp &&
+		    glyph->shift == shift) {
+			list_move(&glyph->sibling, &priv->glyphs);
+			priv->glyph_hits++;
+			return glyph;
+		}
+	}
+
+	priv->glyph_misses++;
+	glyph = malloc(sizeof(*glyph));
+	if (!glyph)
+		return NULL;
+	glyph->met = met;
+	glyph->cp = cp;
+	glyph->shift = shift;
+	stbtt_GetCodepointHMetrics(&met->font, cp, &glyph->advance, &lsb);
+	glyph->bits = stbtt_GetCodepointBitmapSubpixel(&met->font, met->scale,
+			met->scale, (double)shift / GLYPH_SUBPIXELS, 0, cp,
+			&glyph->width, &glyph->height, &glyph->xoff,
+			&glyph->yoff);
+	if ((!glyph->bits && glyph->width && glyph->height) ||
+	    glyph_size(glyph) > GLYPH_CACHE_SIZE) {
+		free(glyph->bits);
+		free(glyph);
+		return NULL;
+	}
+
+	while (priv->glyph_used + glyph_size(glyph) > GLYPH_CACHE_SIZE)
+		glyph_free(priv, list_last_entry(&priv->glyphs,
+						 struct console_tt_glyph,
+						 sibling));
+	glyph->next = *headp;
+	*headp = glyph;
+	list_add(&glyph->sibling, &priv->glyphs);
+	priv->glyph_used += glyph_size(glyph);
+
+	return glyph;
+}
+
+/**
+ * console_truetype_blit() - Draw a character bitmap into the frame buffer
+ *
+ * This converts the 8bpp image into the colour depth of the display. We only
+ * expect white-on-black or the reverse so the code only handles this simple
+ * case. Pixels which would not change the frame buffer are skipped, since
+ * reading it back can be slow.
+ *
+ * @vid_priv:	Video device's uclass-private data
+ * @line:	Start of the first line of the frame buffer to write to
+ * @xoff:	X position within the line, in pixels
+ * @bits:	8-bit alpha bitmap to draw
+ * @width:	Width of bitmap in pixels
+ * @height:	Height of bitmap in pixels
+ * Return: 0 if OK, -ENOSYS if the display depth is not supported
+ */
+static int console_truetype_blit(struct video_priv *vid_priv, void *line,
+				 int xoff, const u8 *bits, int width,
+				 int height)
+{
+	uint inv = vid_priv->colour_bg ? 0xff : 0;
+	bool set = vid_priv->colour_fg;
+	uint skip, mult;
+	int row, i;
+
+	/* ORing in zero, or ANDing in all ones, leaves the pixel unchanged */
+	skip = set ? 0 : 0xff;
+
+	for (row = 0; row < height; row++, line += vid_priv->line_length) {
+		switch (vid_priv->bpix) {
+		case VIDEO_BPP8:
+			if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
+				u8 *dst = line + xoff;
+
+				for (i = 0; i < width; i++, dst++) {
+					uint val = *bits++ ^ inv;
+
+					if (val == skip)
+						continue;
+					if (set)
+						*dst |= val;
+					else
+						*dst &= val;
+				}
+			}
+			break;
+		case VIDEO_BPP16:
+			if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
+				u16 *dst = (u16 *)line + xoff;
+
+				for (i = 0; i < width; i++, dst++) {
+					uint val = *bits++ ^ inv;
+					u16 out;
+
+					if (val == skip)
+						continue;
+					out = val >> 3 | (val >> 2) << 5 |
+						(val >> 3) << 11;
+					if (set)
+						*dst |= out;
+					else
+						*dst &= out;
+				}
+			}
+			break;
+		case VIDEO_BPP32:
+			if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
+				u32 *dst = (u32 *)line + xoff;
+
+				/* Copy the value into each colour component */
+				if (vid_priv->format == VIDEO_X2R10G10B10)
+					mult = 1 << 2 | 1 << 12 | 1 << 22;
+				else
+					mult = 1 | 1 << 8 | 1 << 16;
+
+				/* ANDing in white clears the top bits, so skip nothing */
+				if (!set)
+					skip = ~0;
+				for (i = 0; i < width; i++, dst++) {
+					uint val = *bits++ ^ inv;
+
+					if (val == skip)
+						continue;
+					if (set)
+						*dst |= val * mult;
+					else
+						*dst &= val * mult;
+				}
+			}
+			break;
+		default:
+			return -ENOSYS;
+		}
+	}
+
+	return 0;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    int cp)
 {
@@ -271,6 +490,7 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	struct console_tt_metrics *met = priv->cur_met;
 	stbtt_fontinfo *font = &met->font;
+	struct console_tt_glyph *glyph = NULL;
 	int width, height, xoff, yoff;
 	double xpos, x_shift;
 	int lsb;
@@ -278,11 +498,8 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct pos_info *pos;
 	u8 *bits, *data;
 	int advance;
-	void *start, *end, *line;
-	int row, ret;
-
-	/* First get some basic metrics about this character */
-	stbtt_GetCodepointHMetrics(font, cp, &advance, &lsb);
+	void *start;
+	int ret;
 
 	/*
 	 * First out our current X position in fractional pixels. If we wrote
@@ -293,6 +510,23 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 		xpos += met->scale * stbtt_GetCodepointKernAdvance(font,
 							vc_priv->last_ch, cp);
 	}
+	x_shift = xpos - (double)tt_floor(xpos);
+
+	/*
+	 * Get some basic metrics about this character. With the glyph cache,
+	 * the position within the pixel is rounded down so that each character
+	 * only needs to be rendered at a few positions.
+	 */
+	if (IS_ENABLED(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE)) {
+		int shift = (int)(x_shift * GLYPH_SUBPIXELS);
+
+		x_shift = (double)shift / GLYPH_SUBPIXELS;
+		glyph = glyph_get(priv, met, cp, shift);
+	}
+	if (glyph)
+		advance = glyph->advance;
+	else
+		stbtt_GetCodepointHMetrics(font, cp, &advance, &lsb);
 
 	/*
 	 * Figure out where the cursor will move to after this character, and
@@ -300,8 +534,6 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * effective width of this character, which will be our return value:
 	 * it dictates how much the cursor will move forward on the line.
 	 */
-	x_shift = xpos - (double)tt_floor(xpos);
-	xpos += advance * met->scale;
 	width_frac = (int)VID_TO_POS(advance * met->scale);
 	if (x + width_frac >= vc_priv->xsize_frac)
 		return -EAGAIN;
@@ -320,109 +552,40 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * image of the character. For empty characters, like ' ', data will
 	 * return NULL;
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, met->scale, met->scale,
-						x_shift, 0, cp, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+	if (glyph) {
+		data = NULL;
+		bits = glyph->bits;
+		width = glyph->width;
+		height = glyph->height;
+		xoff = glyph->xoff;
+		yoff = glyph->yoff;
+	} else {
+		data = stbtt_GetCodepointBitmapSubpixel(font, met->scale,
+							met->scale, x_shift, 0,
+							cp, &width, &height,
+							&xoff, &yoff);
+		bits = data;
+	}
+	if (!bits)
 		return width_frac;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
 	start = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
 	linenum = met->baseline + yoff;
 	if (linenum > 0)
 		start += linenum * vid_priv->line_length;
-	line = start;
+	video_damage(vid, VID_TO_PIXEL(x) + xoff, y + max(linenum, 0), width,
+		     height);
 
-	/*
-	 * Write a row at a time, converting the 8bpp image into the colour
-	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
-	 */
-	for (row = 0; row < height; row++) {
-		switch (vid_priv->bpix) {
-		case VIDEO_BPP8:
-			if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-				u8 *dst = line + xoff;
-				int i;
-
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
-			int i;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val >> 3 |
-						(val >> 2) << 5 |
-						(val >> 3) << 11;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		}
-		case VIDEO_BPP32: {
-			u32 *dst = (u32 *)line + xoff;
-			int i;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					if (vid_priv->format == VIDEO_X2R10G10B10)
-						out = val << 2 | val << 12 | val << 22;
-					else
-						out = val | val << 8 | val << 16;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		}
-		default:
-			free(data);
-			return -ENOSYS;
-		}
-
-		line += vid_priv->line_length;
-	}
-	ret = vidconsole_sync_copy(dev, start, line);
+	ret = console_truetype_blit(vid_priv, start, xoff, bits, width, height);
+	free(data);
+	if (ret)
+		return ret;
+	ret = vidconsole_sync_copy(dev, start,
+				   start + height * vid_priv->line_length);
 	if (ret)
 		return ret;
-	free(data);
 
 	return width_frac;
 }
@@ -881,6 +1044,7 @@ static int truetype_set_cursor_visible(struct udevice *dev, bool visible,
 	start = vid_priv->fb + y * vid_priv->line_length +
 		x * VNBYTES(vid_priv->bpix);
 	line = start;
+	video_damage(vid, x, y, width, height);
 
 	/* draw a vertical bar in the correct position */
 	for (row = 0; row < height; row++) {
@@ -959,6 +1123,16 @@ const char *console_truetype_get_font_size(struct udevice *dev, uint *sizep)
 	return met->font_name;
 }
 
+void console_truetype_glyph_stats(struct udevice *dev, uint *hitsp,
+				  uint *missesp, uint *usedp)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+
+	*hitsp = priv->glyph_hits;
+	*missesp = priv->glyph_misses;
+	*usedp = priv->glyph_used;
+}
+
 static int console_truetype_probe(struct udevice *dev)
 {
 	struct console_tt_priv *priv = dev_get_priv(dev);
@@ -969,6 +1143,7 @@ static int console_truetype_probe(struct udevice *dev)
 	int ret;
 
 	debug("%s: start\n", __func__);
+	INIT_LIST_HEAD(&priv->glyphs);
 	if (vid_priv->font_size)
 		font_size = vid_priv->font_size;
 	else
@@ -991,6 +1166,18 @@ static int console_truetype_probe(struct udevice *dev)
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+
+	while (!list_empty(&priv->glyphs))
+		glyph_free(priv, list_first_entry(&priv->glyphs,
+						  struct console_tt_glyph,
+						  sibling));
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -1012,5 +1199,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto	= sizeof(struct console_tt_priv),
 };
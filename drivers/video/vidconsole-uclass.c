@@ -771,7 +771,7 @@ int vidconsole_sync_copy(struct udevice *dev, void *from, void *to)
 int vidconsole_memmove(struct udevice *dev, void *dst, const void *src,
 		       int size)
 {
-	memmove(dst, src, size);
+	video_move_pixels(dst, src, size);
 	return vidconsole_sync_copy(dev, dst, dst + size);
 }
 #endif
@@ -153,45 +153,20 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 	void *start, *line;
 	int pixels = xend - xstart;
-	int row, i, ret;
+	int row, ret;
+
+	if (priv->bpix != VIDEO_BPP8 && priv->bpix != VIDEO_BPP16 &&
+	    priv->bpix != VIDEO_BPP32)
+		return -ENOSYS;
 
 	start = priv->fb + ystart * priv->line_length;
 	start += xstart * VNBYTES(priv->bpix);
 	line = start;
 	for (row = ystart; row < yend; row++) {
-		switch (priv->bpix) {
-		case VIDEO_BPP8: {
-			u8 *dst = line;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
-			}
-			break;
-		}
-		case VIDEO_BPP16: {
-			u16 *dst = line;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
-			}
-			break;
-		}
-		case VIDEO_BPP32: {
-			u32 *dst = line;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
-			}
-			break;
-		}
-		default:
-			return -ENOSYS;
-		}
+		video_fill_pixels(line, priv->bpix, colour, pixels);
 		line += priv->line_length;
 	}
+	video_damage(dev, xstart, ystart, pixels, yend - ystart);
 	ret = video_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
@@ -218,29 +193,12 @@ int video_fill(struct udevice *dev, u32 colour)
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 	int ret;
 
-	switch (priv->bpix) {
-	case VIDEO_BPP16:
-		if (CONFIG_IS_ENABLED(VIDEO_BPP16)) {
-			u16 *ppix = priv->fb;
-			u16 *end = priv->fb + priv->fb_size;
-
-			while (ppix < end)
-				*ppix++ = colour;
-			break;
-		}
-	case VIDEO_BPP32:
-		if (CONFIG_IS_ENABLED(VIDEO_BPP32)) {
-			u32 *ppix = priv->fb;
-			u32 *end = priv->fb + priv->fb_size;
-
-			while (ppix < end)
-				*ppix++ = colour;
-			break;
-		}
-	default:
+	if (priv->bpix >= VIDEO_BPP16)
+		video_fill_pixels(priv->fb, priv->bpix, colour,
+				  priv->fb_size / VNBYTES(priv->bpix));
+	else
 		memset(priv->fb, colour, priv->fb_size);
-		break;
-	}
+	video_damage(dev, 0, 0, priv->xsize, priv->ysize);
 	ret = video_sync_copy(dev, priv->fb, priv->fb + priv->fb_size);
 	if (ret)
 		return ret;
@@ -347,6 +305,104 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = video_index_to_colour(priv, back);
 }
 
+/**
+ * video_flush_dcache() - Flush part of the frame buffer from the data cache
+ *
+ * @priv:	Video device's uclass-private data
+ * @offset:	Offset of the first byte to flush from the start of the frame
+ *		buffer
+ * @len:	Number of bytes to flush
+ */
+static void video_flush_dcache(struct video_priv *priv, ulong offset,
+			       ulong len)
+{
+	/*
+	 * flush_dcache_range() is declared in common.h but it seems that some
+	 * architectures do not actually implement it. Is there a way to find
+	 * out whether it exists? For now, ARM is safe.
+	 */
+#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
+	ulong start = (ulong)priv->fb + offset;
+
+	if (priv->flush_dcache) {
+		flush_dcache_range(ALIGN_DOWN(start, CONFIG_SYS_CACHELINE_SIZE),
+				   ALIGN(start + len, CONFIG_SYS_CACHELINE_SIZE));
+	}
+#endif
+}
+
+#ifdef CONFIG_VIDEO_DAMAGE
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_bbox *damage = &priv->damage;
+	int xend = min(x + width, (int)priv->xsize);
+	int yend = min(y + height, (int)priv->ysize);
+
+	x = max(x, 0);
+	y = max(y, 0);
+	if (x >= xend || y >= yend)
+		return;
+
+	if (damage->x1 <= damage->x0 || damage->y1 <= damage->y0) {
+		damage->x0 = x;
+		damage->y0 = y;
+		damage->x1 = xend;
+		damage->y1 = yend;
+	} else {
+		damage->x0 = min(damage->x0, x);
+		damage->y0 = min(damage->y0, y);
+		damage->x1 = max(damage->x1, xend);
+		damage->y1 = max(damage->y1, yend);
+	}
+}
+
+/**
+ * video_sync_damage() - Copy and flush the part of the frame buffer changed
+ *
+ * This handles the area recorded by video_damage() since the last sync, then
+ * clears it
+ *
+ * @vid:	Video device to sync
+ */
+static void video_sync_damage(struct udevice *vid)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_bbox *damage = &priv->damage;
+	uint bits = VNBITS(priv->bpix);
+	ulong offset, len;
+	int rows, i;
+
+	if (damage->x1 <= damage->x0 || damage->y1 <= damage->y0)
+		return;
+
+	offset = damage->y0 * priv->line_length + damage->x0 * bits / 8;
+	len = DIV_ROUND_UP(damage->x1 * bits, 8) - damage->x0 * bits / 8;
+	rows = damage->y1 - damage->y0;
+
+	/* Whole lines are contiguous, so handle them together */
+	if (!damage->x0 && damage->x1 == priv->xsize) {
+		len = rows * priv->line_length;
+		rows = 1;
+	}
+
+	for (i = 0; i < rows; i++, offset += priv->line_length) {
+		if (IS_ENABLED(CONFIG_VIDEO_COPY) && priv->copy_fb)
+			memcpy(priv->copy_fb + offset, priv->fb + offset, len);
+		video_flush_dcache(priv, offset, len);
+	}
+
+	priv->sync_count++;
+	priv->last_sync_bytes = rows * len;
+	priv->sync_bytes += priv->last_sync_bytes;
+	memset(damage, '\0', sizeof(*damage));
+}
+#else
+static inline void video_sync_damage(struct udevice *vid)
+{
+}
+#endif
+
 /* Flush video activity to the caches */
 int video_sync(struct udevice *vid, bool force)
 {
@@ -359,20 +415,15 @@ int video_sync(struct udevice *vid, bool force)
 			return ret;
 	}
 
-	/*
-	 * flush_dcache_range() is declared in common.h but it seems that some
-	 * architectures do not actually implement it. Is there a way to find
-	 * out whether it exists? For now, ARM is safe.
-	 */
-#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		video_sync_damage(vid);
+	} else {
+		struct video_priv *priv = dev_get_uclass_priv(vid);
 
-	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
+		video_flush_dcache(priv, 0, priv->fb_size);
 	}
-#elif defined(CONFIG_VIDEO_SANDBOX_SDL)
+
+#ifdef CONFIG_VIDEO_SANDBOX_SDL
 	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
@@ -437,6 +488,10 @@ int video_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
+	/* The copy is made by video_sync() */
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		return 0;
+
 	if (priv->copy_fb) {
 		long offset, size;
 
@@ -488,6 +543,7 @@ int video_sync_copy_all(struct udevice *dev)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
+	video_damage(dev, 0, 0, priv->xsize, priv->ysize);
 	video_sync_copy(dev, priv->fb, priv->fb + priv->fb_size);
 
 	return 0;
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copying, filling and pixel-format conversion within the frame buffer
+ *
+ * These are used for the splash screen, expo images and console scrolling.
+ * They handle one row of pixels at a time, with the choice of pixel format
+ * made once for the row and the inner loops working a machine word at a time
+ * where they can.
+ */
+
+#include <string.h>
+#include <video.h>
+#include <asm/unaligned.h>
+#include <linux/kernel.h>
+
+#ifdef __HAVE_ARCH_MEMMOVE
+#define HAVE_ARCH_MEMMOVE	true
+#else
+#define HAVE_ARCH_MEMMOVE	false
+#endif
+
+void video_fill_pixels(void *dst, enum video_log2_bpp bpix, u32 colour,
+		       int count)
+{
+	ulong pattern, *wp;
+	int pbytes;
+	u8 *p = dst;
+
+	switch (bpix) {
+	case VIDEO_BPP8:
+		if (CONFIG_IS_ENABLED(VIDEO_BPP8))
+			memset(dst, colour, count);
+		return;
+	case VIDEO_BPP16:
+		if (!CONFIG_IS_ENABLED(VIDEO_BPP16))
+			return;
+		colour &= 0xffff;
+		pattern = colour * (~0UL / 0xffff);
+		for (; count && !IS_ALIGNED((ulong)p, sizeof(ulong)); count--) {
+			*(u16 *)p = colour;
+			p += 2;
+		}
+		break;
+	case VIDEO_BPP32:
+		if (!CONFIG_IS_ENABLED(VIDEO_BPP32))
+			return;
+		pattern = colour * (~0UL / 0xffffffff);
+		for (; count && !IS_ALIGNED((ulong)p, sizeof(ulong)); count--) {
+			*(u32 *)p = colour;
+			p += 4;
+		}
+		break;
+	default:
+		return;
+	}
+
+	/* The pattern holds a whole number of pixels, so store words */
+	pbytes = VNBYTES(bpix);
+	wp = (ulong *)p;
+	for (; count * pbytes >= 4 * sizeof(ulong);
+	     count -= 4 * sizeof(ulong) / pbytes) {
+		wp[0] = pattern;
+		wp[1] = pattern;
+		wp[2] = pattern;
+		wp[3] = pattern;
+		wp += 4;
+	}
+	for (; count * pbytes >= sizeof(ulong); count -= sizeof(ulong) / pbytes)
+		*wp++ = pattern;
+	p = (u8 *)wp;
+
+	for (; count; count--) {
+		if (pbytes == 2)
+			*(u16 *)p = colour;
+		else
+			*(u32 *)p = colour;
+		p += pbytes;
+	}
+}
+
+void video_move_pixels(void *dst, const void *src, size_t size)
+{
+	const u8 *s = src + size;
+	u8 *d = dst + size;
+
+	/*
+	 * memmove() uses memcpy() when copying forwards, which is normally
+	 * well optimised, but falls back to a byte loop when copying
+	 * backwards, as the 180-degree rotated console does when scrolling
+	 */
+	if (HAVE_ARCH_MEMMOVE || dst <= src || src + size <= dst) {
+		memmove(dst, src, size);
+		return;
+	}
+
+	if (IS_ALIGNED((ulong)d ^ (ulong)s, sizeof(ulong))) {
+		const ulong *ws;
+		ulong *wd;
+
+		for (; size && !IS_ALIGNED((ulong)d, sizeof(ulong)); size--)
+			*--d = *--s;
+		ws = (const ulong *)s;
+		wd = (ulong *)d;
+		for (; size >= 4 * sizeof(ulong); size -= 4 * sizeof(ulong)) {
+			ws -= 4;
+			wd -= 4;
+			wd[3] = ws[3];
+			wd[2] = ws[2];
+			wd[1] = ws[1];
+			wd[0] = ws[0];
+		}
+		for (; size >= sizeof(ulong); size -= sizeof(ulong))
+			*--wd = *--ws;
+		s = (const u8 *)ws;
+		d = (u8 *)wd;
+	}
+	while (size--)
+		*--d = *--s;
+}
+
+void video_conv_lut8(void *dst, enum video_log2_bpp bpix, const u8 *src,
+		     const u32 *lut, int count)
+{
+	switch (bpix) {
+	case VIDEO_BPP8:
+		if (CONFIG_IS_ENABLED(VIDEO_BPP8))
+			memcpy(dst, src, count);
+		break;
+	case VIDEO_BPP16:
+		if (CONFIG_IS_ENABLED(VIDEO_BPP16)) {
+			u16 *d = dst;
+
+			for (; count >= 4; count -= 4, src += 4, d += 4) {
+				d[0] = lut[src[0]];
+				d[1] = lut[src[1]];
+				d[2] = lut[src[2]];
+				d[3] = lut[src[3]];
+			}
+			while (count--)
+				*d++ = lut[*src++];
+		}
+		break;
+	case VIDEO_BPP32:
+		if (CONFIG_IS_ENABLED(VIDEO_BPP32)) {
+			u32 *d = dst;
+
+			for (; count >= 4; count -= 4, src += 4, d += 4) {
+				d[0] = lut[src[0]];
+				d[1] = lut[src[1]];
+				d[2] = lut[src[2]];
+				d[3] = lut[src[3]];
+			}
+			while (count--)
+				*d++ = lut[*src++];
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void video_conv_bgr24(void *dst, enum video_log2_bpp bpix,
+		      enum video_format format, const u8 *src, int count)
+{
+	if (bpix == VIDEO_BPP16 && CONFIG_IS_ENABLED(VIDEO_BPP16)) {
+		u16 *d = dst;
+
+		/* 16bit 565RGB format */
+		for (; count; count--, src += 3)
+			*d++ = (src[2] >> 3) << 11 | (src[1] >> 2) << 5 |
+				src[0] >> 3;
+	} else if (bpix == VIDEO_BPP32 && CONFIG_IS_ENABLED(VIDEO_BPP32)) {
+		u32 *d = dst;
+
+		if (format == VIDEO_X2R10G10B10) {
+			for (; count; count--, src += 3)
+				*d++ = src[0] << 2 | src[1] << 12 |
+					src[2] << 22;
+		} else if (format == VIDEO_RGBA8888) {
+			for (; count; count--, src += 3)
+				*d++ = src[2] | src[1] << 8 | src[0] << 16 |
+					0xffU << 24;
+		} else {
+			/* Three words of input make four pixels */
+			for (; count >= 4; count -= 4, src += 12, d += 4) {
+				u32 w0 = get_unaligned_le32(src);
+				u32 w1 = get_unaligned_le32(src + 4);
+				u32 w2 = get_unaligned_le32(src + 8);
+
+				d[0] = w0 & 0xffffff;
+				d[1] = w0 >> 24 | (w1 & 0xffff) << 8;
+				d[2] = w1 >> 16 | (w2 & 0xff) << 16;
+				d[3] = w2 >> 8;
+			}
+			for (; count; count--, src += 3)
+				*d++ = src[0] | src[1] << 8 | src[2] << 16;
+		}
+	}
+}
+
+void video_conv_bgra32(void *dst, enum video_log2_bpp bpix,
+		       enum video_format format, const u8 *src, int count)
+{
+	u32 *d = dst;
+
+	if (bpix != VIDEO_BPP32 || !CONFIG_IS_ENABLED(VIDEO_BPP32))
+		return;
+
+	if (format == VIDEO_X2R10G10B10) {
+		for (; count; count--, src += 4)
+			*d++ = src[0] << 2 | src[1] << 12 | src[2] << 22 |
+				(u32)(src[3] >> 6) << 30;
+	} else if (format == VIDEO_RGBA8888) {
+		for (; count; count--, src += 4)
+			*d++ = src[2] | src[1] << 8 | src[0] << 16 |
+				0xffU << 24;
+	} else {
+		memcpy(dst, src, count * 4);
+	}
+}
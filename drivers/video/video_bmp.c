@@ -55,161 +55,100 @@ static u32 get_bmp_col_rgba8888(struct bmp_color_table_entry *cte)
 }
 
 /**
- * write_pix8() - Write a pixel from a BMP image into the framebuffer
+ * get_bmp_col() - Convert a colour-table entry into a frame-buffer pixel value
  *
- * This handles frame buffers with 8, 16, 24 or 32 bits per pixel
- *
- * @fb: Place in frame buffer to update
- * @bpix: Frame buffer bits-per-pixel, which controls how many bytes are written
- * @palette: BMP palette table
- * @bmap: Pointer to BMP bitmap position to write. This contains a single byte
- *	which is either written directly (bpix == 8) or used to look up the
- *	palette to get a colour to write
+ * @bpix: Frame buffer bits per pixel
+ * @eformat: Frame buffer pixel format
+ * @cte: Colour-table entry to convert
+ * Return: value to write to the frame buffer for this palette entry
  */
-static void write_pix8(u8 *fb, uint bpix, enum video_format eformat,
-		       struct bmp_color_table_entry *palette, u8 *bmap)
+static u32 get_bmp_col(enum video_log2_bpp bpix, enum video_format eformat,
+		       struct bmp_color_table_entry *cte)
 {
-	if (bpix == 8) {
-		*fb++ = *bmap;
-	} else if (bpix == 16) {
-		*(u16 *)fb = get_bmp_col_16bpp(palette[*bmap]);
-	} else {
-		/* Only support big endian */
-		struct bmp_color_table_entry *cte = &palette[*bmap];
-
-		if (bpix == 24) {
-			*fb++ = cte->red;
-			*fb++ = cte->green;
-			*fb++ = cte->blue;
-		} else if (eformat == VIDEO_X2R10G10B10) {
-			*(u32 *)fb = get_bmp_col_x2r10g10b10(cte);
-		} else if (eformat == VIDEO_RGBA8888) {
-			*(u32 *)fb = get_bmp_col_rgba8888(cte);
-		} else {
-			*fb++ = cte->blue;
-			*fb++ = cte->green;
-			*fb++ = cte->red;
-			*fb++ = 0;
-		}
-	}
-}
-
-static void draw_unencoded_bitmap(u8 **fbp, uint bpix,
-				  enum video_format eformat, uchar *bmap,
-				  struct bmp_color_table_entry *palette,
-				  int cnt)
-{
-	u8 *fb = *fbp;
-
-	while (cnt > 0) {
-		write_pix8(fb, bpix, eformat, palette, bmap++);
-		fb += bpix / 8;
-		cnt--;
-	}
-	*fbp = fb;
-}
-
-static void draw_encoded_bitmap(u8 **fbp, uint bpix, enum video_format eformat,
-				struct bmp_color_table_entry *palette, u8 *bmap,
-				int cnt)
-{
-	u8 *fb = *fbp;
-
-	while (cnt > 0) {
-		write_pix8(fb, bpix, eformat, palette, bmap);
-		fb += bpix / 8;
-		cnt--;
-	}
-	*fbp = fb;
+	if (bpix == VIDEO_BPP16)
+		return get_bmp_col_16bpp(*cte);
+	if (eformat == VIDEO_X2R10G10B10)
+		return get_bmp_col_x2r10g10b10(cte);
+	if (eformat == VIDEO_RGBA8888)
+		return get_bmp_col_rgba8888(cte);
+
+	return cte->blue | cte->green << 8 | cte->red << 16;
 }
 
+/**
+ * video_display_rle8_bitmap() - Decode an RLE8 bitmap into the frame buffer
+ *
+ * Runs are written straight to the frame buffer in its own format, using
+ * @lut to convert the colour indices
+ *
+ * @dev: Video device
+ * @bmp: BMP image
+ * @lut: Frame-buffer pixel value for each colour index
+ * @x_off: X position of the image on the display
+ * @y_off: Y position of the image on the display
+ * @width: Number of image columns to draw
+ * @height: Number of image rows to draw
+ */
 static void video_display_rle8_bitmap(struct udevice *dev,
-				      struct bmp_image *bmp, uint bpix,
-				      struct bmp_color_table_entry *palette,
-				      uchar *fb, int x_off, int y_off,
-				      ulong width, ulong height)
+				      struct bmp_image *bmp, const u32 *lut,
+				      int x_off, int y_off, ulong width,
+				      ulong height)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
-	uchar *bmap;
+	uint bytes_per_pixel = VNBYTES(priv->bpix);
+	uchar *bmap, *fb;
 	ulong cnt, runlen;
 	int x, y;
-	int decode = 1;
-	uint bytes_per_pixel = bpix / 8;
-	enum video_format eformat = priv->format;
 
 	debug("%s\n", __func__);
 	bmap = (uchar *)bmp + get_unaligned_le32(&bmp->header.data_offset);
 
+	/* The bottom row comes first */
 	x = 0;
 	y = height - 1;
 
-	while (decode) {
-		if (bmap[0] == BMP_RLE8_ESCAPE) {
-			switch (bmap[1]) {
-			case BMP_RLE8_EOL:
-				/* end of line */
-				bmap += 2;
-				x = 0;
-				y--;
-				fb -= width * bytes_per_pixel +
-					priv->line_length;
-				break;
-			case BMP_RLE8_EOBMP:
-				/* end of bitmap */
-				decode = 0;
-				break;
-			case BMP_RLE8_DELTA:
-				/* delta run */
-				x += bmap[2];
-				y -= bmap[3];
-				fb = (uchar *)(priv->fb +
-					(y + y_off - 1) * priv->line_length +
-					(x + x_off) * bytes_per_pixel);
-				bmap += 4;
-				break;
-			default:
-				/* unencoded run */
-				runlen = bmap[1];
-				bmap += 2;
-				if (y < height) {
-					if (x < width) {
-						if (x + runlen > width)
-							cnt = width - x;
-						else
-							cnt = runlen;
-						draw_unencoded_bitmap(
-							&fb, bpix, eformat,
-							bmap, palette, cnt);
-					}
-					x += runlen;
-				}
-				bmap += runlen;
-				if (runlen & 1)
-					bmap++;
-			}
-		} else {
+	while (1) {
+		runlen = bmap[0];
+		fb = priv->fb + (y_off + y) * priv->line_length +
+			(x_off + x) * bytes_per_pixel;
+		if (runlen) {
 			/* encoded run */
-			if (y < height) {
-				runlen = bmap[0];
-				if (x < width) {
-					/* aggregate the same code */
-					while (bmap[0] == 0xff &&
-					       bmap[2] != BMP_RLE8_ESCAPE &&
-					       bmap[1] == bmap[3]) {
-						runlen += bmap[2];
-						bmap += 2;
-					}
-					if (x + runlen > width)
-						cnt = width - x;
-					else
-						cnt = runlen;
-					draw_encoded_bitmap(&fb, bpix, eformat,
-							    palette, &bmap[1],
-							    cnt);
-				}
-				x += runlen;
+			if (y >= 0 && x < width) {
+				cnt = min(runlen, width - x);
+				video_fill_pixels(fb, priv->bpix, lut[bmap[1]],
+						  cnt);
 			}
+			x += runlen;
+			bmap += 2;
+			continue;
+		}
+
+		switch (bmap[1]) {
+		case BMP_RLE8_EOL:
+			/* end of line */
 			bmap += 2;
+			x = 0;
+			y--;
+			break;
+		case BMP_RLE8_EOBMP:
+			/* end of bitmap */
+			return;
+		case BMP_RLE8_DELTA:
+			/* delta run */
+			x += bmap[2];
+			y -= bmap[3];
+			bmap += 4;
+			break;
+		default:
+			/* unencoded run */
+			runlen = bmap[1];
+			bmap += 2;
+			if (y >= 0 && x < width) {
+				cnt = min(runlen, width - x);
+				video_conv_lut8(fb, priv->bpix, bmap, lut, cnt);
+			}
+			x += runlen;
+			bmap += ALIGN(runlen, 2);
 		}
 	}
 }
@@ -257,14 +196,14 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 		      bool align)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
-	int i, j;
+	int i;
 	uchar *start, *fb;
 	struct bmp_image *bmp = map_sysmem(bmp_image, 0);
 	uchar *bmap;
-	ushort padded_width;
-	unsigned long width, height, byte_width;
+	unsigned long width, height, stride;
 	unsigned long pwidth = priv->xsize;
-	unsigned colours, bpix, bmp_bpix;
+	unsigned colours, used, bpix, bmp_bpix;
+	u32 lut[256];
 	enum video_format eformat;
 	struct bmp_color_table_entry *palette;
 	int hdr_size;
@@ -312,7 +251,8 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	debug("Display-bmp: %d x %d  with %d colours, display %d\n",
 	      (int)width, (int)height, (int)colours, 1 << bpix);
 
-	padded_width = (width & 0x3 ? (width & ~0x3) + 4 : width);
+	/* Rows are padded to a multiple of four bytes */
+	stride = ALIGN(width * max(bmp_bpix, 8U) / 8, 4);
 
 	if (align) {
 		video_splash_align_axis(&x, priv->xsize, width);
@@ -334,125 +274,68 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	switch (bmp_bpix) {
 	case 1:
 	case 8:
+		/* Convert the palette once rather than for every pixel */
+		used = get_unaligned_le32(&bmp->header.colors_used);
+		if (!used || used > colours)
+			used = colours;
+		for (i = 0; i < ARRAY_SIZE(lut); i++) {
+			if (bpix == 8)
+				lut[i] = i;
+			else if (i < used)
+				lut[i] = get_bmp_col(priv->bpix, eformat,
+						     &palette[i]);
+			else
+				lut[i] = 0;
+		}
+
 		if (CONFIG_IS_ENABLED(VIDEO_BMP_RLE8)) {
 			u32 compression = get_unaligned_le32(
 				&bmp->header.compression);
 			debug("compressed %d %d\n", compression, BMP_BI_RLE8);
 			if (compression == BMP_BI_RLE8) {
-				video_display_rle8_bitmap(dev, bmp, bpix, palette, fb,
-							  x, y, width, height);
+				video_display_rle8_bitmap(dev, bmp, lut, x, y,
+							  width, height);
 				break;
 			}
 		}
 
 		/* Not compressed */
-		byte_width = width * (bpix / 8);
-		if (!byte_width)
-			byte_width = width;
-
 		for (i = 0; i < height; ++i) {
 			schedule();
-			for (j = 0; j < width; j++) {
-				write_pix8(fb, bpix, eformat, palette, bmap);
-				bmap++;
-				fb += bpix / 8;
-			}
-			bmap += (padded_width - width);
-			fb -= byte_width + priv->line_length;
+			video_conv_lut8(fb, priv->bpix, bmap, lut, width);
+			bmap += stride;
+			fb -= priv->line_length;
 		}
 		break;
 	case 16:
 		if (CONFIG_IS_ENABLED(BMP_16BPP)) {
 			for (i = 0; i < height; ++i) {
 				schedule();
-				for (j = 0; j < width; j++) {
-					*fb++ = *bmap++;
-					*fb++ = *bmap++;
-				}
-				bmap += (padded_width - width);
-				fb -= width * 2 + priv->line_length;
+				memcpy(fb, bmap, width * 2);
+				bmap += stride;
+				fb -= priv->line_length;
 			}
 		}
 		break;
 	case 24:
 		if (CONFIG_IS_ENABLED(BMP_24BPP)) {
 			for (i = 0; i < height; ++i) {
-				for (j = 0; j < width; j++) {
-					if (bpix == 16) {
-						/* 16bit 565RGB format */
-						*(u16 *)fb = ((bmap[2] >> 3)
-							<< 11) |
-							((bmap[1] >> 2) << 5) |
-							(bmap[0] >> 3);
-						bmap += 3;
-						fb += 2;
-					} else if (eformat == VIDEO_X2R10G10B10) {
-						u32 pix;
-
-						pix = *bmap++ << 2U;
-						pix |= *bmap++ << 12U;
-						pix |= *bmap++ << 22U;
-						*fb++ = pix & 0xff;
-						*fb++ = (pix >> 8) & 0xff;
-						*fb++ = (pix >> 16) & 0xff;
-						*fb++ = pix >> 24;
-					} else if (eformat == VIDEO_RGBA8888) {
-						u32 pix;
-
-						pix = *bmap++ << 8U; /* blue */
-						pix |= *bmap++ << 16U; /* green */
-						pix |= *bmap++ << 24U; /* red */
-
-						*fb++ = (pix >> 24) & 0xff;
-						*fb++ = (pix >> 16) & 0xff;
-						*fb++ = (pix >> 8) & 0xff;
-						*fb++ = 0xff;
-					} else {
-						*fb++ = *bmap++;
-						*fb++ = *bmap++;
-						*fb++ = *bmap++;
-						*fb++ = 0;
-					}
-				}
-				fb -= priv->line_length + width * (bpix / 8);
-				bmap += (padded_width - width);
+				schedule();
+				video_conv_bgr24(fb, priv->bpix, eformat, bmap,
+						 width);
+				bmap += stride;
+				fb -= priv->line_length;
 			}
 		}
 		break;
 	case 32:
 		if (CONFIG_IS_ENABLED(BMP_32BPP)) {
 			for (i = 0; i < height; ++i) {
-				for (j = 0; j < width; j++) {
-					if (eformat == VIDEO_X2R10G10B10) {
-						u32 pix;
-
-						pix = *bmap++ << 2U;
-						pix |= *bmap++ << 12U;
-						pix |= *bmap++ << 22U;
-						pix |= (*bmap++ >> 6) << 30U;
-						*fb++ = pix & 0xff;
-						*fb++ = (pix >> 8) & 0xff;
-						*fb++ = (pix >> 16) & 0xff;
-						*fb++ = pix >> 24;
-					} else if (eformat == VIDEO_RGBA8888) {
-						u32 pix;
-
-						pix = *bmap++ << 8U; /* blue */
-						pix |= *bmap++ << 16U; /* green */
-						pix |= *bmap++ << 24U; /* red */
-						bmap++;
-						*fb++ = (pix >> 24) & 0xff;
-						*fb++ = (pix >> 16) & 0xff;
-						*fb++ = (pix >> 8) & 0xff;
-						*fb++ = 0xff; /* opacity */
-					} else {
-						*fb++ = *bmap++;
-						*fb++ = *bmap++;
-						*fb++ = *bmap++;
-						*fb++ = *bmap++;
-					}
-				}
-				fb -= priv->line_length + width * (bpix / 8);
+				schedule();
+				video_conv_bgra32(fb, priv->bpix, eformat, bmap,
+						  width);
+				bmap += stride;
+				fb -= priv->line_length;
 			}
 		}
 		break;
@@ -462,6 +345,7 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 
 	/* Find the position of the top left of the image in the framebuffer */
 	fb = (uchar *)(priv->fb + y * priv->line_length + x * bpix / 8);
+	video_damage(dev, x, y, width, height);
 	ret = video_sync_copy(dev, start, fb);
 	if (ret)
 		return log_ret(ret);
@@ -83,44 +83,66 @@ static int clear_callback(struct env_entry *entry)
 }
 
 /*
- * Call for each element in the list that associates variables to callbacks
+ * Assign the callback named "priv" to a variable
  */
-static int set_callback(const char *name, const char *value, void *priv)
+static int set_callback_entry(struct env_entry *ep, void *priv)
 {
-	struct env_entry e, *ep;
+	const char *value = priv;
 	struct env_clbk_tbl *clbkp;
 
-	e.key	= name;
-	e.data	= NULL;
-	e.callback = NULL;
-	hsearch_r(e, ENV_FIND, &ep, &env_htab, 0);
-
-	/* does the env variable actually exist? */
-	if (ep != NULL) {
-		/* the assocaition delares no callback, so remove the pointer */
-		if (value == NULL || strlen(value) == 0)
-			ep->callback = NULL;
-		else {
-			/* assign the requested callback */
-			clbkp = find_env_callback(value);
-			if (clbkp != NULL)
-				ep->callback = clbkp->callback;
-		}
+	/* the assocaition delares no callback, so remove the pointer */
+	if (value == NULL || strlen(value) == 0) {
+		ep->callback = NULL;
+	} else {
+		/* assign the requested callback */
+		clbkp = find_env_callback(value);
+		ep->callback = clbkp ? clbkp->callback : NULL;
 	}
 
 	return 0;
 }
 
-static int on_callbacks(const char *name, const char *value, enum env_op op,
-	int flags)
+/*
+ * Call for each element in the list that associates variables to callbacks
+ */
+static int set_callback(const char *name, const char *value, void *priv)
+{
+	/* only existing env variables are updated */
+	hwalk_key_r(priv, name, set_callback_entry, (void *)value);
+
+	return 0;
+}
+
+/*
+ * Set the callbacks of all variables according to the static list and the
+ * given ".callbacks" list
+ */
+static void setup_callbacks(struct hsearch_data *htab, const char *list)
 {
 	/* remove all callbacks */
-	hwalk_r(&env_htab, clear_callback);
+	hwalk_r(htab, clear_callback);
 
 	/* configure any static callback bindings */
-	env_attr_walk(ENV_CALLBACK_LIST_STATIC, set_callback, NULL);
+	env_attr_walk(ENV_CALLBACK_LIST_STATIC, set_callback, htab);
 	/* configure any dynamic callback bindings */
-	env_attr_walk(value, set_callback, NULL);
+	env_attr_walk(list, set_callback, htab);
+}
+
+void env_callback_init_all(struct hsearch_data *htab)
+{
+	struct env_entry e, *ep;
+
+	e.key = ENV_CALLBACK_VAR;
+	e.data = NULL;
+	hsearch_r(e, ENV_FIND, &ep, htab, 0);
+
+	setup_callbacks(htab, ep ? ep->data : NULL);
+}
+
+static int on_callbacks(const char *name, const char *value, enum env_op op,
+	int flags)
+{
+	setup_callbacks(&env_htab, value);
 
 	return 0;
 }
@@ -383,13 +383,16 @@ void env_set_default(const char *s, int flags)
 	}
 
 	flags |= H_DEFAULT;
+	bootstage_start(BOOTSTAGE_ID_ACCUM_ENV_IMPORT, "env_import");
 	if (himport_r(&env_htab, default_environment,
 			sizeof(default_environment), '\0', flags, 0,
 			0, NULL) == 0) {
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_ENV_IMPORT);
 		pr_err("## Error: Environment import failed: errno = %d\n",
 		       errno);
 		return;
 	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_ENV_IMPORT);
 
 	gd->flags |= GD_FLG_ENV_READY;
 	gd->flags |= GD_FLG_ENV_DEFAULT;
@@ -416,6 +419,7 @@ int env_set_default_vars(int nvars, char * const vars[], int flags)
 int env_import(const char *buf, int check, int flags)
 {
 	env_t *ep = (env_t *)buf;
+	int ret;
 
 	if (check) {
 		uint32_t crc;
@@ -428,8 +432,11 @@ int env_import(const char *buf, int check, int flags)
 		}
 	}
 
-	if (himport_r(&env_htab, (char *)ep->data, ENV_SIZE, '\0', flags, 0,
-			0, NULL)) {
+	bootstage_start(BOOTSTAGE_ID_ACCUM_ENV_IMPORT, "env_import");
+	ret = himport_r(&env_htab, (char *)ep->data, ENV_SIZE, '\0', flags, 0,
+			0, NULL);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_ENV_IMPORT);
+	if (ret) {
 		gd->flags |= GD_FLG_ENV_READY;
 		return 0;
 	}
@@ -527,7 +534,9 @@ int env_export(env_t *env_out)
 	ssize_t	len;
 
 	res = (char *)env_out->data;
+	bootstage_start(BOOTSTAGE_ID_ACCUM_ENV_EXPORT, "env_export");
 	len = hexport_r(&env_htab, '\0', 0, &res, ENV_SIZE, 0, NULL);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_ENV_EXPORT);
 	if (len < 0) {
 		pr_err("Cannot export environment: errno = %d\n", errno);
 		return 1;
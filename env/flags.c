@@ -475,40 +475,66 @@ static int clear_flags(struct env_entry *entry)
 	return 0;
 }
 
+/*
+ * Assign the flags given as "priv" to a variable
+ */
+static int set_flags_entry(struct env_entry *ep, void *priv)
+{
+	const char *value = priv;
+
+	/* the flag list is empty, so clear the flags */
+	if (value == NULL || strlen(value) == 0)
+		ep->flags = 0;
+	else
+		/* assign the requested flags */
+		ep->flags = env_parse_flags_to_bin(value);
+
+	return 0;
+}
+
 /*
  * Call for each element in the list that defines flags for a variable
  */
 static int set_flags(const char *name, const char *value, void *priv)
 {
-	struct env_entry e, *ep;
-
-	e.key	= name;
-	e.data	= NULL;
-	hsearch_r(e, ENV_FIND, &ep, &env_htab, 0);
-
-	/* does the env variable actually exist? */
-	if (ep != NULL) {
-		/* the flag list is empty, so clear the flags */
-		if (value == NULL || strlen(value) == 0)
-			ep->flags = 0;
-		else
-			/* assign the requested flags */
-			ep->flags = env_parse_flags_to_bin(value);
-	}
+	/* only existing env variables are updated */
+	hwalk_key_r(priv, name, set_flags_entry, (void *)value);
 
 	return 0;
 }
 
-static int on_flags(const char *name, const char *value, enum env_op op,
-	int flags)
+/*
+ * Set the flags of all variables according to the static list and the given
+ * ".flags" list
+ */
+static void setup_flags(struct hsearch_data *htab, const char *list)
 {
 	/* remove all flags */
-	hwalk_r(&env_htab, clear_flags);
+	hwalk_r(htab, clear_flags);
 
 	/* configure any static flags */
-	env_attr_walk(ENV_FLAGS_LIST_STATIC, set_flags, NULL);
+	env_attr_walk(ENV_FLAGS_LIST_STATIC, set_flags, htab);
 	/* configure any dynamic flags */
-	env_attr_walk(value, set_flags, NULL);
+	env_attr_walk(list, set_flags, htab);
+}
+
+void env_flags_init_all(struct hsearch_data *htab)
+{
+	struct env_entry e, *ep = NULL;
+
+	if (!IS_ENABLED(CONFIG_ENV_WRITEABLE_LIST)) {
+		e.key = ENV_FLAGS_VAR;
+		e.data = NULL;
+		hsearch_r(e, ENV_FIND, &ep, htab, 0);
+	}
+
+	setup_flags(htab, ep ? ep->data : NULL);
+}
+
+static int on_flags(const char *name, const char *value, enum env_op op,
+	int flags)
+{
+	setup_flags(&env_htab, value);
 
 	return 0;
 }
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Journal of environment changes
+ *
+ * A journal area follows each stored copy of the environment. Instead of
+ * rewriting the whole copy, saveenv appends one record holding the variables
+ * which changed since the last save, in the same "name=value" format as the
+ * environment itself, with "name=" for a deleted variable. Only when the
+ * journal is full is the environment written out in full and the journal
+ * cleared.
+ *
+ * Each record is covered by a CRC32 which is seeded with the CRC of the record
+ * before it, or of the environment copy for the first record, so records left
+ * over from an older copy, or torn by a power failure, are not replayed.
+ */
+
+#include <env.h>
+#include <env_internal.h>
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <search.h>
+#include <asm/cache.h>
+#include <linux/kernel.h>
+#include <u-boot/crc.h>
+
+/**
+ * struct env_journal_rec - Header of a journal record
+ *
+ * @crc: CRC32 of @len and the data, seeded with the CRC of the previous record
+ * @len: Number of bytes of data following the header
+ */
+struct env_journal_rec {
+	__le32 crc;
+	__le32 len;
+};
+
+enum {
+	JOURNAL_SIZE	= IF_ENABLED_INT(CONFIG_ENV_JOURNAL,
+					 CONFIG_ENV_JOURNAL_SIZE),
+	REC_ALIGN	= 4,
+};
+
+static u32 env_journal_crc(u32 crc, const struct env_journal_rec *rec)
+{
+	return crc32(crc, (const u8 *)&rec->len,
+		     sizeof(rec->len) + le32_to_cpu(rec->len));
+}
+
+int env_journal_setup(struct env_journal *jnl)
+{
+	if (!jnl->buf) {
+		jnl->buf = memalign(ARCH_DMA_MINALIGN, JOURNAL_SIZE);
+		jnl->shadow = malloc(ENV_SIZE);
+		jnl->data = malloc(ENV_SIZE);
+		if (!jnl->buf || !jnl->shadow || !jnl->data) {
+			free(jnl->buf);
+			free(jnl->shadow);
+			free(jnl->data);
+			jnl->buf = NULL;
+			return log_msg_ret("jnl", -ENOMEM);
+		}
+	}
+
+	return 0;
+}
+
+void env_journal_reset(struct env_journal *jnl, const env_t *ep)
+{
+	jnl->valid = false;
+	if (!ep || env_journal_setup(jnl))
+		return;
+
+	memset(jnl->buf, jnl->blank, JOURNAL_SIZE);
+	memcpy(jnl->shadow, ep->data, ENV_SIZE);
+	jnl->pos = 0;
+	jnl->len = 0;
+	jnl->crc = ep->crc;
+	jnl->valid = true;
+}
+
+int env_journal_replay(struct env_journal *jnl, const env_t *ep)
+{
+	const struct env_journal_rec *rec;
+	u32 crc = ep->crc;
+	int count = 0;
+	uint pos = 0;
+
+	while (pos + sizeof(*rec) <= JOURNAL_SIZE) {
+		uint len;
+
+		rec = (void *)jnl->buf + pos;
+		len = le32_to_cpu(rec->len);
+		if (len > JOURNAL_SIZE - pos - sizeof(*rec) ||
+		    env_journal_crc(crc, rec) != le32_to_cpu(rec->crc))
+			break;
+		if (!himport_r(&env_htab, (char *)(rec + 1), len, '\0',
+			       H_NOCLEAR | H_EXTERNAL | H_FORCE, 0, 0, NULL))
+			log_warning("Cannot import journal record %d: errno = %d\n",
+				    count, errno);
+		crc = le32_to_cpu(rec->crc);
+		pos += ALIGN(sizeof(*rec) + len, REC_ALIGN);
+		count++;
+	}
+	log_debug("Replayed %d journal records, %u bytes\n", count, pos);
+
+	jnl->pos = pos;
+	jnl->len = 0;
+	jnl->crc = crc;
+	jnl->valid = false;
+	if (!CONFIG_IS_ENABLED(SAVEENV))
+		return 0;
+
+	/*
+	 * Flash cannot be written twice, so if something other than erased
+	 * space follows the last record, the next save has to compact. Other
+	 * media are simply written over.
+	 */
+	if (pos + sizeof(*rec) <= JOURNAL_SIZE) {
+		if (jnl->blank) {
+			rec = (void *)jnl->buf + pos;
+			if (rec->crc != ~0U || rec->len != ~0U)
+				jnl->pos = JOURNAL_SIZE;
+		} else {
+			memset(jnl->buf + pos, jnl->blank, JOURNAL_SIZE - pos);
+		}
+	}
+
+	/* This is what storage now holds */
+	if (hexport_r(&env_htab, '\0', 0, &jnl->shadow, ENV_SIZE, 0, NULL) < 0)
+		return log_msg_ret("exp", -EIO);
+	jnl->valid = true;
+
+	return 0;
+}
+
+/**
+ * env_journal_cmp() - Compare the names of two "name=value" entries
+ *
+ * Entries are exported in strcmp() order of their names, which this matches.
+ *
+ * @a: First entry
+ * @b: Second entry
+ * Return: <0, 0 or >0 as strcmp() does for the names
+ */
+static int env_journal_cmp(const char *a, const char *b)
+{
+	while (*a == *b && *a != '=') {
+		a++;
+		b++;
+	}
+
+	return (*a == '=' ? 0 : (u8)*a) - (*b == '=' ? 0 : (u8)*b);
+}
+
+int env_journal_prepare(struct env_journal *jnl)
+{
+	struct env_journal_rec *rec;
+	const char *old, *new;
+	char *out, *end;
+
+	jnl->len = 0;
+	if (!jnl->valid)
+		return -ENOSPC;
+	if (hexport_r(&env_htab, '\0', 0, &jnl->data, ENV_SIZE, 0, NULL) < 0)
+		return log_msg_ret("exp", -EIO);
+
+	rec = (void *)jnl->buf + jnl->pos;
+	out = (char *)(rec + 1);
+	end = (char *)jnl->buf + JOURNAL_SIZE;
+	if (out > end)
+		return -ENOSPC;
+
+	/* Both lists are sorted by name, so walk them side by side */
+	old = jnl->shadow;
+	new = jnl->data;
+	while (*old || *new) {
+		const char *next = NULL;
+		size_t len;
+		int cmp;
+
+		if (!*old)
+			cmp = 1;
+		else if (!*new)
+			cmp = -1;
+		else
+			cmp = env_journal_cmp(old, new);
+
+		if (cmp < 0) {
+			/* Deleted: record "name=" */
+			len = strchr(old, '=') + 1 - old;
+			if (len + 1 > end - out)
+				return -ENOSPC;
+			memcpy(out, old, len);
+			out[len] = '\0';
+			out += len + 1;
+		} else if (cmp > 0 || strcmp(old, new)) {
+			next = new;
+		}
+		if (next) {
+			len = strlen(next) + 1;
+			if (len > end - out)
+				return -ENOSPC;
+			memcpy(out, next, len);
+			out += len;
+		}
+		if (cmp <= 0)
+			old += strlen(old) + 1;
+		if (cmp >= 0)
+			new += strlen(new) + 1;
+	}
+
+	if (out == (char *)(rec + 1))
+		return 0;
+	rec->len = cpu_to_le32(out - (char *)(rec + 1));
+	jnl->new_crc = env_journal_crc(jnl->crc, rec);
+	rec->crc = cpu_to_le32(jnl->new_crc);
+	jnl->len = ALIGN(out - (char *)rec, REC_ALIGN);
+	if (jnl->pos + jnl->len > JOURNAL_SIZE)
+		return -ENOSPC;
+	memset(out, jnl->blank, (char *)rec + jnl->len - out);
+
+	/* Unless the area was erased, end the journal with an empty header */
+	jnl->end = jnl->pos + jnl->len;
+	if (!jnl->blank && jnl->end + sizeof(*rec) <= JOURNAL_SIZE) {
+		memset(jnl->buf + jnl->end, '\0', sizeof(*rec));
+		jnl->end += sizeof(*rec);
+	}
+
+	return 0;
+}
+
+void env_journal_commit(struct env_journal *jnl)
+{
+	char *shadow = jnl->shadow;
+
+	if (!jnl->len)
+		return;
+	jnl->pos += jnl->len;
+	jnl->len = 0;
+	jnl->crc = jnl->new_crc;
+	jnl->shadow = jnl->data;
+	jnl->data = shadow;
+}
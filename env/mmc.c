@@ -39,8 +39,24 @@
 #endif
 #endif
 
+#define ENV_JOURNAL_SIZE	IF_ENABLED_INT(CONFIG_ENV_JOURNAL, \
+				       CONFIG_ENV_JOURNAL_SIZE)
+
+/* Each copy is followed by its journal, which must not reach the other copy */
+#if defined(CONFIG_ENV_JOURNAL) && defined(CONFIG_ENV_OFFSET_REDUND) && \
+	!defined(CONFIG_ENV_MMC_USE_DT) && \
+	(CONFIG_ENV_OFFSET != CONFIG_ENV_OFFSET_REDUND) && \
+	(CONFIG_ENV_OFFSET < CONFIG_ENV_OFFSET_REDUND + CONFIG_ENV_SIZE + \
+	 CONFIG_ENV_JOURNAL_SIZE) && \
+	(CONFIG_ENV_OFFSET_REDUND < CONFIG_ENV_OFFSET + CONFIG_ENV_SIZE + \
+	 CONFIG_ENV_JOURNAL_SIZE)
+#error "The environment journal overlaps the other copy of the environment"
+#endif
+
 DECLARE_GLOBAL_DATA_PTR;
 
+static struct env_journal env_mmc_journal;
+
 /*
  * In case the environment is redundant, stored in eMMC hardware boot
  * partition and the environment and redundant environment offsets are
@@ -239,6 +255,63 @@ static void fini_mmc_for_env(struct mmc *mmc)
 	mmc_set_env_part_restore(mmc);
 }
 
+/**
+ * env_mmc_journal_addr() - Find the journal following an environment copy
+ *
+ * The journal directly follows the copy. It must not run into the other copy,
+ * past the end of the hardware partition or out of the partition holding the
+ * copy. So there is no room for it if the copy is at the end of a partition.
+ *
+ * @mmc: MMC device holding the environment, with the partition of @copy
+ *	selected
+ * @copy: Environment copy, 1 for the redundant one
+ * @addr: Returns the byte offset of the journal
+ * Return: 0 if OK, -ENOSPC if the journal does not fit, other -ve on error
+ */
+static __maybe_unused int env_mmc_journal_addr(struct mmc *mmc, int copy,
+					       u32 *addr)
+{
+	struct blk_desc *desc = mmc_get_blk_desc(mmc);
+	struct disk_partition info;
+	u64 start, end, pstart, pend;
+	u32 offset, other;
+	int i, ret;
+
+	ret = mmc_get_env_addr(mmc, copy, &offset);
+	if (ret)
+		return ret;
+	start = (u64)offset + CONFIG_ENV_SIZE;
+	end = start + ENV_JOURNAL_SIZE;
+	if (end > mmc->capacity)
+		goto nospace;
+
+	if (IS_ENABLED(CONFIG_SYS_REDUNDAND_ENVIRONMENT) &&
+	    !IS_ENABLED(ENV_MMC_HWPART_REDUND)) {
+		ret = mmc_get_env_addr(mmc, !copy, &other);
+		if (ret)
+			return ret;
+		if (other < end &&
+		    offset < (u64)other + CONFIG_ENV_SIZE + ENV_JOURNAL_SIZE)
+			goto nospace;
+	}
+
+	for (i = 1; !part_get_info(desc, i, &info); i++) {
+		pstart = (u64)info.start * info.blksz;
+		pend = pstart + (u64)info.size * info.blksz;
+		if (offset >= pstart && offset < pend) {
+			if (end > pend)
+				goto nospace;
+		} else if (start < pend && end > pstart) {
+			goto nospace;
+		}
+	}
+	*addr = start;
+
+	return 0;
+nospace:
+	return -ENOSPC;
+}
+
 #if defined(CONFIG_CMD_SAVEENV) && !defined(CONFIG_SPL_BUILD)
 static inline int write_env(struct mmc *mmc, unsigned long size,
 			    unsigned long offset, const void *buffer)
@@ -254,13 +327,61 @@ static inline int write_env(struct mmc *mmc, unsigned long size,
 	return (n == blk_cnt) ? 0 : -1;
 }
 
+/**
+ * env_mmc_journal_save() - Append the changed variables to the journal
+ *
+ * @mmc: MMC device holding the environment
+ * @copy: Environment copy in use, 1 for the redundant one
+ * Return: 0 if OK, -ENOSPC if the environment must be written in full instead,
+ *	other -ve on error
+ */
+static int env_mmc_journal_save(struct mmc *mmc, int copy)
+{
+	struct env_journal *jnl = &env_mmc_journal;
+	uint start;
+	u32 addr;
+	int ret;
+
+	if (IS_ENABLED(ENV_MMC_HWPART_REDUND)) {
+		ret = mmc_set_env_part(mmc, copy + 1);
+		if (ret)
+			return ret;
+	}
+	ret = env_mmc_journal_addr(mmc, copy, &addr);
+	if (ret)
+		return ret;
+
+	ret = env_journal_prepare(jnl);
+	if (ret)
+		return ret;
+	if (!jnl->len) {
+		puts("Environment is unchanged\n");
+		return 0;
+	}
+
+	/* Write whole blocks, keeping the records before this one */
+	start = ALIGN_DOWN(jnl->pos, mmc->write_bl_len);
+	printf("Writing to %sMMC(%d) journal... ", copy ? "redundant " : "",
+	       mmc_get_env_dev());
+	if (write_env(mmc, jnl->end - start, addr + start, jnl->buf + start)) {
+		puts("failed\n");
+		env_journal_reset(jnl, NULL);
+		return -EIO;
+	}
+	env_journal_commit(jnl);
+	puts("done\n");
+
+	return 0;
+}
+
 static int env_mmc_save(void)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(env_t, env_new, 1);
 	int dev = mmc_get_env_dev();
 	struct mmc *mmc = find_mmc_device(dev);
-	u32	offset;
+	u32	offset, addr;
 	int	ret, copy = 0;
+	bool	journal = false;
 	const char *errmsg;
 
 	errmsg = init_mmc_for_env(mmc);
@@ -269,6 +390,12 @@ static int env_mmc_save(void)
 		return 1;
 	}
 
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL)) {
+		ret = env_mmc_journal_save(mmc, gd->env_valid == ENV_REDUND);
+		if (ret != -ENOSPC)
+			goto fini;
+	}
+
 	ret = env_export(env_new);
 	if (ret)
 		goto fini;
@@ -289,7 +416,33 @@ static int env_mmc_save(void)
 		goto fini;
 	}
 
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL)) {
+		/* No older journal may follow the new copy */
+		env_journal_reset(&env_mmc_journal, NULL);
+		ret = env_mmc_journal_addr(mmc, copy, &addr);
+		if (ret == -ENOSPC)
+			printf("No room for the %senvironment journal\n",
+			       copy ? "redundant " : "");
+		else if (ret)
+			goto fini;
+		journal = !ret;
+	}
+
 	printf("Writing to %sMMC(%d)... ", copy ? "redundant " : "", dev);
+	if (journal) {
+		struct env_journal *jnl = &env_mmc_journal;
+
+		ret = env_journal_setup(jnl);
+		if (!ret) {
+			memset(jnl->buf, '\0', mmc->write_bl_len);
+			ret = write_env(mmc, mmc->write_bl_len, addr, jnl->buf);
+		}
+		if (ret) {
+			puts("failed\n");
+			ret = 1;
+			goto fini;
+		}
+	}
 	if (write_env(mmc, CONFIG_ENV_SIZE, offset, (u_char *)env_new)) {
 		puts("failed\n");
 		ret = 1;
@@ -297,9 +450,12 @@ static int env_mmc_save(void)
 	}
 
 	ret = 0;
+	if (journal)
+		env_journal_reset(&env_mmc_journal, env_new);
 
+	/* The journal must go with the copy just written */
 	if (IS_ENABLED(CONFIG_SYS_REDUNDAND_ENVIRONMENT))
-		gd->env_valid = gd->env_valid == ENV_REDUND ? ENV_VALID : ENV_REDUND;
+		gd->env_valid = copy ? ENV_REDUND : ENV_VALID;
 
 fini:
 	fini_mmc_for_env(mmc);
@@ -364,6 +520,9 @@ static int env_mmc_erase(void)
 		ret |= erase_env(mmc, CONFIG_ENV_SIZE, offset);
 	}
 
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL))
+		env_journal_reset(&env_mmc_journal, NULL);
+
 fini:
 	fini_mmc_for_env(mmc);
 	return ret;
@@ -384,6 +543,42 @@ static inline int read_env(struct mmc *mmc, unsigned long size,
 	return (n == blk_cnt) ? 0 : -1;
 }
 
+/**
+ * env_mmc_journal_load() - Apply the journal of the environment copy loaded
+ *
+ * @mmc: MMC device holding the environment
+ * @copy: Environment copy which was imported, 1 for the redundant one
+ * @ep: That environment copy
+ */
+static __maybe_unused void env_mmc_journal_load(struct mmc *mmc, int copy,
+						const env_t *ep)
+{
+	struct env_journal *jnl = &env_mmc_journal;
+	u32 addr;
+	int ret;
+
+	ret = env_journal_setup(jnl);
+	if (!ret && IS_ENABLED(ENV_MMC_HWPART_REDUND))
+		ret = mmc_set_env_part(mmc, copy + 1);
+	if (!ret)
+		ret = env_mmc_journal_addr(mmc, copy, &addr);
+	if (ret == -ENOSPC) {
+		/* Use the copy alone; saveenv will write it in full */
+		printf("No room for the %senvironment journal\n",
+		       copy ? "redundant " : "");
+		env_journal_reset(jnl, NULL);
+		return;
+	}
+	if (!ret)
+		ret = read_env(mmc, ENV_JOURNAL_SIZE, addr, jnl->buf);
+	if (!ret)
+		ret = env_journal_replay(jnl, ep);
+	if (ret) {
+		printf("Cannot read environment journal (err=%d)\n", ret);
+		env_journal_reset(jnl, NULL);
+	}
+}
+
 #if defined(ENV_IS_EMBEDDED)
 static int env_mmc_load(void)
 {
@@ -437,6 +632,12 @@ static int env_mmc_load(void)
 	ret = env_import_redund((char *)tmp_env1, read1_fail, (char *)tmp_env2,
 				read2_fail, H_EXTERNAL);
 	printf("Reading from %sMMC(%d)... ", gd->env_valid == ENV_REDUND ? "redundant " : "", dev);
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL) && !ret) {
+		if (gd->env_valid == ENV_REDUND)
+			env_mmc_journal_load(mmc, 1, tmp_env2);
+		else
+			env_mmc_journal_load(mmc, 0, tmp_env1);
+	}
 
 fini:
 	fini_mmc_for_env(mmc);
@@ -482,6 +683,8 @@ static int env_mmc_load(void)
 	if (!ret) {
 		ep = (env_t *)buf;
 		gd->env_addr = (ulong)&ep->data;
+		if (IS_ENABLED(CONFIG_ENV_JOURNAL))
+			env_mmc_journal_load(mmc, 0, ep);
 	}
 
 fini:
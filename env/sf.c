@@ -37,8 +37,35 @@ static ulong env_new_offset	= CONFIG_ENV_OFFSET_REDUND;
 
 #endif /* CONFIG_ENV_OFFSET_REDUND */
 
+#define ENV_JOURNAL_SIZE	IF_ENABLED_INT(CONFIG_ENV_JOURNAL, \
+				       CONFIG_ENV_JOURNAL_SIZE)
+
+/*
+ * Each copy is followed by its journal, starting at the next sector, which
+ * must not reach the other copy. The sector size may be larger at run time
+ * with CONFIG_ENV_SECT_SIZE_AUTO, which env_sf_journal_offset() checks.
+ */
+#if defined(CONFIG_ENV_JOURNAL)
+#if CONFIG_ENV_JOURNAL_SIZE % CONFIG_ENV_SECT_SIZE
+#error "CONFIG_ENV_JOURNAL_SIZE must be a multiple of CONFIG_ENV_SECT_SIZE"
+#endif
+#define ENV_JOURNAL_SPAN	(DIV_ROUND_UP(CONFIG_ENV_SIZE, \
+				 CONFIG_ENV_SECT_SIZE) * CONFIG_ENV_SECT_SIZE + \
+				 CONFIG_ENV_JOURNAL_SIZE)
+#if defined(CONFIG_ENV_OFFSET_REDUND) && \
+	(CONFIG_ENV_OFFSET < CONFIG_ENV_OFFSET_REDUND + ENV_JOURNAL_SPAN) && \
+	(CONFIG_ENV_OFFSET_REDUND < CONFIG_ENV_OFFSET + ENV_JOURNAL_SPAN)
+#error "The environment journal overlaps the other copy of the environment"
+#endif
+#endif
+
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Erased flash reads as 0xff */
+static struct env_journal env_sf_journal = {
+	.blank	= 0xff,
+};
+
 static int setup_flash_device(struct spi_flash **env_flash)
 {
 #if CONFIG_IS_ENABLED(DM_SPI_FLASH)
@@ -65,6 +92,110 @@ static int setup_flash_device(struct spi_flash **env_flash)
 	return 0;
 }
 
+/**
+ * env_sf_journal_offset() - Find the journal following an environment copy
+ *
+ * The journal starts at the first sector after the copy, using the sector size
+ * of the flash with CONFIG_ENV_SECT_SIZE_AUTO. It must be made of whole
+ * sectors and must not run into the other copy or past the end of the flash.
+ *
+ * @env_flash: SPI flash holding the environment
+ * @offset: Offset of the environment copy
+ * @jnl_offset: Returns the offset of the journal
+ * Return: 0 if OK, -ENOSPC if the journal does not fit
+ */
+static int env_sf_journal_offset(struct spi_flash *env_flash, u32 offset,
+				 u32 *jnl_offset)
+{
+	u32 sect_size = CONFIG_ENV_SECT_SIZE;
+	u64 start, span;
+
+	if (IS_ENABLED(CONFIG_ENV_SECT_SIZE_AUTO))
+		sect_size = env_flash->mtd.erasesize;
+
+	span = roundup(CONFIG_ENV_SIZE, sect_size) + ENV_JOURNAL_SIZE;
+	start = (u64)offset + roundup(CONFIG_ENV_SIZE, sect_size);
+	if (ENV_JOURNAL_SIZE % sect_size ||
+	    start + ENV_JOURNAL_SIZE > env_flash->size)
+		goto nospace;
+	if (ENV_OFFSET_REDUND != OFFSET_INVALID &&
+	    CONFIG_ENV_OFFSET < ENV_OFFSET_REDUND + span &&
+	    ENV_OFFSET_REDUND < CONFIG_ENV_OFFSET + span)
+		goto nospace;
+	*jnl_offset = start;
+
+	return 0;
+nospace:
+	printf("No room for the environment journal at %llx\n", start);
+	return -ENOSPC;
+}
+
+/**
+ * env_sf_journal_load() - Apply the journal of the environment copy loaded
+ *
+ * @env_flash: SPI flash holding the environment
+ * @ep: Environment copy which was imported
+ * @offset: Offset of that copy in the flash
+ */
+static void env_sf_journal_load(struct spi_flash *env_flash, const env_t *ep,
+				u32 offset)
+{
+	struct env_journal *jnl = &env_sf_journal;
+	u32 jnl_offset;
+	int ret;
+
+	ret = env_sf_journal_offset(env_flash, offset, &jnl_offset);
+	if (ret) {
+		/* Use the copy alone; saveenv will write it in full */
+		env_journal_reset(jnl, NULL);
+		return;
+	}
+	ret = env_journal_setup(jnl);
+	if (!ret)
+		ret = spi_flash_read(env_flash, jnl_offset, ENV_JOURNAL_SIZE,
+				     jnl->buf);
+	if (!ret)
+		ret = env_journal_replay(jnl, ep);
+	if (ret) {
+		printf("Cannot read environment journal (err=%d)\n", ret);
+		env_journal_reset(jnl, NULL);
+	}
+}
+
+/**
+ * env_sf_journal_save() - Append the changed variables to the journal
+ *
+ * @env_flash: SPI flash holding the environment
+ * @jnl_offset: Offset of the journal of the environment copy in use
+ * Return: 0 if OK, -ENOSPC if the environment must be written in full instead,
+ *	other -ve on error
+ */
+static int env_sf_journal_save(struct spi_flash *env_flash, u32 jnl_offset)
+{
+	struct env_journal *jnl = &env_sf_journal;
+	int ret;
+
+	ret = env_journal_prepare(jnl);
+	if (ret)
+		return ret;
+	if (!jnl->len) {
+		puts("Environment is unchanged\n");
+		return 0;
+	}
+
+	puts("Writing to SPI flash journal...");
+	ret = spi_flash_write(env_flash, jnl_offset + jnl->pos,
+			      jnl->end - jnl->pos, jnl->buf + jnl->pos);
+	if (ret) {
+		env_journal_reset(jnl, NULL);
+		return ret;
+	}
+	env_journal_commit(jnl);
+	puts("done\n");
+
+	return 0;
+}
+
 #if defined(CONFIG_ENV_OFFSET_REDUND)
 static int env_sf_save(void)
 {
@@ -72,6 +203,8 @@ static int env_sf_save(void)
 	char	*saved_buffer = NULL, flag = ENV_REDUND_OBSOLETE;
 	u32	saved_size = 0, saved_offset = 0, sector;
 	u32	sect_size = CONFIG_ENV_SECT_SIZE;
+	u32	jnl_offset;
+	bool	journal = false;
 	int	ret;
 	struct spi_flash *env_flash;
 
@@ -82,9 +215,20 @@ static int env_sf_save(void)
 	if (IS_ENABLED(CONFIG_ENV_SECT_SIZE_AUTO))
 		sect_size = env_flash->mtd.erasesize;
 
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL) &&
+	    !env_sf_journal_offset(env_flash, gd->env_valid == ENV_REDUND ?
+				   CONFIG_ENV_OFFSET_REDUND : CONFIG_ENV_OFFSET,
+				   &jnl_offset)) {
+		ret = env_sf_journal_save(env_flash, jnl_offset);
+		if (ret != -ENOSPC)
+			goto done;
+	}
+
 	ret = env_export(&env_new);
-	if (ret)
-		return -EIO;
+	if (ret) {
+		ret = -EIO;
+		goto done;
+	}
 	env_new.flags	= ENV_REDUND_ACTIVE;
 
 	if (gd->env_valid == ENV_VALID) {
@@ -112,9 +256,17 @@ static int env_sf_save(void)
 
 	sector = DIV_ROUND_UP(CONFIG_ENV_SIZE, sect_size);
 
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL)) {
+		env_journal_reset(&env_sf_journal, NULL);
+		journal = !env_sf_journal_offset(env_flash, env_new_offset,
+						 &jnl_offset);
+	}
+
 	puts("Erasing SPI flash...");
 	ret = spi_flash_erase(env_flash, env_new_offset,
 				sector * sect_size);
+	if (!ret && journal)
+		ret = spi_flash_erase(env_flash, jnl_offset, ENV_JOURNAL_SIZE);
 	if (ret)
 		goto done;
 
@@ -139,10 +291,15 @@ static int env_sf_save(void)
 
 	puts("done\n");
 
-	gd->env_valid = gd->env_valid == ENV_REDUND ? ENV_VALID : ENV_REDUND;
+	/* The journal must go with the copy just written */
+	gd->env_valid = env_new_offset == CONFIG_ENV_OFFSET ? ENV_VALID :
+		ENV_REDUND;
 
 	printf("Valid environment: %d\n", (int)gd->env_valid);
 
+	if (journal)
+		env_journal_reset(&env_sf_journal, &env_new);
+
 done:
 	spi_flash_free(env_flash);
 
@@ -180,6 +337,14 @@ static int env_sf_load(void)
 
 	ret = env_import_redund((char *)tmp_env1, read1_fail, (char *)tmp_env2,
 				read2_fail, H_EXTERNAL);
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL) && !ret) {
+		if (gd->env_valid == ENV_REDUND)
+			env_sf_journal_load(env_flash, tmp_env2,
+					    CONFIG_ENV_OFFSET_REDUND);
+		else
+			env_sf_journal_load(env_flash, tmp_env1,
+					    CONFIG_ENV_OFFSET);
+	}
 
 	spi_flash_free(env_flash);
 out:
@@ -193,6 +358,8 @@ static int env_sf_save(void)
 {
 	u32	saved_size = 0, saved_offset = 0, sector;
 	u32	sect_size = CONFIG_ENV_SECT_SIZE;
+	u32	jnl_offset;
+	bool	journal = false;
 	char	*saved_buffer = NULL;
 	int	ret = 1;
 	env_t	env_new;
@@ -205,6 +372,15 @@ static int env_sf_save(void)
 	if (IS_ENABLED(CONFIG_ENV_SECT_SIZE_AUTO))
 		sect_size = env_flash->mtd.erasesize;
 
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL))
+		journal = !env_sf_journal_offset(env_flash, CONFIG_ENV_OFFSET,
+						 &jnl_offset);
+	if (journal) {
+		ret = env_sf_journal_save(env_flash, jnl_offset);
+		if (ret != -ENOSPC)
+			goto done;
+	}
+
 	/* Is the sector larger than the env (i.e. embedded) */
 	if (sect_size > CONFIG_ENV_SIZE) {
 		saved_size = sect_size - CONFIG_ENV_SIZE;
@@ -227,9 +403,14 @@ static int env_sf_save(void)
 
 	sector = DIV_ROUND_UP(CONFIG_ENV_SIZE, sect_size);
 
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL))
+		env_journal_reset(&env_sf_journal, NULL);
+
 	puts("Erasing SPI flash...");
 	ret = spi_flash_erase(env_flash, CONFIG_ENV_OFFSET,
 		sector * sect_size);
+	if (!ret && journal)
+		ret = spi_flash_erase(env_flash, jnl_offset, ENV_JOURNAL_SIZE);
 	if (ret)
 		goto done;
 
@@ -249,6 +430,9 @@ static int env_sf_save(void)
 	ret = 0;
 	puts("done\n");
 
+	if (journal)
+		env_journal_reset(&env_sf_journal, &env_new);
+
 done:
 	spi_flash_free(env_flash);
 
@@ -282,8 +466,12 @@ static int env_sf_load(void)
 	}
 
 	ret = env_import(buf, 1, H_EXTERNAL);
-	if (!ret)
+	if (!ret) {
 		gd->env_valid = ENV_VALID;
+		if (IS_ENABLED(CONFIG_ENV_JOURNAL))
+			env_sf_journal_load(env_flash, (env_t *)buf,
+					    CONFIG_ENV_OFFSET);
+	}
 
 err_read:
 	spi_flash_free(env_flash);
@@ -312,6 +500,9 @@ static int env_sf_erase(void)
 	if (ENV_OFFSET_REDUND != OFFSET_INVALID)
 		ret = spi_flash_write(env_flash, ENV_OFFSET_REDUND, CONFIG_ENV_SIZE, &env);
 
+	if (IS_ENABLED(CONFIG_ENV_JOURNAL))
+		env_journal_reset(&env_sf_journal, NULL);
+
 done:
 	spi_flash_free(env_flash);
 
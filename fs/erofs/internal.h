@@ -381,17 +381,4 @@ int z_erofs_map_blocks_iter(struct erofs_inode *vi,
 #define EFSCORRUPTED	EIO
 #endif
 
-#define CRC32C_POLY_LE	0x82F63B78
-static inline u32 erofs_crc32c(u32 crc, const u8 *in, size_t len)
-{
-	int i;
-
-	while (len--) {
-		crc ^= *in++;
-		for (i = 0; i < 8; i++)
-			crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY_LE : 0);
-	}
-	return crc;
-}
-
 #endif
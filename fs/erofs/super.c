@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: GPL-2.0+
+#include <u-boot/crc.h>
 #include "internal.h"
 
 static bool check_layout_compatibility(struct erofs_sb_info *sbi,
@@ -60,6 +61,29 @@ static int erofs_init_devices(struct erofs_sb_info *sbi,
 	return 0;
 }
 
+static int erofs_superblock_csum_verify(u8 *data)
+{
+	struct erofs_super_block *dsb;
+	u32 len = erofs_blksiz(), expected_crc, crc;
+
+	/* the checksum covers the rest of the first block */
+	if (len > EROFS_SUPER_OFFSET)
+		len -= EROFS_SUPER_OFFSET;
+
+	dsb = (struct erofs_super_block *)(data + EROFS_SUPER_OFFSET);
+	expected_crc = le32_to_cpu(dsb->checksum);
+	dsb->checksum = 0;
+	crc = crc32c(~0, dsb, len);
+	dsb->checksum = cpu_to_le32(expected_crc);
+
+	if (crc != expected_crc) {
+		erofs_err("invalid checksum 0x%08x, 0x%08x expected",
+			  crc, expected_crc);
+		return -EBADMSG;
+	}
+	return 0;
+}
+
 int erofs_read_superblock(void)
 {
 	u8 data[EROFS_MAX_BLOCK_SIZE];
@@ -91,6 +115,12 @@ int erofs_read_superblock(void)
 		return ret;
 	}
 
+	if (erofs_sb_has_sb_chksum()) {
+		ret = erofs_superblock_csum_verify(data);
+		if (ret)
+			return ret;
+	}
+
 	sbi.primarydevice_blocks = le32_to_cpu(dsb->blocks);
 	sbi.meta_blkaddr = le32_to_cpu(dsb->meta_blkaddr);
 	sbi.xattr_blkaddr = le32_to_cpu(dsb->xattr_blkaddr);
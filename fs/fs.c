@@ -532,6 +532,7 @@ static int fs_read_lmb_check(const char *filename, ulong addr, loff_t offset,
 			     loff_t len, struct fstype_info *info)
 {
 	struct lmb lmb;
+	bool reserved;
 	int ret;
 	loff_t size;
 	loff_t read_len;
@@ -553,7 +554,9 @@ static int fs_read_lmb_check(const char *filename, ulong addr, loff_t offset,
 	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
 	lmb_dump_all(&lmb);
 
-	if (lmb_alloc_addr(&lmb, addr, read_len) == addr)
+	reserved = lmb_alloc_addr(&lmb, addr, read_len) != addr;
+	lmb_uninit(&lmb);
+	if (!reserved)
 		return 0;
 
 	log_err("** Reading file would overwrite reserved memory **\n");
@@ -175,6 +175,25 @@ struct block_cache_stats {
  */
 void blkcache_stats(struct block_cache_stats *stats);
 
+/**
+ * blkcache_max_blocks() - get the maximum number of blocks in a cache entry
+ *
+ * Reads of more blocks than this are not cached.
+ *
+ * Return: maximum number of blocks per entry
+ */
+unsigned int blkcache_max_blocks(void);
+
+/**
+ * blkcache_grow() - allow cache entries of at least the given size
+ *
+ * Unlike blkcache_configure(), this keeps the cached data and does not reset
+ * the statistics. It does nothing if the cache is disabled.
+ *
+ * @blocks: minimum for the maximum number of blocks per entry
+ */
+void blkcache_grow(unsigned int blocks);
+
 /** blkcache_free() - free all memory allocated to the block cache */
 void blkcache_free(void);
 
@@ -193,6 +212,13 @@ static inline void blkcache_fill(int iftype, int dev,
 
 static inline void blkcache_invalidate(int iftype, int dev) {}
 
+static inline unsigned int blkcache_max_blocks(void)
+{
+	return 0;
+}
+
+static inline void blkcache_grow(unsigned int blocks) {}
+
 static inline void blkcache_free(void) {}
 
 #endif
@@ -70,6 +70,21 @@ struct bootdev_hunter;
  */
 typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
 
+/**
+ * bootdev_hunter_start_func - function to start probing for bootdevs
+ *
+ * This should start any slow set-up needed to find bootdevs of the given type,
+ * such as powering up a bus, but must not wait for it to complete. The
+ * hunter's @hunt function is called later to finish the job. It may be called
+ * more than once before then.
+ *
+ * @info: Info structure describing this hunter
+ * @show: true to show information from the hunter
+ * Returns: 0 if OK, -ENOENT on device not found, otherwise -ve on error
+ */
+typedef int (*bootdev_hunter_start_func)(struct bootdev_hunter *info,
+					 bool show);
+
 /**
  * struct bootdev_hunter - information about how to hunt for bootdevs
  *
@@ -77,6 +92,8 @@ typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
  * @uclass: Uclass ID for the media associated with this bootdev
  * @drv: bootdev driver for the things found by this hunter
  * @hunt: Function to call to hunt for bootdevs of this type (NULL if none)
+ * @start: Function to call to start hunting for bootdevs of this type, without
+ *	waiting (NULL if none)
  *
  * Some bootdevs are not visible until other devices are enumerated. For
  * example, USB bootdevs only appear when the USB bus is enumerated.
@@ -87,12 +104,18 @@ typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
  *
  * This struct holds information about the bootdev so we can determine the probe
  * order and how to hunt for bootdevs of this type
+ *
+ * Media which are slow to become ready can provide a @start function. With
+ * CONFIG_BOOTSTD_HUNT_START this is called for such hunters named in the boot
+ * order when a scan starts, so that they come up together while faster
+ * bootdevs are being scanned, rather than each in turn as their turn comes.
  */
 struct bootdev_hunter {
 	enum bootdev_prio_t prio;
 	enum uclass_id uclass;
 	struct driver *drv;
 	bootdev_hunter_func hunt;
+	bootdev_hunter_start_func start;
 };
 
 /* declare a new bootdev hunter */
@@ -310,6 +333,22 @@ void bootdev_list_hunters(struct bootstd_priv *std);
  */
 int bootdev_hunt(const char *spec, bool show);
 
+/**
+ * bootdev_hunt_start() - Start hunting for bootdevs without waiting
+ *
+ * This calls the @start function of each unused hunter which has one and
+ * matches one of the labels, so that slow media can get ready in the
+ * background. The hunt is completed later by bootdev_hunt() or
+ * bootdev_hunt_prio(). This does nothing unless CONFIG_BOOTSTD_HUNT_START is
+ * enabled.
+ *
+ * @labels: List of labels to match, e.g. {"mmc0", "usb", NULL}, with the same
+ * rules as for bootdev_hunt(). If NULL, no hunters are started
+ * @show: true to show information from the hunters
+ * Returns: 0 if OK, -ve on error
+ */
+int bootdev_hunt_start(const char *const *labels, bool show);
+
 /**
  * bootdev_hunt_prio() - Hunt for bootdevs of a particular priority
  *
@@ -381,6 +381,55 @@ int bootflow_read_all(struct bootflow *bflow);
  */
 int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow);
 
+/* Environment variable holding the record of the last bootflow booted */
+#define BOOTFLOW_CACHE_VAR	"bootflow_cache"
+
+/* Maximum length of the record, including the terminator */
+#define BOOTFLOW_CACHE_MAX	256
+
+/**
+ * bootflow_cache_save() - Record a bootflow so it can be booted directly
+ *
+ * This writes the bootdev, partition, bootmeth, filename, file size and CRC32,
+ * partition UUID and media uclass of the bootflow, along with a CRC32 of the
+ * bootdev and bootmeth ordering, to the environment. With
+ * CONFIG_BOOTSTD_CACHE_SAVE the environment is saved if the record has changed.
+ * This is done with CONFIG_BOOTSTD_CACHE just before a bootflow found by a
+ * full scan is booted.
+ *
+ * @bflow: Bootflow which is about to be booted
+ * Return: 0 if OK, -EOPNOTSUPP if the bootflow is not on a block device, other
+ *	-ve on error
+ */
+int bootflow_cache_save(const struct bootflow *bflow);
+
+/**
+ * bootflow_cache_read() - Read the recorded bootflow, if it is still valid
+ *
+ * This checks that the bootdev and bootmeth ordering is unchanged, locates the
+ * recorded bootdev, hunting its media uclass if needed, then reads the
+ * bootflow from the recorded partition using the recorded bootmeth, without
+ * scanning anything else. The result is checked against the record.
+ *
+ * @flags: Iterator flags to use (BOOTFLOWIF_HUNT and BOOTFLOWIF_SHOW are used)
+ * @bflow: Returns the bootflow, which is ready to boot. The caller must call
+ *	bootflow_free() on it
+ * Return: 0 if OK, -ENOENT if there is no record, -ESTALE if the ordering,
+ *	partition or file has changed, other -ve on error
+ */
+int bootflow_cache_read(int flags, struct bootflow *bflow);
+
+/**
+ * bootflow_cache_boot() - Boot the recorded bootflow, if it is still valid
+ *
+ * This only returns if the bootflow could not be found or failed to boot, in
+ * which case the caller should fall back to a full scan
+ *
+ * @flags: Iterator flags to use (BOOTFLOWIF_HUNT and BOOTFLOWIF_SHOW are used)
+ * Return: -ve error code
+ */
+int bootflow_cache_boot(int flags);
+
 /**
  * bootflow_state_get_name() - Get the name of a bootflow state
  *
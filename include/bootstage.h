@@ -213,6 +213,8 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_ENV_IMPORT,
+	BOOTSTAGE_ID_ACCUM_ENV_EXPORT,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -456,6 +458,79 @@ static inline int bootstage_init(bool first)
 
 #endif /* ENABLE_BOOTSTAGE */
 
+/**
+ * enum bootstage_span_kind - What a trace span is timing
+ *
+ * @BOOTSTAGE_SPAN_INITCALL: An initcall, identified by its address
+ * @BOOTSTAGE_SPAN_EVENT: An event sent from an initcall list
+ * @BOOTSTAGE_SPAN_PROBE: A device probe, identified by the device name
+ */
+enum bootstage_span_kind {
+	BOOTSTAGE_SPAN_INITCALL,
+	BOOTSTAGE_SPAN_EVENT,
+	BOOTSTAGE_SPAN_PROBE,
+};
+
+/**
+ * enum bootstage_trace_fmt - Output format for bootstage_trace_print()
+ *
+ * @BOOTSTAGE_TRACE_FOLDED: One line per stack with its self time, as used by
+ *	flame-graph tools
+ * @BOOTSTAGE_TRACE_JSON: Chrome trace-event JSON, with one complete ('X')
+ *	event per span
+ */
+enum bootstage_trace_fmt {
+	BOOTSTAGE_TRACE_FOLDED,
+	BOOTSTAGE_TRACE_JSON,
+};
+
+#if defined(ENABLE_BOOTSTAGE) && CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+/**
+ * bootstage_span_begin() - Start timing an initcall or device probe
+ *
+ * The new span becomes a child of the span which is currently open, if any.
+ * Every successful call must be matched by a call to bootstage_span_end().
+ *
+ * @kind: Kind of span
+ * @name: Name to record (copied and truncated if needed), or NULL to use
+ *	@addr instead
+ * @addr: Address to record, used to identify initcalls
+ * Return: span number to pass to bootstage_span_end(), or -ve if bootstage
+ *	is not set up or there is no space to record the span
+ */
+int bootstage_span_begin(enum bootstage_span_kind kind, const char *name,
+			 ulong addr);
+
+/**
+ * bootstage_span_end() - Finish timing a span
+ *
+ * @span: Span number returned by bootstage_span_begin(); -ve values are
+ *	ignored
+ */
+void bootstage_span_end(int span);
+
+/**
+ * bootstage_trace_print() - Print the recorded spans
+ *
+ * @fmt: Format to use
+ */
+void bootstage_trace_print(enum bootstage_trace_fmt fmt);
+#else
+static inline int bootstage_span_begin(enum bootstage_span_kind kind,
+				       const char *name, ulong addr)
+{
+	return -1;
+}
+
+static inline void bootstage_span_end(int span)
+{
+}
+
+static inline void bootstage_trace_print(enum bootstage_trace_fmt fmt)
+{
+}
+#endif
+
 /* helpers for SPL */
 int _bootstage_stash_default(void);
 int _bootstage_unstash_default(void);
@@ -53,6 +53,24 @@ struct bounce_buffer {
 	unsigned int flags;
 };
 
+/**
+ * struct bounce_buffer_stats - Bounce buffer usage counters
+ *
+ * Only collected if CONFIG_CMD_BOUNCEBUF is enabled.
+ *
+ * @sessions:		Number of bounce buffer sessions started
+ * @bounced:		Number of sessions which needed a bounce buffer
+ * @bounced_bytes:	Number of bytes copied through bounce buffers
+ * @shifted_bytes:	Number of bytes moved within the caller's buffer
+ *			instead of being bounced, see blk_read()
+ */
+struct bounce_buffer_stats {
+	ulong sessions;
+	ulong bounced;
+	u64 bounced_bytes;
+	u64 shifted_bytes;
+};
+
 /**
  * bounce_buffer_start() -- Start the bounce buffer session
  * state:	stores state passed between bounce_buffer_{start,stop}
@@ -83,4 +101,21 @@ int bounce_buffer_start_extalign(struct bounce_buffer *state, void *data,
  */
 int bounce_buffer_stop(struct bounce_buffer *state);
 
+/**
+ * bounce_buffer_add_shifted() -- Account for data moved in place
+ * len:		number of bytes moved
+ */
+void bounce_buffer_add_shifted(size_t len);
+
+/**
+ * bounce_buffer_stats() -- Get the bounce buffer statistics
+ * stats:	returns the statistics collected since the last reset
+ */
+void bounce_buffer_stats(struct bounce_buffer_stats *stats);
+
+/**
+ * bounce_buffer_reset_stats() -- Reset the bounce buffer statistics
+ */
+void bounce_buffer_reset_stats(void);
+
 #endif
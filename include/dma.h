@@ -342,4 +342,30 @@ static inline int dma_memcpy(void *dst, void *src, size_t len)
 	return -ENOSYS;
 }
 #endif /* CONFIG_DMA */
+
+#if CONFIG_IS_ENABLED(DMA_MEMCPY_OFFLOAD)
+/**
+ * dma_memcpy_offload() - Copy memory using DMA if it is worthwhile
+ *
+ * Copies of at least CONFIG_DMA_MEMCPY_OFFLOAD_MIN bytes between areas which
+ * do not overlap are done with dma_memcpy(). Both areas and the length must
+ * be aligned to ARCH_DMA_MINALIGN, since the cache maintenance works on whole
+ * cache lines. The caller must do the copy itself if this fails.
+ *
+ * @dst: Destination pointer
+ * @src: Source pointer
+ * @len: Number of bytes to copy
+ * @chunksz: Number of bytes to copy between calls to schedule(), a multiple
+ *	of ARCH_DMA_MINALIGN, or 0 to copy everything at once
+ * Return: 0 if the data was copied, -EINVAL if the copy is not suitable for
+ *	offloading, other -ve on error
+ */
+int dma_memcpy_offload(void *dst, void *src, size_t len, ulong chunksz);
+#else
+static inline int dma_memcpy_offload(void *dst, void *src, size_t len,
+				     ulong chunksz)
+{
+	return -ENOSYS;
+}
+#endif
 #endif	/* _DMA_H_ */
@@ -93,6 +93,7 @@ efi_status_t efi_query_variable_info_int(u32 attributes,
 					 u64 *maximum_variable_size);
 
 #define EFI_VAR_FILE_NAME "ubootefi.var"
+#define EFI_VAR_LOG_NAME "ubootefi.log"
 
 #define EFI_VAR_BUF_SIZE CONFIG_EFI_VAR_BUF_SIZE
 
@@ -102,6 +103,12 @@ efi_status_t efi_query_variable_info_int(u32 attributes,
  */
 #define EFI_VAR_FILE_MAGIC 0x0161566966456255 /* UbEfiVa, version 1 */
 
+/*
+ * This constant identifies the header of the log of changes to UEFI variables
+ * in struct efi_var_log.
+ */
+#define EFI_VAR_LOG_MAGIC 0x01674c6966456255 /* UbEfiLg, version 1 */
+
 /**
  * struct efi_var_entry - UEFI variable file entry
  *
@@ -136,6 +143,24 @@ struct efi_var_file {
 	struct efi_var_entry var[];
 };
 
+/**
+ * struct efi_var_log - header of the file logging changes to UEFI variables
+ *
+ * The header is followed by records in the format of struct efi_var_file,
+ * each holding a single variable. The log only applies to the variable file
+ * identified by @var_length and @var_crc32, so that a log which was left over
+ * when the variable file was rewritten is not replayed.
+ *
+ * @magic:	identifies file format, takes value %EFI_VAR_LOG_MAGIC
+ * @var_length:	length of the variable file the log applies to
+ * @var_crc32:	CRC32 of the variable file the log applies to
+ */
+struct efi_var_log {
+	u64 magic;
+	u32 var_length;
+	u32 var_crc32;
+};
+
 /**
  * efi_var_to_file() - save non-volatile variables as file
  *
@@ -145,6 +170,24 @@ struct efi_var_file {
  */
 efi_status_t efi_var_to_file(void);
 
+/**
+ * efi_var_update_file() - save a changed non-volatile variable
+ *
+ * With CONFIG_EFI_VARIABLE_FILE_LOG=y the new value of the variable is
+ * appended to the log file ubootefi.log. The log is merged into file
+ * ubootefi.var when it grows larger than that file. Otherwise
+ * efi_var_to_file() is called.
+ *
+ * The log names the variable file it applies to, so if the log cannot be
+ * cleared after the variable file is rewritten, it is ignored when the
+ * variables are next loaded.
+ *
+ * @name:	name of the variable
+ * @guid:	vendor GUID of the variable
+ * Return:	status code
+ */
+efi_status_t efi_var_update_file(const u16 *name, const efi_guid_t *guid);
+
 /**
  * efi_var_collect() - collect variables in buffer
  *
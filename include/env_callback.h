@@ -86,10 +86,24 @@
 
 #ifndef CONFIG_SPL_BUILD
 void env_callback_init(struct env_entry *var_entry);
+
+/**
+ * env_callback_init_all() - Set up the callbacks of all variables at once
+ *
+ * This is faster than calling env_callback_init() for each variable, e.g.
+ * after a whole environment has been imported.
+ *
+ * @htab: Hash table holding the variables
+ */
+void env_callback_init_all(struct hsearch_data *htab);
 #else
 static inline void env_callback_init(struct env_entry *var_entry)
 {
 }
+
+static inline void env_callback_init_all(struct hsearch_data *htab)
+{
+}
 #endif
 
 #endif /* __ENV_CALLBACK_H__ */
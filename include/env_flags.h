@@ -168,6 +168,16 @@ int env_flags_validate_env_set_params(char *name, char *const val[], int count);
  */
 void env_flags_init(struct env_entry *var_entry);
 
+/**
+ * env_flags_init_all() - Set up the flags of all variables at once
+ *
+ * This is faster than calling env_flags_init() for each variable, e.g.
+ * after a whole environment has been imported.
+ *
+ * @htab: Hash table holding the variables
+ */
+void env_flags_init_all(struct hsearch_data *htab);
+
 /*
  * Validate the newval for to conform with the requirements defined by its flags
  */
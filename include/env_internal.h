@@ -271,6 +271,97 @@ const char *env_fat_get_intf(void);
  * Return: string of device and partition
  */
 char *env_fat_get_dev_part(void);
+
+/**
+ * struct env_journal - Journal of changes following a copy of the environment
+ *
+ * With CONFIG_ENV_JOURNAL, saveenv appends the changed variables to a journal
+ * area after the environment copy instead of rewriting the copy. The driver
+ * reads and writes the area; this holds its contents and what is needed to
+ * work out the next record.
+ *
+ * @buf: Contents of the journal area, CONFIG_ENV_JOURNAL_SIZE bytes
+ * @shadow: Environment data as held by storage, i.e. the copy plus journal
+ * @data: Environment data being saved, while a record is prepared
+ * @pos: Offset in @buf of the next record
+ * @len: Length of the record prepared at @pos, 0 if none
+ * @end: Offset in @buf of the end of the bytes to write for the prepared
+ *	record; unless the area was erased this includes an empty header after
+ *	the record, to end the journal
+ * @crc: CRC of the last record, or of the environment copy if there is none
+ * @new_crc: CRC of the record prepared at @pos
+ * @blank: Value of bytes never written, 0xff for flash, 0 otherwise
+ * @valid: true if @shadow is known, false if the next save must rewrite the
+ *	environment copy
+ */
+struct env_journal {
+	unsigned char *buf;
+	char *shadow;
+	char *data;
+	unsigned int pos;
+	unsigned int len;
+	unsigned int end;
+	uint32_t crc;
+	uint32_t new_crc;
+	unsigned char blank;
+	bool valid;
+};
+
+/**
+ * env_journal_setup() - Allocate the buffers of a journal
+ *
+ * This does nothing if the buffers are already allocated. The driver sets
+ * @jnl->blank beforehand.
+ *
+ * @jnl: Journal to set up
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+int env_journal_setup(struct env_journal *jnl);
+
+/**
+ * env_journal_replay() - Apply the records of a journal to the environment
+ *
+ * The caller reads the journal area into @jnl->buf after importing the
+ * environment copy @ep. Records are applied up to the first one which is not
+ * valid.
+ *
+ * @jnl: Journal, set up with env_journal_setup()
+ * @ep: Environment copy which the journal follows
+ * Return: 0 if OK, -ve on error
+ */
+int env_journal_replay(struct env_journal *jnl, const env_t *ep);
+
+/**
+ * env_journal_prepare() - Prepare a record with the changes to be saved
+ *
+ * The record is placed at @jnl->pos in @jnl->buf and is @jnl->len bytes long,
+ * which is 0 if nothing changed. The driver writes the bytes from @jnl->pos to
+ * @jnl->end and then calls env_journal_commit().
+ *
+ * @jnl: Journal
+ * Return: 0 if OK, -ENOSPC if the record does not fit and the environment copy
+ *	must be rewritten instead, other -ve on error
+ */
+int env_journal_prepare(struct env_journal *jnl);
+
+/**
+ * env_journal_commit() - Note that the prepared record has been written
+ *
+ * @jnl: Journal
+ */
+void env_journal_commit(struct env_journal *jnl);
+
+/**
+ * env_journal_reset() - Note that the journal area has been cleared
+ *
+ * This is called after the environment copy @ep was written and the journal
+ * area following it cleared, or with @ep set to NULL if the contents of
+ * storage are not known, e.g. after an error.
+ *
+ * @jnl: Journal
+ * @ep: Environment copy which was written, or NULL
+ */
+void env_journal_reset(struct env_journal *jnl, const env_t *ep);
 #endif /* DO_DEPS_ONLY */
 
 #endif /* _ENV_INTERNAL_H_ */
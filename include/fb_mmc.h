@@ -32,6 +32,37 @@ int fastboot_mmc_get_part_info(const char *part_name,
  */
 void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 			      u32 download_bytes, char *response);
+
+/**
+ * fastboot_mmc_flash_stream_start() - Start streaming a sparse image to eMMC
+ *
+ * The image is written piece by piece while it is being downloaded, so it
+ * does not need to fit in the download buffer.
+ *
+ * @cmd: Named partition to write image to
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve on error
+ */
+int fastboot_mmc_flash_stream_start(const char *cmd, char *response);
+
+/**
+ * fastboot_mmc_flash_stream_write() - Write the next piece of a sparse image
+ *
+ * @data: Pointer to received image data
+ * @len: Length of received image data
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve on error
+ */
+int fastboot_mmc_flash_stream_write(const void *data, u32 len, char *response);
+
+/**
+ * fastboot_mmc_flash_stream_finish() - Complete a streamed sparse image
+ *
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve on error
+ */
+int fastboot_mmc_flash_stream_finish(char *response);
+
 /**
  * fastboot_mmc_flash_erase() - Erase eMMC for fastboot
  *
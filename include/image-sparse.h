@@ -26,6 +26,15 @@ struct sparse_storage {
 				 lbaint_t blk,
 				 lbaint_t blkcnt);
 
+	/*
+	 * Optional: discard blkcnt blocks so that they read back as zero.
+	 * When provided, runs of zero CHUNK_TYPE_FILL chunks are handed to
+	 * this instead of being written out block by block.
+	 */
+	lbaint_t	(*erase)(struct sparse_storage *info,
+				 lbaint_t blk,
+				 lbaint_t blkcnt);
+
 	void		(*mssg)(const char *str, char *response);
 };
 
@@ -40,5 +49,124 @@ static inline int is_sparse_image(void *buf)
 	return 0;
 }
 
+enum sparse_stream_state {
+	SPARSE_STREAM_FILE_HDR,
+	SPARSE_STREAM_CHUNK_HDR,
+	SPARSE_STREAM_RAW,
+	SPARSE_STREAM_FILL,
+	SPARSE_STREAM_DONE,
+	SPARSE_STREAM_ERROR,
+};
+
+enum sparse_run_type {
+	SPARSE_RUN_NONE,
+	SPARSE_RUN_DONT_CARE,
+	SPARSE_RUN_FILL,
+};
+
+/**
+ * struct sparse_stream - state of an incremental sparse image write
+ *
+ * The sparse image is fed in arbitrarily sized pieces with
+ * sparse_stream_write(). Raw data is written out as soon as enough of it
+ * has arrived, while adjacent DONT_CARE chunks and FILL chunks with the
+ * same value are merged into a single run which is only issued once a
+ * different chunk type shows up.
+ *
+ * @info: Storage backend
+ * @part_name: Name of the partition being written, for messages
+ * @state: Current parser state
+ * @hdr: Sparse file header, once it has been received
+ * @chunk: Header of the chunk being processed
+ * @partial: Bytes of the current header or fill value received so far
+ * @chunk_val: Fill value of the current chunk
+ * @skip: Bytes to drop before continuing in @state
+ * @remain: Bytes of raw data left in the current chunk
+ * @chunk_idx: Number of chunks processed so far
+ * @blk: Next block to write
+ * @total_blocks: Number of output blocks covered by the chunks so far
+ * @bytes_written: Number of bytes written to the storage
+ * @buf: DMA-aligned bounce buffer for raw data
+ * @buf_blks: Size of @buf in blocks
+ * @buf_len: Number of bytes currently held in @buf
+ * @fill_buf: Buffer holding the current fill pattern
+ * @fill_val: Fill pattern held in @fill_buf
+ * @run: Type of the pending coalesced run
+ * @run_val: Fill value of the pending run
+ * @run_blks: Number of blocks in the pending run
+ */
+struct sparse_stream {
+	struct sparse_storage *info;
+	const char *part_name;
+	enum sparse_stream_state state;
+	sparse_header_t hdr;
+	chunk_header_t chunk;
+	u32 partial;
+	u32 chunk_val;
+	u32 skip;
+	u64 remain;
+	u32 chunk_idx;
+	lbaint_t blk;
+	u32 total_blocks;
+	u64 bytes_written;
+	void *buf;
+	lbaint_t buf_blks;
+	u32 buf_len;
+	u32 *fill_buf;
+	u32 fill_val;
+	enum sparse_run_type run;
+	u32 run_val;
+	lbaint_t run_blks;
+};
+
+/**
+ * sparse_stream_start() - Prepare to write a sparse image incrementally
+ *
+ * @stream: Stream state to set up
+ * @info: Storage backend to write to
+ * @part_name: Name of the partition, used in messages
+ */
+void sparse_stream_start(struct sparse_stream *stream,
+			struct sparse_storage *info, const char *part_name);
+
+/**
+ * sparse_stream_write() - Feed the next piece of a sparse image
+ *
+ * Any complete chunks in @data are written to the storage before this
+ * returns. Data following the last chunk is ignored.
+ *
+ * @stream: Stream state
+ * @data: Next bytes of the image
+ * @len: Number of bytes in @data
+ * @response: Pointer to fastboot response buffer, or NULL
+ * Return: 0 if OK, -ve on error (the stream then rejects further data)
+ */
+int sparse_stream_write(struct sparse_stream *stream, const void *data,
+			size_t len, char *response);
+
+/**
+ * sparse_stream_finish() - Complete an incremental sparse image write
+ *
+ * Issues any pending run, checks that the whole image was received and
+ * releases the buffers held by @stream. This must be called once for each
+ * sparse_stream_start(), even after an error.
+ *
+ * @stream: Stream state
+ * @response: Pointer to fastboot response buffer, or NULL
+ * Return: 0 if OK, -ve on error
+ */
+int sparse_stream_finish(struct sparse_stream *stream, char *response);
+
+/**
+ * write_sparse_image() - Write a sparse image held in memory
+ *
+ * @info: Storage to write to
+ * @part_name: Name of the partition, for messages
+ * @data: Sparse image
+ * @size: Number of bytes available at @data. Nothing beyond this is read and
+ *	the write fails if the image is longer.
+ * @response: Pointer to fastboot response buffer, or NULL
+ * Return: 0 if OK, -1 on error
+ */
 int write_sparse_image(struct sparse_storage *info, const char *part_name,
-		       void *data, char *response);
+		       void *data, size_t size, char *response);
@@ -0,0 +1,23 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Looking up symbols in the builtin symbol table
+ *
+ * Copyright (c) 2008-2009 Analog Devices Inc.
+ */
+
+#ifndef __KALLSYMS_H
+#define __KALLSYMS_H
+
+/**
+ * symbol_lookup() - Find the function containing an address
+ *
+ * This needs CONFIG_KALLSYMS. Addresses are link-time addresses, so take off
+ * gd->reloc_off from an address in relocated U-Boot first.
+ *
+ * @addr: Address to look up
+ * @caddr: Returns the address of the start of the function, or 0 if none
+ * Return: name of the function, or NULL if none
+ */
+const char *symbol_lookup(unsigned long addr, unsigned long *caddr);
+
+#endif
@@ -51,6 +51,13 @@ struct lmb_property {
  *         lmb_region.region is only a pointer to the correct buffer,
  *         initialized in lmb_init(). This configuration is useful to manage
  *         more reserved memory regions with CONFIG_LMB_RESERVED_REGIONS.
+ *
+ * With CONFIG_LMB_DYNAMIC_REGIONS, lmb_region.region is always a pointer, to
+ * the buffers in struct lmb sized as above, and is moved to a larger array on
+ * the heap when they are full. lmb_uninit() frees that array.
+ *
+ * In both cases the regions are kept sorted by base address and do not
+ * overlap, so lookups use a binary search.
  */
 
 /**
@@ -59,15 +66,20 @@ struct lmb_property {
  * @cnt: Number of regions.
  * @max: Size of the region array, max value of cnt.
  * @region: Array of the region properties
+ * @allocated: true if @region was allocated on the heap
  */
 struct lmb_region {
 	unsigned long cnt;
 	unsigned long max;
-#if IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
+#if IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS) && \
+	!IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS)
 	struct lmb_property region[CONFIG_LMB_MAX_REGIONS];
 #else
 	struct lmb_property *region;
 #endif
+#if IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS)
+	bool allocated;
+#endif
 };
 
 /**
@@ -86,13 +98,29 @@ struct lmb_region {
 struct lmb {
 	struct lmb_region memory;
 	struct lmb_region reserved;
-#if !IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
+#if IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS) && \
+	IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
+	struct lmb_property memory_regions[CONFIG_LMB_MAX_REGIONS];
+	struct lmb_property reserved_regions[CONFIG_LMB_MAX_REGIONS];
+#elif !IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
 	struct lmb_property memory_regions[CONFIG_LMB_MEMORY_REGIONS];
 	struct lmb_property reserved_regions[CONFIG_LMB_RESERVED_REGIONS];
 #endif
 };
 
 void lmb_init(struct lmb *lmb);
+
+/**
+ * lmb_uninit() - free the region arrays allocated for an lmb struct
+ *
+ * With CONFIG_LMB_DYNAMIC_REGIONS, this must be called before an lmb struct
+ * set up by lmb_init() goes out of scope or is set up again, so that region
+ * arrays which were moved to the heap are freed. Afterwards the struct is
+ * empty, as after lmb_init().
+ *
+ * @lmb:	the logical memory block struct
+ */
+void lmb_uninit(struct lmb *lmb);
 void lmb_init_and_reserve(struct lmb *lmb, struct bd_info *bd, void *fdt_blob);
 void lmb_init_and_reserve_range(struct lmb *lmb, phys_addr_t base,
 				phys_size_t size, void *fdt_blob);
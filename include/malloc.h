@@ -895,6 +895,52 @@ void malloc_enable_testing(int max_allocs);
 /** malloc_disable_testing() - Put malloc() into normal mode */
 void malloc_disable_testing(void);
 
+/* Number of chunk-size classes in struct malloc_info */
+#define MALLOC_INFO_CLASSES	16
+
+/**
+ * struct malloc_info - Usage and statistics of the malloc() region
+ *
+ * @total_bytes: Size of the region
+ * @system_bytes: Number of bytes taken from the region so far
+ * @peak_bytes: Highest value of @system_bytes; the region must be at least
+ *	this big
+ * @in_use_bytes: Number of bytes in allocated chunks, including overhead
+ * @free_bytes: Number of bytes available for allocation, not counting
+ *	@cached_bytes
+ * @largest_free: Size of the largest chunk that could be allocated without
+ *	flushing the small-chunk cache
+ * @free_chunks: Number of free chunks, other than the top one
+ * @cached_bytes: Number of bytes in freed chunks held by the small-chunk
+ *	cache (CONFIG_SYS_MALLOC_SMALL_CACHE)
+ * @calls: Number of allocations (needs CONFIG_CMD_MALLOC)
+ * @cache_hits: Number of allocations served by the small-chunk cache
+ * @class_count: Number of allocations by chunk size: [0] is up to 16 bytes,
+ *	[1] up to 32 bytes, etc. and the last is everything larger
+ */
+struct malloc_info {
+	ulong total_bytes;
+	ulong system_bytes;
+	ulong peak_bytes;
+	ulong in_use_bytes;
+	ulong free_bytes;
+	ulong largest_free;
+	ulong free_chunks;
+	ulong cached_bytes;
+	ulong calls;
+	ulong cache_hits;
+	ulong class_count[MALLOC_INFO_CLASSES];
+};
+
+/**
+ * malloc_get_info() - Get usage and statistics of the malloc() region
+ *
+ * This only covers the full malloc(), not the pre-relocation one.
+ *
+ * @info: Returns the information
+ */
+void malloc_get_info(struct malloc_info *info);
+
 #if CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
 #define malloc malloc_simple
 #define realloc realloc_simple
@@ -152,6 +152,24 @@ void os_set_alarm_handler(void (*handler)(int));
  */
 void os_raise_sigalrm(void);
 
+/**
+ * os_profile_start() - start sampling the program counter
+ *
+ * Sets up a profiling timer which fires every @interval_us of CPU time used
+ * by the process. The handler is called in signal context.
+ *
+ * @interval_us:	sampling interval in microseconds
+ * @handler:		function to call with the interrupted program counter
+ * Returns:		0 on success, -1 on error
+ */
+int os_profile_start(unsigned int interval_us,
+		     void (*handler)(unsigned long pc));
+
+/**
+ * os_profile_stop() - stop sampling the program counter
+ */
+void os_profile_stop(void);
+
 /**
  * os_tty_raw() - put tty into raw mode to mimic serial console better
  *
@@ -847,6 +847,11 @@ struct udevice;
  * @vendor:	PCI vendor ID (see pci_ids.h)
  * @device:	PCI device ID (see pci_ids.h)
  * @class:	PCI class, 3 bytes: (base, sub, prog-if)
+ * @revision:	PCI revision ID
+ * @header_type: PCI header type, including the multi-function bit
+ * @hdr_cached:	true if @class, @revision and @header_type were read from
+ *		the device when its bus was scanned, so that reads of these
+ *		registers need not access config space
  * @is_virtfn:	True for Virtual Function device
  * @pfdev:	Handle to Physical Function device
  * @virtid:	Virtual Function Index
@@ -856,6 +861,9 @@ struct pci_child_plat {
 	unsigned short vendor;
 	unsigned short device;
 	unsigned int class;
+	u8 revision;
+	u8 header_type;
+	bool hdr_cached;
 
 	/* Variables for CONFIG_PCI_SRIOV */
 	bool is_virtfn;
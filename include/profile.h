@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Statistical profiler, which samples the program counter
+ */
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include <linux/types.h>
+
+/**
+ * enum profile_src - Source of profile samples
+ *
+ * @PROFILE_SRC_TIMER: Periodic timer interrupt, see arch_profile_start().
+ *	Each sample has a weight of 1.
+ * @PROFILE_SRC_POLL: Calls to schedule(). Each sample is recorded against the
+ *	caller of schedule(), weighted by the time in microseconds since the
+ *	previous call.
+ */
+enum profile_src {
+	PROFILE_SRC_TIMER,
+	PROFILE_SRC_POLL,
+};
+
+/**
+ * struct profile_entry - Total weight of the samples at a program counter
+ *
+ * @pc: Program counter, as a link-time address (i.e. before relocation)
+ * @weight: Total weight of the samples at @pc
+ */
+struct profile_entry {
+	ulong pc;
+	ulong weight;
+};
+
+/**
+ * struct profile_info - Summary of the samples recorded
+ *
+ * @active: true if sampling is running
+ * @src: Source of the samples
+ * @samples: Number of samples recorded
+ * @total: Total weight of all samples
+ * @dropped: Weight of the samples which could not be recorded, since there
+ *	was no space for a new program counter
+ */
+struct profile_info {
+	bool active;
+	enum profile_src src;
+	ulong samples;
+	ulong total;
+	ulong dropped;
+};
+
+/**
+ * profile_start() - Discard any existing samples and start sampling
+ *
+ * @src: Source of the samples
+ * @interval_us: Sampling interval for PROFILE_SRC_TIMER, in microseconds
+ * Return: 0 if OK, -ENOMEM if out of memory, -ENOSYS if @src is not
+ *	supported, other -ve on error
+ */
+int profile_start(enum profile_src src, uint interval_us);
+
+/**
+ * profile_stop() - Stop sampling
+ *
+ * The samples recorded so far are kept until the next profile_start().
+ */
+void profile_stop(void);
+
+/**
+ * profile_get_info() - Get a summary of the samples
+ *
+ * @info: Returns the summary
+ */
+void profile_get_info(struct profile_info *info);
+
+/**
+ * profile_get_top() - Get the program counters with the highest weight
+ *
+ * @ent: Returns the entries, in order of decreasing weight
+ * @count: Maximum number of entries to return
+ * Return: number of entries returned, or -ENOMEM if out of memory
+ */
+int profile_get_top(struct profile_entry *ent, int count);
+
+/**
+ * profile_tick() - Record a sample from a timer interrupt
+ *
+ * This is called by the architecture's interrupt handler, once
+ * arch_profile_start() has been called. It must be safe to call from
+ * interrupt context.
+ *
+ * @pc: Interrupted program counter
+ */
+void profile_tick(ulong pc);
+
+/**
+ * profile_poll() - Record a sample from schedule()
+ *
+ * @pc: Address that schedule() was called from
+ */
+void profile_poll(ulong pc);
+
+/**
+ * arch_profile_start() - Start a periodic timer interrupt for profiling
+ *
+ * The interrupt handler must call profile_tick() with the interrupted program
+ * counter.
+ *
+ * @interval_us: Interval between interrupts, in microseconds
+ * Return: 0 if OK, -ENOSYS if not supported, other -ve on error
+ */
+int arch_profile_start(uint interval_us);
+
+/**
+ * arch_profile_stop() - Stop the timer interrupt started by arch_profile_start()
+ */
+void arch_profile_stop(void);
+
+#endif
@@ -12,6 +12,7 @@
 #include <linux/bitops.h>
 #include <linux/types.h>
 #include <linux/kernel.h>
+#include <linux/sizes.h>
 #include <asm/io.h>
 #include <mmc.h>
 #include <asm/gpio.h>
@@ -21,6 +22,7 @@
  */
 
 #define SDHCI_DMA_ADDRESS	0x00
+#define SDHCI_32BIT_BLK_CNT	SDHCI_DMA_ADDRESS
 
 #define SDHCI_BLOCK_SIZE	0x04
 #define  SDHCI_MAKE_BLKSZ(dma, blksz) (((dma & 0x7) << 12) | (blksz & 0xFFF))
@@ -166,6 +168,9 @@
 #define  SDHCI_CTRL_DRV_TYPE_D	0x0030
 #define  SDHCI_CTRL_EXEC_TUNING	0x0040
 #define  SDHCI_CTRL_TUNED_CLK	0x0080
+#define  SDHCI_CTRL_ADMA2_LEN_MODE	0x0400
+#define  SDHCI_CTRL_V4_MODE	0x1000
+#define  SDHCI_CTRL_64BIT_ADDR	0x2000
 #define  SDHCI_CTRL_PRESET_VAL_ENABLE	0x8000
 
 #define SDHCI_CAPABILITIES	0x40
@@ -223,6 +228,8 @@
 #define   SDHCI_SPEC_100	0
 #define   SDHCI_SPEC_200	1
 #define   SDHCI_SPEC_300	2
+#define   SDHCI_SPEC_400	3
+#define   SDHCI_SPEC_410	4
 
 #define SDHCI_GET_VERSION(x) (x->version & SDHCI_SPEC_VER_MASK)
 
@@ -253,6 +260,12 @@
 #define SDHCI_QUIRK_SUPPORT_SINGLE	(1 << 10)
 /* Capability register bit-63 indicates HS400 support */
 #define SDHCI_QUIRK_CAPS_BIT63_FOR_HS400	BIT(11)
+/*
+ * SDHCI_QUIRK_BROKEN_CMD23
+ * the controller cannot handle SET_BLOCK_COUNT (CMD23) ahead of a
+ * multi-block transfer, so transfers are ended with CMD12 instead
+ */
+#define SDHCI_QUIRK_BROKEN_CMD23	BIT(12)
 
 /* to make gcc happy */
 struct sdhci_host;
@@ -300,7 +313,11 @@ struct sdhci_ops {
 };
 
 #define ADMA_MAX_LEN	65532
-#ifdef CONFIG_MMC_SDHCI_ADMA_64BIT
+/* In v4 mode descriptors carry a 26-bit length */
+#define ADMA_V4_MAX_LEN	(SZ_64M - 4)
+#if defined(CONFIG_MMC_SDHCI_ADMA_64BIT) && defined(CONFIG_MMC_SDHCI_ADMA_V4)
+#define ADMA_DESC_LEN	16
+#elif defined(CONFIG_MMC_SDHCI_ADMA_64BIT)
 #define ADMA_DESC_LEN	12
 #else
 #define ADMA_DESC_LEN	8
@@ -322,11 +339,14 @@ struct sdhci_ops {
 
 struct sdhci_adma_desc {
 	u8 attr;
-	u8 reserved;
+	u8 len_hi;	/* bits 25:18 of the length in v4 mode, else 0 */
 	u16 len;
 	u32 addr_lo;
 #ifdef CONFIG_MMC_SDHCI_ADMA_64BIT
 	u32 addr_hi;
+#ifdef CONFIG_MMC_SDHCI_ADMA_V4
+	u32 reserved;
+#endif
 #endif
 } __packed;
 
@@ -357,6 +377,7 @@ struct sdhci_host {
 #define USE_SDMA	(0x1 << 0)
 #define USE_ADMA	(0x1 << 1)
 #define USE_ADMA64	(0x1 << 2)
+#define USE_ADMA_V4	(0x1 << 3)
 #define USE_DMA		(USE_SDMA | USE_ADMA | USE_ADMA64)
 	dma_addr_t adma_addr;
 #if CONFIG_IS_ENABLED(MMC_SDHCI_ADMA)
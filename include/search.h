@@ -47,6 +47,12 @@ struct hsearch_data {
 	struct env_entry_node *table;
 	unsigned int size;
 	unsigned int filled;
+/*
+ * The entries in the order of their keys, which hexport_r() uses. It holds
+ * the first "filled" entries and is rebuilt when "unsorted" is set.
+ */
+	struct env_entry **sorted;
+	bool unsorted;
 /*
  * Callback function which will check whether the given change for variable
  * "item" to "newval" may be applied or not, and possibly apply such change.
@@ -107,6 +113,24 @@ int himport_r(struct hsearch_data *htab, const char *env, size_t size,
 int hwalk_r(struct hsearch_data *htab,
 	    int (*callback)(struct env_entry *entry));
 
+/**
+ * hwalk_key_r() - Call a function for each entry with a matching key
+ *
+ * With CONFIG_REGEX @name may be a regular expression, which must match the
+ * whole key. Otherwise, or if @name holds no special characters, only the
+ * entry with the key @name is passed to @callback.
+ *
+ * @htab: Hash table
+ * @name: Name or regular expression to match
+ * @callback: Function to call for each matching entry
+ * @priv: Private data passed to @callback
+ * Return: 0 on success, -EINVAL if @name is not a valid regular expression,
+ *	else the first non-zero value returned by @callback
+ */
+int hwalk_key_r(struct hsearch_data *htab, const char *name,
+		int (*callback)(struct env_entry *entry, void *priv),
+		void *priv);
+
 /* Flags for himport_r(), hexport_r(), hdelete_r(), and hsearch_r() */
 #define H_NOCLEAR	(1 << 0) /* do not clear hash table before importing */
 #define H_FORCE		(1 << 1) /* overwrite read-only/write-once variables */
@@ -123,5 +147,6 @@ int hwalk_r(struct hsearch_data *htab,
 #define H_ORIGIN_FLAGS	(H_INTERACTIVE | H_PROGRAMMATIC)
 #define H_DEFAULT	(1 << 10) /* indicate that an import is default env */
 #define H_EXTERNAL	(1 << 11) /* indicate that an import is external env */
+#define H_BULK		(1 << 12) /* new entries are set up by himport_r() */
 
 #endif /* _SEARCH_H_ */
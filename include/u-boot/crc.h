@@ -99,28 +99,53 @@ void crc32_wd_buf(const uint8_t *input, uint ilen, uint8_t *output,
 /* lib/crc32c.c */
 
 /**
- * crc32c_init() - Set up a the CRC32 table
+ * crc32c() - Calculate the CRC32C (Castagnoli) for a block of data
  *
- * This sets up 256-item table to aid in CRC32 calculation
+ * This is the raw CRC with no one's complement at the start or end, so
+ * callers normally pass ~0 as @crc and invert the result.
  *
- * @crc32c_table: Place to put table
- * @pol: polynomial to use
+ * @crc: Input crc to chain from a previous calculation
+ * @buf: Bytes to checksum
+ * @len: Number of bytes to checksum
+ * Return: checksum value
  */
-void crc32c_init(uint32_t *crc32c_table, uint32_t pol);
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len);
+
+/* lib/crc_slice.c */
+
+/* Number of bytes handled by each step of the slicing-by-8 functions */
+#define CRC_SLICES	8
+
+extern const uint32_t crc32_slice_table[CRC_SLICES][256];
+extern const uint32_t crc32c_slice_table[CRC_SLICES][256];
+extern const uint16_t crc16_ccitt_slice_table[CRC_SLICES][256];
 
 /**
- * crc32c_cal() - Perform CRC32 on a buffer given a table
+ * crc_slice32() - Update a bit-reflected 32-bit CRC, eight bytes at a time
  *
- * This algorithm uses the table (set up by crc32c_init() to speed up
- * processing.
+ * This is used by crc32() and crc32c() when CONFIG_CRC_SLICE_BY_8 is enabled
  *
- * @crc: Previous crc (use 0 at start)
- * @data: Data bytes to checksum
- * @length: Number of bytes to process
- * @crc32c_table:: CRC table
- * Return: checksum value
+ * @tab: Slicing tables for the polynomial, e.g. crc32_slice_table
+ * @crc: CRC so far, with any inversion already applied
+ * @buf: Bytes to checksum
+ * @len: Number of bytes to checksum
+ * Return: updated CRC
+ */
+uint32_t crc_slice32(const uint32_t tab[][256], uint32_t crc,
+		     const uint8_t *buf, size_t len);
+
+/**
+ * crc_slice16() - Update an MSB-first 16-bit CRC, eight bytes at a time
+ *
+ * This is used by crc16_ccitt() when CONFIG_CRC_SLICE_BY_8 is enabled
+ *
+ * @tab: Slicing tables for the polynomial, e.g. crc16_ccitt_slice_table
+ * @crc: CRC so far
+ * @buf: Bytes to checksum
+ * @len: Number of bytes to checksum
+ * Return: updated CRC
  */
-uint32_t crc32c_cal(uint32_t crc, const char *data, int length,
-		    uint32_t *crc32c_table);
+uint16_t crc_slice16(const uint16_t tab[][256], uint16_t crc,
+		     const uint8_t *buf, size_t len);
 
 #endif /* _UBOOT_CRC_H */
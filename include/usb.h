@@ -271,6 +271,28 @@ int usb_kbd_deregister(int force);
  */
 int usb_init(void);
 
+/*
+ * usb_init_start() - start initialising the USB controllers
+ *
+ * This probes the controllers and, with CONFIG_USB_SCAN_PARALLEL, powers on
+ * the ports of their root hubs, but does not wait for devices to appear. The
+ * caller can do other things and then call usb_init_finish(), or usb_init(),
+ * to find the devices. Until then, USB is not considered to be started.
+ *
+ * Returns: 0 if OK (also if already pending), -ENOENT if there are no USB
+ * controllers
+ */
+int usb_init_start(void);
+
+/*
+ * usb_init_finish() - finish initialising the USB controllers
+ *
+ * This scans the buses started by usb_init_start() for devices
+ *
+ * Returns: 0 if OK, -ENOENT if there are no USB devices
+ */
+int usb_init_finish(void);
+
 int usb_stop(void); /* stop the USB Controller */
 int usb_detect_change(void); /* detect if a USB device has been (un)plugged */
 
@@ -668,11 +690,14 @@ struct usb_dev_plat {
  *		so this will be false.
  * @companion:  True if this is a companion controller to another USB
  *		controller
+ * @scan_err:	Result of scanning the bus for devices, kept until all buses
+ *		which are scanned together have finished
  */
 struct usb_bus_priv {
 	int next_addr;
 	bool desc_before_addr;
 	bool companion;
+	int scan_err;
 };
 
 /**
@@ -853,6 +878,33 @@ bool usb_hub_is_root_hub(struct udevice *hub);
  */
 int usb_hub_scan(struct udevice *hub);
 
+/**
+ * usb_hub_scan_start() - Start collecting hub ports to scan together
+ *
+ * Until usb_hub_scan_finish() is called, hubs which are probed add their ports
+ * to the list of ports to scan, but do not scan them. This allows the ports on
+ * several buses to be powered on, debounced and reset at the same time.
+ */
+void usb_hub_scan_start(void);
+
+/**
+ * usb_hub_scan_finish() - Scan all hub ports collected since the start
+ *
+ * This returns once all devices on the ports, including any further hubs, have
+ * been found and set up
+ *
+ * Return: 0 if OK, -ve on error
+ */
+int usb_hub_scan_finish(void);
+
+/**
+ * usb_hub_scan_abort() - Drop all hub ports collected since the start
+ *
+ * This is used when the USB stack is stopped before the scan is finished, so
+ * that nothing refers to the hubs which are about to be removed
+ */
+void usb_hub_scan_abort(void);
+
 /**
  * usb_scan_device() - Scan a device on a bus
  *
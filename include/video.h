@@ -73,6 +73,23 @@ enum video_format {
 	VIDEO_X2R10G10B10,
 };
 
+/**
+ * struct video_bbox - A rectangle within the frame buffer
+ *
+ * The rectangle is empty if @x1 <= @x0 or @y1 <= @y0
+ *
+ * @x0: X start position in pixels from the left
+ * @y0: Y start position in pixels from the top
+ * @x1: X end position in pixels from the left (exclusive)
+ * @y1: Y end position in pixels from the top (exclusive)
+ */
+struct video_bbox {
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+};
+
 /**
  * struct video_priv - Device information used by the video uclass
  *
@@ -97,6 +114,13 @@ enum video_format {
  *		the LCD is updated
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
+ * @damage:	Area of the frame buffer changed since the last video_sync().
+ *		This and the following fields are only used with
+ *		CONFIG_VIDEO_DAMAGE
+ * @sync_count:	Number of times video_sync() has flushed changes
+ * @sync_bytes:	Total number of frame-buffer bytes flushed by video_sync()
+ * @last_sync_bytes:	Number of bytes flushed the last time video_sync()
+ *		found changes
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -121,6 +145,10 @@ struct video_priv {
 	bool flush_dcache;
 	u8 fg_col_idx;
 	u8 bg_col_idx;
+	struct video_bbox damage;
+	uint sync_count;
+	ulong sync_bytes;
+	ulong last_sync_bytes;
 };
 
 /**
@@ -247,6 +275,69 @@ int video_fill(struct udevice *dev, u32 colour);
 int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 		    int yend, u32 colour);
 
+/**
+ * video_fill_pixels() - Set a run of pixels to a colour
+ *
+ * @dst:	Place in the frame buffer to start
+ * @bpix:	Frame buffer bits per pixel
+ * @colour:	Value to write, in the frame buffer's format
+ * @count:	Number of pixels to write
+ */
+void video_fill_pixels(void *dst, enum video_log2_bpp bpix, u32 colour,
+		       int count);
+
+/**
+ * video_move_pixels() - Copy part of the frame buffer to somewhere else in it
+ *
+ * This is memmove() for the frame buffer, e.g. for scrolling. Unlike the
+ * generic memmove() it copies a word at a time when the areas overlap and
+ * @dst comes after @src.
+ *
+ * @dst:	Destination address
+ * @src:	Source address
+ * @size:	Number of bytes to copy
+ */
+void video_move_pixels(void *dst, const void *src, size_t size);
+
+/**
+ * video_conv_lut8() - Write a run of 8-bit pixels using a colour table
+ *
+ * @dst:	Place in the frame buffer to start
+ * @bpix:	Frame buffer bits per pixel
+ * @src:	Pixel values to look up in @lut
+ * @lut:	Value to write for each possible pixel value, in the frame
+ *		buffer's format. This is not used with an 8bpp frame buffer,
+ *		where @src is copied unchanged
+ * @count:	Number of pixels to write
+ */
+void video_conv_lut8(void *dst, enum video_log2_bpp bpix, const u8 *src,
+		     const u32 *lut, int count);
+
+/**
+ * video_conv_bgr24() - Write a run of 24-bit pixels, as used by BMP files
+ *
+ * @dst:	Place in the frame buffer to start
+ * @bpix:	Frame buffer bits per pixel (VIDEO_BPP16 or VIDEO_BPP32)
+ * @format:	Frame buffer pixel format
+ * @src:	Pixels to write, three bytes each in the order blue, green, red
+ * @count:	Number of pixels to write
+ */
+void video_conv_bgr24(void *dst, enum video_log2_bpp bpix,
+		      enum video_format format, const u8 *src, int count);
+
+/**
+ * video_conv_bgra32() - Write a run of 32-bit pixels, as used by BMP files
+ *
+ * @dst:	Place in the frame buffer to start
+ * @bpix:	Frame buffer bits per pixel (only VIDEO_BPP32 is supported)
+ * @format:	Frame buffer pixel format
+ * @src:	Pixels to write, four bytes each in the order blue, green, red,
+ *		alpha
+ * @count:	Number of pixels to write
+ */
+void video_conv_bgra32(void *dst, enum video_log2_bpp bpix,
+		       enum video_format format, const u8 *src, int count);
+
 /**
  * video_sync() - Sync a device's frame buffer with its hardware
  *
@@ -262,6 +353,28 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
  */
 int video_sync(struct udevice *vid, bool force);
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/**
+ * video_damage() - Record that part of the frame buffer has changed
+ *
+ * With CONFIG_VIDEO_DAMAGE, video_sync() only copies and flushes the area of
+ * the frame buffer which changed since the last sync, so anything which writes
+ * to the frame buffer must call this. The rectangle is clipped to the display.
+ *
+ * @vid:	Video device which was updated
+ * @x:		X position of the changed area in pixels from the left
+ * @y:		Y position of the changed area in pixels from the top
+ * @width:	Width of the changed area in pixels
+ * @height:	Height of the changed area in pixels
+ */
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+#else
+static inline void video_damage(struct udevice *vid, int x, int y, int width,
+				int height)
+{
+}
+#endif
+
 /**
  * video_sync_all() - Sync all devices' frame buffers with their hardware
  *
@@ -348,6 +461,9 @@ int video_default_font_height(struct udevice *dev);
  * This ensures that the copy framebuffer has the same data as the framebuffer
  * for a particular region. It should be called after the framebuffer is updated
  *
+ * With CONFIG_VIDEO_DAMAGE this does nothing, since the copy is made by
+ * video_sync() for the area passed to video_damage().
+ *
  * @from and @to can be in either order. The region between them is synced.
  *
  * @dev: Vidconsole device being updated
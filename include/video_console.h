@@ -529,6 +529,20 @@ void vidconsole_list_fonts(struct udevice *dev);
  */
 int vidconsole_get_font_size(struct udevice *dev, const char **name, uint *sizep);
 
+/**
+ * console_truetype_glyph_stats() - get statistics for the TrueType glyph cache
+ *
+ * Characters which are found in the cache count as hits. Others count as
+ * misses, whether or not they can then be added to the cache.
+ *
+ * @dev: TrueType vidconsole device
+ * @hitsp: Returns the number of characters drawn from the cache
+ * @missesp: Returns the number of characters which had to be rendered
+ * @usedp: Returns the number of bytes of memory used by the cache
+ */
+void console_truetype_glyph_stats(struct udevice *dev, uint *hitsp,
+				  uint *missesp, uint *usedp);
+
 #ifdef CONFIG_VIDEO_COPY
 /**
  * vidconsole_sync_copy() - Sync back to the copy framebuffer
@@ -563,8 +577,6 @@ int vidconsole_memmove(struct udevice *dev, void *dst, const void *src,
 		       int size);
 #else
 
-#include <string.h>
-
 static inline int vidconsole_sync_copy(struct udevice *dev, void *from,
 				       void *to)
 {
@@ -574,7 +586,7 @@ static inline int vidconsole_sync_copy(struct udevice *dev, void *from,
 static inline int vidconsole_memmove(struct udevice *dev, void *dst,
 				     const void *src, int size)
 {
-	memmove(dst, src, size);
+	video_move_pixels(dst, src, size);
 
 	return 0;
 }
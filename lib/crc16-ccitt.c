@@ -27,6 +27,12 @@
 #endif
 #include <u-boot/crc.h>
 
+#ifndef USE_HOSTCC
+#define CRC16_SLICE	CONFIG_IS_ENABLED(CRC_SLICE_BY_8)
+#else
+#define CRC16_SLICE	0
+#endif
+
 /* Table of CRC constants - implements x^16+x^12+x^5+1 */
 static const uint16_t crc16_tab[] = {
 	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
@@ -65,6 +71,9 @@ static const uint16_t crc16_tab[] = {
 
 uint16_t crc16_ccitt(uint16_t cksum, const unsigned char *buf, int len)
 {
+	if (CRC16_SLICE && len > 0)
+		return crc_slice16(crc16_ccitt_slice_table, cksum, buf, len);
+
 	for (int i = 0;  i < len;  i++)
 		cksum = crc16_tab[((cksum>>8) ^ *buf++) & 0xff] ^ (cksum << 8);
 
@@ -29,7 +29,15 @@
 
 #define tole(x) cpu_to_le32(x)
 
-#ifdef CONFIG_DYNAMIC_CRC_TABLE
+#if !defined(USE_HOSTCC) && !defined(CONFIG_ARM64_CRC32)
+#define CRC32_SLICE	CONFIG_IS_ENABLED(CRC_SLICE_BY_8)
+#else
+#define CRC32_SLICE	0
+#endif
+
+#if CRC32_SLICE
+/* crc_slice32() uses crc32_slice_table instead */
+#elif defined(CONFIG_DYNAMIC_CRC_TABLE)
 
 static int __efi_runtime_data crc_table_empty = 1;
 static uint32_t __efi_runtime_data crc_table[256];
@@ -183,10 +191,16 @@ const uint32_t * ZEXPORT get_crc_table()
 uint32_t __efi_runtime crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 {
 #ifdef CONFIG_ARM64_CRC32
-    crc = cpu_to_le32(crc);
+    /* Align, then use the 64-bit instruction for most of the buffer */
+    for (; len && ((long)buf) & 7; len--)
+        crc = __builtin_aarch64_crc32b(crc, *buf++);
+    for (; len >= 8; len -= 8, buf += 8)
+        crc = __builtin_aarch64_crc32x(crc, le64_to_cpu(*(const uint64_t *)buf));
     while (len--)
         crc = __builtin_aarch64_crc32b(crc, *buf++);
-    return le32_to_cpu(crc);
+    return crc;
+#elif CRC32_SLICE
+    return crc_slice32(crc32_slice_table, crc, buf, len);
 #else
     const uint32_t *tab = crc_table;
     const uint32_t *b =(const uint32_t *)buf;
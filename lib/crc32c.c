@@ -11,27 +11,56 @@
  */
 
 #include <compiler.h>
+#include <u-boot/crc.h>
+#include <linux/kernel.h>
 
-uint32_t crc32c_cal(uint32_t crc, const char *data, int length,
-		    uint32_t *crc32c_table)
+#define CRC32C_POLY_LE	0x82f63b78
+
+#ifdef CONFIG_ARM64_CRC32
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len)
 {
-	while (length--)
-		crc = crc32c_table[(u8)(crc ^ *data++)] ^ (crc >> 8);
+	const uint8_t *p = buf;
+
+	for (; len && !IS_ALIGNED((ulong)p, sizeof(u64)); len--)
+		crc = __builtin_aarch64_crc32cb(crc, *p++);
+	for (; len >= sizeof(u64); len -= sizeof(u64), p += sizeof(u64))
+		crc = __builtin_aarch64_crc32cx(crc, le64_to_cpu(*(const u64 *)p));
+	while (len--)
+		crc = __builtin_aarch64_crc32cb(crc, *p++);
 
 	return crc;
 }
+#elif CONFIG_IS_ENABLED(CRC_SLICE_BY_8)
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len)
+{
+	return crc_slice32(crc32c_slice_table, crc, buf, len);
+}
+#else
+static uint32_t crc32c_table[256];
 
-void crc32c_init(uint32_t *crc32c_table, uint32_t pol)
+static void crc32c_init(void)
 {
 	int i, j;
 	uint32_t v;
-	const uint32_t poly = pol; /* Bit-reflected CRC32C polynomial */
 
 	for (i = 0; i < 256; i++) {
 		v = i;
 		for (j = 0; j < 8; j++)
-			v = (v >> 1) ^ ((v & 1) ? poly : 0);
+			v = (v >> 1) ^ ((v & 1) ? CRC32C_POLY_LE : 0);
 
 		crc32c_table[i] = v;
 	}
 }
+
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+
+	if (!crc32c_table[1])
+		crc32c_init();
+	while (len--)
+		crc = crc32c_table[(u8)(crc ^ *p++)] ^ (crc >> 8);
+
+	return crc;
+}
+#endif
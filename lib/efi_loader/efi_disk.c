@@ -18,6 +18,7 @@
 #include <log.h>
 #include <part.h>
 #include <malloc.h>
+#include <asm/cache.h>
 
 struct efi_system_partition efi_system_partition = {
 	.uclass_id = UCLASS_INVALID,
@@ -97,6 +98,77 @@ enum efi_disk_direction {
 	EFI_DISK_WRITE,
 };
 
+/* Size of the read-ahead area, 0 if disabled */
+#define READ_AHEAD_SIZE	IF_ENABLED_INT(CONFIG_BLOCK_CACHE, \
+				       CONFIG_EFI_DISK_READ_AHEAD)
+
+/* Buffer for read-ahead, READ_AHEAD_SIZE bytes */
+static void *efi_disk_read_ahead_buf;
+
+/**
+ * efi_disk_read_ahead() - read a few blocks using read-ahead
+ *
+ * Small reads are served from the block cache. On a miss, the aligned
+ * CONFIG_EFI_DISK_READ_AHEAD-sized area around the blocks is read instead,
+ * which leaves it in the block cache for the following reads. The block cache
+ * is invalidated on writes, so this never returns stale data.
+ *
+ * @dev:	block device or partition
+ * @lba:	first block to read
+ * @blocks:	number of blocks to read
+ * @buffer:	destination buffer
+ * Return:	true if the blocks were read, false if the read must be done
+ *		directly
+ */
+static bool efi_disk_read_ahead(struct udevice *dev, lbaint_t lba,
+				lbaint_t blocks, void *buffer)
+{
+	struct blk_desc *desc;
+	lbaint_t start, end, limit, window;
+
+	if (!IS_ENABLED(CONFIG_BLOCK_CACHE) || !READ_AHEAD_SIZE)
+		return false;
+
+	if (CONFIG_IS_ENABLED(PARTITIONS) &&
+	    device_get_uclass_id(dev) == UCLASS_PARTITION) {
+		struct disk_part *part = dev_get_uclass_plat(dev);
+
+		lba += part->gpt_part_info.start;
+		limit = part->gpt_part_info.start + part->gpt_part_info.size;
+		dev = dev_get_parent(dev);
+		desc = dev_get_uclass_plat(dev);
+	} else {
+		desc = dev_get_uclass_plat(dev);
+		limit = desc->lba;
+	}
+
+	window = READ_AHEAD_SIZE / desc->blksz;
+	if (blocks >= window || window > blkcache_max_blocks())
+		return false;
+	if (blkcache_read(desc->uclass_id, desc->devnum, lba, blocks,
+			  desc->blksz, buffer))
+		return true;
+
+	start = ALIGN_DOWN(lba, window);
+	end = min(start + window, limit);
+	if (lba + blocks > end)
+		return false;
+
+	if (!efi_disk_read_ahead_buf) {
+		efi_disk_read_ahead_buf = memalign(ARCH_DMA_MINALIGN,
+						   READ_AHEAD_SIZE);
+		if (!efi_disk_read_ahead_buf)
+			return false;
+	}
+	if (blk_dread(desc, start, end - start, efi_disk_read_ahead_buf) !=
+	    end - start)
+		return false;
+	memcpy(buffer, efi_disk_read_ahead_buf + (lba - start) * desc->blksz,
+	       blocks * desc->blksz);
+
+	return true;
+}
+
 static efi_status_t efi_disk_rw_blocks(struct efi_block_io *this,
 			u32 media_id, u64 lba, unsigned long buffer_size,
 			void *buffer, enum efi_disk_direction direction)
@@ -117,7 +189,10 @@ static efi_status_t efi_disk_rw_blocks(struct efi_block_io *this,
 	if (buffer_size & (blksz - 1))
 		return EFI_BAD_BUFFER_SIZE;
 
-	if (CONFIG_IS_ENABLED(PARTITIONS) &&
+	if (direction == EFI_DISK_READ &&
+	    efi_disk_read_ahead(diskobj->header.dev, lba, blocks, buffer)) {
+		n = blocks;
+	} else if (CONFIG_IS_ENABLED(PARTITIONS) &&
 	    device_get_uclass_id(diskobj->header.dev) == UCLASS_PARTITION) {
 		if (direction == EFI_DISK_READ)
 			n = disk_blk_read(diskobj->header.dev, lba, blocks,
@@ -839,6 +914,10 @@ efi_status_t efi_disks_register(void)
 {
 	struct udevice *dev;
 
+	/* Let the block cache hold a read-ahead area of 512-byte blocks */
+	if (IS_ENABLED(CONFIG_BLOCK_CACHE) && READ_AHEAD_SIZE)
+		blkcache_grow(READ_AHEAD_SIZE / 512);
+
 	uclass_foreach_dev_probe(UCLASS_BLK, dev) {
 	}
 
@@ -35,6 +35,7 @@ struct efi_gop_obj {
 	/* Fields we only have access to during init */
 	u32 bpix;
 	void *fb;
+	struct udevice *vdev;
 };
 
 static efi_status_t EFIAPI gop_query_mode(struct efi_gop *this, u32 mode_number,
@@ -451,6 +452,18 @@ static efi_status_t EFIAPI gop_blt(struct efi_gop *this,
 	if (ret != EFI_SUCCESS)
 		return EFI_EXIT(ret);
 
+	/*
+	 * Applications may also write to the frame buffer directly, so flush
+	 * all of it. With CONFIG_VIDEO_COPY the hardware frame buffer is being
+	 * drawn on, so there is nothing to copy to it.
+	 */
+	if (!IS_ENABLED(CONFIG_VIDEO_COPY)) {
+		struct efi_gop_obj *gopobj;
+
+		gopobj = container_of(this, struct efi_gop_obj, ops);
+		video_damage(gopobj->vdev, 0, 0, gopobj->info.width,
+			     gopobj->info.height);
+	}
 	video_sync_all();
 
 	return EFI_EXIT(EFI_SUCCESS);
@@ -549,6 +562,7 @@ efi_status_t efi_gop_register(void)
 	gopobj->info.pixels_per_scanline = col;
 	gopobj->bpix = bpix;
 	gopobj->fb = map_sysmem(fb_base, fb_size);
+	gopobj->vdev = vdev;
 
 	return EFI_SUCCESS;
 }
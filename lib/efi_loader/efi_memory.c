@@ -16,7 +16,7 @@
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/sections.h>
-#include <linux/list_sort.h>
+#include <linux/rbtree.h>
 #include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -26,18 +26,44 @@ DECLARE_GLOBAL_DATA_PTR;
 
 efi_uintn_t efi_memory_map_key;
 
+/**
+ * struct efi_mem_list - memory map item
+ *
+ * @node:	node in efi_mem, sorted by physical start address
+ * @desc:	memory descriptor
+ */
 struct efi_mem_list {
-	struct list_head link;
+	struct rb_node node;
 	struct efi_mem_desc desc;
 };
 
-#define EFI_CARVE_NO_OVERLAP		-1
-#define EFI_CARVE_LOOP_AGAIN		-2
-#define EFI_CARVE_OVERLAPS_NONRAM	-3
-#define EFI_CARVE_OUT_OF_RESOURCES	-4
+/*
+ * This tree contains all memory map items. They never overlap and adjacent
+ * items with the same type and attributes are merged.
+ */
+static struct rb_root efi_mem = RB_ROOT;
 
-/* This list contains all memory map items */
-static LIST_HEAD(efi_mem);
+/* Number of items in efi_mem */
+static efi_uintn_t efi_mem_count;
+
+/**
+ * struct efi_mem_map_cache - copy of the memory map as an array
+ *
+ * efi_get_memory_map() is typically called several times in a row, e.g. to
+ * learn the size, then to read the map. The array is only rebuilt when
+ * efi_memory_map_key changes.
+ *
+ * @map:	descriptors in ascending address order, or NULL
+ * @count:	number of descriptors in @map
+ * @max:	number of descriptors allocated for @map
+ * @key:	value of efi_memory_map_key when @map was built
+ */
+static struct efi_mem_map_cache {
+	struct efi_mem_desc *map;
+	efi_uintn_t count;
+	efi_uintn_t max;
+	efi_uintn_t key;
+} efi_mem_map_cache;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 void *efi_bounce_buffer;
@@ -82,33 +108,6 @@ static u64 checksum(struct efi_pool_allocation *alloc)
 	return ret;
 }
 
-/**
- * efi_mem_cmp() - comparator function for sorting memory map
- *
- * Sorts the memory list from highest address to lowest address
- *
- * When allocating memory we should always start from the highest
- * address chunk, so sort the memory list such that the first list
- * iterator gets the highest address and goes lower from there.
- *
- * @priv:	unused
- * @a:		first memory area
- * @b:		second memory area
- * Return:	1 if @a is before @b, -1 if @b is before @a, 0 if equal
- */
-static int efi_mem_cmp(void *priv, struct list_head *a, struct list_head *b)
-{
-	struct efi_mem_list *mema = list_entry(a, struct efi_mem_list, link);
-	struct efi_mem_list *memb = list_entry(b, struct efi_mem_list, link);
-
-	if (mema->desc.physical_start == memb->desc.physical_start)
-		return 0;
-	else if (mema->desc.physical_start < memb->desc.physical_start)
-		return 1;
-	else
-		return -1;
-}
-
 /**
  * desc_get_end() - get end address of memory area
  *
@@ -120,139 +119,146 @@ static uint64_t desc_get_end(struct efi_mem_desc *desc)
 	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
 }
 
+static struct efi_mem_list *efi_mem_entry(struct rb_node *node)
+{
+	return rb_entry_safe(node, struct efi_mem_list, node);
+}
+
 /**
- * efi_mem_sort() - sort memory map
+ * efi_mem_find_below() - find the memory map item starting below an address
  *
- * Sort the memory map and then try to merge adjacent memory areas.
+ * @addr:	address
+ * Return:	item with the highest start address below @addr, or NULL
  */
-static void efi_mem_sort(void)
+static struct efi_mem_list *efi_mem_find_below(u64 addr)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *prevmem = NULL;
-	bool merge_again = true;
-
-	list_sort(NULL, &efi_mem, efi_mem_cmp);
-
-	/* Now merge entries that can be merged */
-	while (merge_again) {
-		merge_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			struct efi_mem_desc *prev = &prevmem->desc;
-			struct efi_mem_desc *cur;
-			uint64_t pages;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			if (!prevmem) {
-				prevmem = lmem;
-				continue;
-			}
+	struct rb_node *node = efi_mem.rb_node;
+	struct efi_mem_list *found = NULL;
 
-			cur = &lmem->desc;
-
-			if ((desc_get_end(cur) == prev->physical_start) &&
-			    (prev->type == cur->type) &&
-			    (prev->attribute == cur->attribute)) {
-				/* There is an existing map before, reuse it */
-				pages = cur->num_pages;
-				prev->num_pages += pages;
-				prev->physical_start -= pages << EFI_PAGE_SHIFT;
-				prev->virtual_start -= pages << EFI_PAGE_SHIFT;
-				list_del(&lmem->link);
-				free(lmem);
-
-				merge_again = true;
-				break;
-			}
+	while (node) {
+		struct efi_mem_list *mem = efi_mem_entry(node);
 
-			prevmem = lmem;
+		if (mem->desc.physical_start < addr) {
+			found = mem;
+			node = node->rb_right;
+		} else {
+			node = node->rb_left;
 		}
 	}
+
+	return found;
+}
+
+/**
+ * efi_mem_insert() - add an item to the memory map tree
+ *
+ * @new:	item to add, which must not overlap any other item
+ */
+static void efi_mem_insert(struct efi_mem_list *new)
+{
+	struct rb_node **link = &efi_mem.rb_node, *parent = NULL;
+
+	while (*link) {
+		parent = *link;
+		if (new->desc.physical_start <
+		    efi_mem_entry(parent)->desc.physical_start)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&new->node, parent, link);
+	rb_insert_color(&new->node, &efi_mem);
+	efi_mem_count++;
+}
+
+/**
+ * efi_mem_remove() - remove an item from the memory map tree and free it
+ *
+ * @mem:	item to remove
+ */
+static void efi_mem_remove(struct efi_mem_list *mem)
+{
+	rb_erase(&mem->node, &efi_mem);
+	efi_mem_count--;
+	free(mem);
+}
+
+/**
+ * efi_mem_can_merge() - check if two memory areas can be merged
+ *
+ * @low:	lower memory area
+ * @high:	higher memory area
+ * Return:	true if @high starts where @low ends and they have the same
+ *		type and attributes
+ */
+static bool efi_mem_can_merge(struct efi_mem_list *low,
+			      struct efi_mem_list *high)
+{
+	return low && high &&
+	       desc_get_end(&low->desc) == high->desc.physical_start &&
+	       low->desc.type == high->desc.type &&
+	       low->desc.attribute == high->desc.attribute;
 }
 
 /**
  * efi_mem_carve_out() - unmap memory region
  *
- * @map:		memory map
- * @carve_desc:		memory region to unmap
- * @overlap_only_ram:	the carved out region may only overlap RAM
- * Return:		the number of overlapping pages which have been
- *			removed from the map,
- *			EFI_CARVE_NO_OVERLAP, if the regions don't overlap,
- *			EFI_CARVE_OVERLAPS_NONRAM, if the carve and map overlap,
- *			and the map contains anything but free ram
- *			(only when overlap_only_ram is true),
- *			EFI_CARVE_LOOP_AGAIN, if the mapping list should be
- *			traversed again, as it has been altered.
- *
- * Unmaps all memory occupied by the carve_desc region from the list entry
- * pointed to by map.
- *
- * In case of EFI_CARVE_OVERLAPS_NONRAM it is the callers responsibility
- * to re-add the already carved out pages to the mapping.
+ * Unmaps all memory in [@carve_start, @carve_end) from the map. Only the
+ * items overlapping the region are visited. At most one item is split in two,
+ * which needs @split.
+ *
+ * @first:		highest item overlapping the region
+ * @carve_start:	start of the region to unmap
+ * @carve_end:		end of the region to unmap
+ * @split:		spare item, used if an item is split
+ * Return:		true if @split was used
  */
-static s64 efi_mem_carve_out(struct efi_mem_list *map,
-			     struct efi_mem_desc *carve_desc,
-			     bool overlap_only_ram)
+static bool efi_mem_carve_out(struct efi_mem_list *first, u64 carve_start,
+			      u64 carve_end, struct efi_mem_list *split)
 {
-	struct efi_mem_list *newmap;
-	struct efi_mem_desc *map_desc = &map->desc;
-	uint64_t map_start = map_desc->physical_start;
-	uint64_t map_end = map_start + (map_desc->num_pages << EFI_PAGE_SHIFT);
-	uint64_t carve_start = carve_desc->physical_start;
-	uint64_t carve_end = carve_start +
-			     (carve_desc->num_pages << EFI_PAGE_SHIFT);
-
-	/* check whether we're overlapping */
-	if ((carve_end <= map_start) || (carve_start >= map_end))
-		return EFI_CARVE_NO_OVERLAP;
-
-	/* We're overlapping with non-RAM, warn the caller if desired */
-	if (overlap_only_ram && (map_desc->type != EFI_CONVENTIONAL_MEMORY))
-		return EFI_CARVE_OVERLAPS_NONRAM;
-
-	/* Sanitize carve_start and carve_end to lie within our bounds */
-	carve_start = max(carve_start, map_start);
-	carve_end = min(carve_end, map_end);
-
-	/* Carving at the beginning of our map? Just move it! */
-	if (carve_start == map_start) {
-		if (map_end == carve_end) {
+	struct efi_mem_list *mem, *next;
+	bool used = false;
+
+	for (mem = first; mem; mem = next) {
+		struct efi_mem_desc *desc = &mem->desc;
+		u64 map_start = desc->physical_start;
+		u64 map_end = desc_get_end(desc);
+
+		if (map_end <= carve_start)
+			break;
+		next = efi_mem_entry(rb_prev(&mem->node));
+
+		if (carve_start <= map_start && map_end <= carve_end) {
 			/* Full overlap, just remove map */
-			list_del(&map->link);
-			free(map);
+			efi_mem_remove(mem);
+		} else if (carve_start <= map_start) {
+			/* Carving at the beginning of our map, just move it */
+			desc->physical_start = carve_end;
+			desc->virtual_start = carve_end;
+			desc->num_pages = (map_end - carve_end) >>
+					  EFI_PAGE_SHIFT;
+		} else if (map_end <= carve_end) {
+			/* Carving at the end of our map, just shrink it */
+			desc->num_pages = (carve_start - map_start) >>
+					  EFI_PAGE_SHIFT;
 		} else {
-			map->desc.physical_start = carve_end;
-			map->desc.virtual_start = carve_end;
-			map->desc.num_pages = (map_end - carve_end)
-					      >> EFI_PAGE_SHIFT;
+			/*
+			 * Split the map:
+			 * [ map_desc |__carve__| split ]
+			 */
+			split->desc = *desc;
+			split->desc.physical_start = carve_end;
+			split->desc.virtual_start = carve_end;
+			split->desc.num_pages = (map_end - carve_end) >>
+						EFI_PAGE_SHIFT;
+			desc->num_pages = (carve_start - map_start) >>
+					  EFI_PAGE_SHIFT;
+			efi_mem_insert(split);
+			used = true;
 		}
-
-		return (carve_end - carve_start) >> EFI_PAGE_SHIFT;
 	}
 
-	/*
-	 * Overlapping maps, just split the list map at carve_start,
-	 * it will get moved or removed in the next iteration.
-	 *
-	 * [ map_desc |__carve_start__| newmap ]
-	 */
-
-	/* Create a new map from [ carve_start ... map_end ] */
-	newmap = calloc(1, sizeof(*newmap));
-	if (!newmap)
-		return EFI_CARVE_OUT_OF_RESOURCES;
-	newmap->desc = map->desc;
-	newmap->desc.physical_start = carve_start;
-	newmap->desc.virtual_start = carve_start;
-	newmap->desc.num_pages = (map_end - carve_start) >> EFI_PAGE_SHIFT;
-	/* Insert before current entry (descending address order) */
-	list_add_tail(&newmap->link, &map->link);
-
-	/* Shrink the map to [ map_start ... carve_start ] */
-	map_desc->num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
-
-	return EFI_CARVE_LOOP_AGAIN;
+	return used;
 }
 
 /**
@@ -268,11 +274,10 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 					  int memory_type,
 					  bool overlap_only_ram)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *newlist;
-	bool carve_again;
+	struct efi_mem_list *newlist, *first, *mem, *split = NULL;
 	uint64_t carved_pages = 0;
 	struct efi_event *evt;
+	u64 end;
 
 	EFI_PRINT("%s: 0x%llx 0x%llx %d %s\n", __func__,
 		  start, pages, memory_type, overlap_only_ram ? "yes" : "no");
@@ -291,6 +296,7 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 	newlist->desc.physical_start = start;
 	newlist->desc.virtual_start = start;
 	newlist->desc.num_pages = pages;
+	end = desc_get_end(&newlist->desc);
 
 	switch (memory_type) {
 	case EFI_RUNTIME_SERVICES_CODE:
@@ -305,50 +311,35 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 		break;
 	}
 
-	/* Add our new map */
-	do {
-		carve_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			s64 r;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			r = efi_mem_carve_out(lmem, &newlist->desc,
-					      overlap_only_ram);
-			switch (r) {
-			case EFI_CARVE_OUT_OF_RESOURCES:
+	/*
+	 * Check the items overlapping the new map before changing anything, so
+	 * that the map is left alone on error.
+	 */
+	first = efi_mem_find_below(end);
+	for (mem = first; mem && desc_get_end(&mem->desc) > start;
+	     mem = efi_mem_entry(rb_prev(&mem->node))) {
+		u64 map_start = mem->desc.physical_start;
+		u64 map_end = desc_get_end(&mem->desc);
+
+		/*
+		 * The user requested to only have RAM overlaps, but we hit a
+		 * non-RAM region. Error out.
+		 */
+		if (overlap_only_ram &&
+		    mem->desc.type != EFI_CONVENTIONAL_MEMORY) {
+			free(newlist);
+			return EFI_NO_MAPPING;
+		}
+		carved_pages += (min(map_end, end) - max(map_start, start)) >>
+				EFI_PAGE_SHIFT;
+		if (map_start < start && end < map_end) {
+			split = calloc(1, sizeof(*split));
+			if (!split) {
 				free(newlist);
 				return EFI_OUT_OF_RESOURCES;
-			case EFI_CARVE_OVERLAPS_NONRAM:
-				/*
-				 * The user requested to only have RAM overlaps,
-				 * but we hit a non-RAM region. Error out.
-				 */
-				free(newlist);
-				return EFI_NO_MAPPING;
-			case EFI_CARVE_NO_OVERLAP:
-				/* Just ignore this list entry */
-				break;
-			case EFI_CARVE_LOOP_AGAIN:
-				/*
-				 * We split an entry, but need to loop through
-				 * the list again to actually carve it.
-				 */
-				carve_again = true;
-				break;
-			default:
-				/* We carved a number of pages */
-				carved_pages += r;
-				carve_again = true;
-				break;
-			}
-
-			if (carve_again) {
-				/* The list changed, we need to start over */
-				break;
 			}
 		}
-	} while (carve_again);
+	}
 
 	if (overlap_only_ram && (carved_pages != pages)) {
 		/*
@@ -359,11 +350,23 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 		return EFI_NO_MAPPING;
 	}
 
-	/* Add our new map */
-        list_add_tail(&newlist->link, &efi_mem);
-
-	/* And make sure memory is listed in descending order */
-	efi_mem_sort();
+	if (!first || !efi_mem_carve_out(first, start, end, split))
+		free(split);
+
+	/* Add our new map and merge it with its neighbours */
+	efi_mem_insert(newlist);
+	mem = efi_mem_entry(rb_prev(&newlist->node));
+	if (efi_mem_can_merge(mem, newlist)) {
+		newlist->desc.physical_start = mem->desc.physical_start;
+		newlist->desc.virtual_start = mem->desc.virtual_start;
+		newlist->desc.num_pages += mem->desc.num_pages;
+		efi_mem_remove(mem);
+	}
+	mem = efi_mem_entry(rb_next(&newlist->node));
+	if (efi_mem_can_merge(newlist, mem)) {
+		newlist->desc.num_pages += mem->desc.num_pages;
+		efi_mem_remove(mem);
+	}
 
 	/* Notify that the memory map was changed */
 	list_for_each_entry(evt, &efi_events, link) {
@@ -419,17 +422,13 @@ static efi_status_t efi_check_allocated(u64 addr, bool must_be_allocated)
 {
 	struct efi_mem_list *item;
 
-	list_for_each_entry(item, &efi_mem, link) {
-		u64 start = item->desc.physical_start;
-		u64 end = start + (item->desc.num_pages << EFI_PAGE_SHIFT);
-
-		if (addr >= start && addr < end) {
-			if (must_be_allocated ^
-			    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
-				return EFI_SUCCESS;
-			else
-				return EFI_NOT_FOUND;
-		}
+	item = efi_mem_find_below(addr + 1);
+	if (item && addr < desc_get_end(&item->desc)) {
+		if (must_be_allocated ^
+		    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
+			return EFI_SUCCESS;
+		else
+			return EFI_NOT_FOUND;
 	}
 
 	return EFI_NOT_FOUND;
@@ -444,7 +443,7 @@ static efi_status_t efi_check_allocated(u64 addr, bool must_be_allocated)
  */
 static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
 {
-	struct list_head *lhandle;
+	struct efi_mem_list *lmem;
 
 	/*
 	 * Prealign input max address, so we simplify our matching
@@ -452,9 +451,9 @@ static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
 	 */
 	max_addr &= ~EFI_PAGE_MASK;
 
-	list_for_each(lhandle, &efi_mem) {
-		struct efi_mem_list *lmem = list_entry(lhandle,
-			struct efi_mem_list, link);
+	/* Items starting at or above max_addr cannot be used */
+	for (lmem = efi_mem_find_below(max_addr); lmem;
+	     lmem = efi_mem_entry(rb_prev(&lmem->node))) {
 		struct efi_mem_desc *desc = &lmem->desc;
 		uint64_t desc_len = desc->num_pages << EFI_PAGE_SHIFT;
 		uint64_t desc_end = desc->physical_start + desc_len;
@@ -742,20 +741,17 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 				efi_uintn_t *descriptor_size,
 				uint32_t *descriptor_version)
 {
+	struct efi_mem_map_cache *cache = &efi_mem_map_cache;
 	efi_uintn_t map_size = 0;
-	int map_entries = 0;
-	struct list_head *lhandle;
 	efi_uintn_t provided_map_size;
+	struct efi_mem_list *lmem;
 
 	if (!memory_map_size)
 		return EFI_INVALID_PARAMETER;
 
 	provided_map_size = *memory_map_size;
 
-	list_for_each(lhandle, &efi_mem)
-		map_entries++;
-
-	map_size = map_entries * sizeof(struct efi_mem_desc);
+	map_size = efi_mem_count * sizeof(struct efi_mem_desc);
 
 	*memory_map_size = map_size;
 
@@ -771,15 +767,31 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 	if (!memory_map)
 		return EFI_INVALID_PARAMETER;
 
-	/* Copy list into array */
-	/* Return the list in ascending order */
-	memory_map = &memory_map[map_entries - 1];
-	list_for_each(lhandle, &efi_mem) {
-		struct efi_mem_list *lmem;
+	/* Rebuild the cached array if the map has changed since */
+	if (!cache->map || cache->key != efi_memory_map_key) {
+		if (cache->max < efi_mem_count) {
+			free(cache->map);
+			cache->max = efi_mem_count * 2;
+			cache->map = malloc(cache->max * sizeof(*cache->map));
+			if (!cache->map)
+				cache->max = 0;
+		}
+		if (cache->map) {
+			cache->count = 0;
+			for (lmem = efi_mem_entry(rb_first(&efi_mem)); lmem;
+			     lmem = efi_mem_entry(rb_next(&lmem->node)))
+				cache->map[cache->count++] = lmem->desc;
+			cache->key = efi_memory_map_key;
+		}
+	}
 
-		lmem = list_entry(lhandle, struct efi_mem_list, link);
-		*memory_map = lmem->desc;
-		memory_map--;
+	/* Return the map in ascending order */
+	if (cache->map) {
+		memcpy(memory_map, cache->map, map_size);
+	} else {
+		for (lmem = efi_mem_entry(rb_first(&efi_mem)); lmem;
+		     lmem = efi_mem_entry(rb_next(&lmem->node)))
+			*memory_map++ = lmem->desc;
 	}
 
 	if (map_key)
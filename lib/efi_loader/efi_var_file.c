@@ -25,6 +25,19 @@
 
 static const efi_guid_t shim_lock_guid = SHIM_LOCK_GUID;
 
+/* The log is always allowed to grow to this size before it is compacted */
+#define EFI_VAR_LOG_MIN_SIZE	0x1000
+
+/*
+ * Size and CRC32 of the variable file and size of the valid part of the log
+ * file, including its header, on the EFI system partition. A log length of -1
+ * means that the log file is in an unknown state and must be reset with the
+ * next write.
+ */
+static loff_t __maybe_unused efi_var_file_len;
+static u32 __maybe_unused efi_var_file_crc32;
+static loff_t __maybe_unused efi_var_log_len = -1;
+
 /**
  * efi_set_blk_dev_to_system_partition() - select EFI system partition
  *
@@ -77,8 +90,31 @@ efi_status_t efi_var_to_file(void)
 		goto error;
 
 	r = fs_write(EFI_VAR_FILE_NAME, map_to_sysmem(buf), 0, len, &actlen);
-	if (r || len != actlen)
+	if (r || len != actlen) {
 		ret = EFI_DEVICE_ERROR;
+		goto error;
+	}
+	efi_var_file_len = len;
+	efi_var_file_crc32 = buf->crc32;
+
+	/*
+	 * All changes in the log are part of the variable file now. If the log
+	 * cannot be cleared, it still names the old variable file and is
+	 * ignored when loading.
+	 */
+	if (IS_ENABLED(CONFIG_EFI_VARIABLE_FILE_LOG) && efi_var_log_len) {
+		efi_var_log_len = -1;
+		ret = efi_set_blk_dev_to_system_partition();
+		if (ret != EFI_SUCCESS)
+			goto error;
+		r = fs_write(EFI_VAR_LOG_NAME, map_to_sysmem(buf), 0, 0,
+			     &actlen);
+		if (r) {
+			ret = EFI_DEVICE_ERROR;
+			goto error;
+		}
+		efi_var_log_len = 0;
+	}
 
 error:
 	if (ret != EFI_SUCCESS)
@@ -90,6 +126,96 @@ error:
 #endif
 }
 
+efi_status_t efi_var_update_file(const u16 *name, const efi_guid_t *guid)
+{
+#ifdef CONFIG_EFI_VARIABLE_FILE_LOG
+	struct efi_var_entry *var;
+	struct efi_var_file *rec;
+	struct efi_var_log *hdr;
+	loff_t len, hdr_len, actlen;
+	efi_status_t ret;
+	void *buf;
+	int r;
+
+	var = efi_var_mem_find(guid, name, NULL);
+	len = sizeof(struct efi_var_file) +
+	      ALIGN(sizeof(struct efi_var_entry) +
+		    sizeof(u16) * (u16_strlen(name) + 1), 8);
+	if (var)
+		len = sizeof(struct efi_var_file) + efi_var_entry_len(var);
+
+	/* A new log starts with a header naming the variable file */
+	hdr_len = efi_var_log_len ? 0 : sizeof(*hdr);
+
+	/* Compact the log once it outgrows the variable file */
+	if (efi_var_log_len < 0 ||
+	    efi_var_log_len + hdr_len + len >
+	    max_t(loff_t, efi_var_file_len, EFI_VAR_LOG_MIN_SIZE))
+		return efi_var_to_file();
+
+	buf = calloc(1, hdr_len + len);
+	if (!buf)
+		return efi_var_to_file();
+	if (hdr_len) {
+		hdr = buf;
+		hdr->magic = EFI_VAR_LOG_MAGIC;
+		hdr->var_length = efi_var_file_len;
+		hdr->var_crc32 = efi_var_file_crc32;
+	}
+	rec = buf + hdr_len;
+	rec->magic = EFI_VAR_FILE_MAGIC;
+	rec->length = len;
+	if (var) {
+		memcpy(rec->var, var, efi_var_entry_len(var));
+	} else {
+		/* A deleted variable is logged with a length of zero */
+		rec->var->attr = EFI_VARIABLE_NON_VOLATILE;
+		guidcpy(&rec->var->guid, guid);
+		u16_strcpy(rec->var->name, name);
+	}
+	rec->crc32 = crc32(0, (u8 *)rec->var, len - sizeof(struct efi_var_file));
+
+	ret = efi_set_blk_dev_to_system_partition();
+	if (ret == EFI_SUCCESS) {
+		r = fs_write(EFI_VAR_LOG_NAME, map_to_sysmem(buf),
+			     efi_var_log_len, hdr_len + len, &actlen);
+		if (r || hdr_len + len != actlen)
+			ret = EFI_DEVICE_ERROR;
+	}
+	free(buf);
+	if (ret != EFI_SUCCESS) {
+		/* The tail of the log may be corrupted, start over */
+		efi_var_log_len = -1;
+		return efi_var_to_file();
+	}
+	efi_var_log_len += hdr_len + len;
+
+	return EFI_SUCCESS;
+#else
+	return efi_var_to_file();
+#endif
+}
+
+/**
+ * efi_var_restore_allowed() - check if a variable may be restored
+ *
+ * @var:	variable
+ * @safe:	restoring from tamper-resistant storage
+ * Return:	true if the variable may be restored
+ */
+static bool efi_var_restore_allowed(struct efi_var_entry *var, bool safe)
+{
+	/*
+	 * Secure boot related and volatile variables shall only be
+	 * restored from U-Boot's preseed.
+	 */
+	return safe ||
+	       (efi_auth_var_get_type(var->name, &var->guid) ==
+		EFI_AUTH_VAR_NONE &&
+		guidcmp(&var->guid, &shim_lock_guid) &&
+		(var->attr & EFI_VARIABLE_NON_VOLATILE));
+}
+
 efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 {
 	struct efi_var_entry *var, *last_var;
@@ -110,15 +236,7 @@ efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 
 		data = var->name + u16_strlen(var->name) + 1;
 
-		/*
-		 * Secure boot related and volatile variables shall only be
-		 * restored from U-Boot's preseed.
-		 */
-		if (!safe &&
-		    (efi_auth_var_get_type(var->name, &var->guid) !=
-		     EFI_AUTH_VAR_NONE ||
-		     !guidcmp(&var->guid, &shim_lock_guid) ||
-		     !(var->attr & EFI_VARIABLE_NON_VOLATILE)))
+		if (!efi_var_restore_allowed(var, safe))
 			continue;
 		if (!var->length)
 			continue;
@@ -133,6 +251,70 @@ efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 	return EFI_SUCCESS;
 }
 
+/**
+ * efi_var_log_restore() - apply the changes recorded in the log file
+ *
+ * The log is only applied if its header names the variable file which was
+ * loaded. Otherwise it was left over when the variable file was rewritten and
+ * holds changes which are already part of that file, or older values.
+ *
+ * Each record of the log consists of a header and a single variable. A
+ * variable without data has been deleted. Replay stops at the first record
+ * that is incomplete or has an incorrect CRC32, as it was being written when
+ * power was lost.
+ *
+ * @buf:	contents of the log file
+ * @len:	length of the log file
+ * Return:	length of the valid part of the log, -1 if it does not apply
+ */
+static __maybe_unused loff_t efi_var_log_restore(void *buf, loff_t len)
+{
+	struct efi_var_log *hdr = buf;
+	struct efi_var_entry *var, *old;
+	struct efi_var_file *rec;
+	efi_status_t ret;
+	loff_t pos;
+
+	if (len < sizeof(*hdr) || hdr->magic != EFI_VAR_LOG_MAGIC ||
+	    hdr->var_length != efi_var_file_len ||
+	    hdr->var_crc32 != efi_var_file_crc32) {
+		log_debug("Ignoring stale EFI variables log\n");
+		return -1;
+	}
+
+	for (pos = sizeof(*hdr); pos + sizeof(*rec) + sizeof(*var) <= len;
+	     pos += rec->length) {
+		rec = buf + pos;
+		if (rec->reserved || rec->magic != EFI_VAR_FILE_MAGIC ||
+		    rec->length & 7 ||
+		    rec->length < sizeof(*rec) + sizeof(*var) ||
+		    rec->length > len - pos ||
+		    rec->crc32 != crc32(0, (u8 *)rec->var,
+					rec->length - sizeof(*rec)))
+			break;
+
+		var = rec->var;
+		if (!efi_var_restore_allowed(var, false))
+			continue;
+		old = efi_var_mem_find(&var->guid, var->name, NULL);
+		if (var->length) {
+			ret = efi_var_mem_ins(var->name, &var->guid, var->attr,
+					      var->length,
+					      var->name +
+					      u16_strlen(var->name) + 1,
+					      0, NULL, var->time);
+			if (ret != EFI_SUCCESS) {
+				log_err("Failed to set EFI variable %ls\n",
+					var->name);
+				continue;
+			}
+		}
+		efi_var_mem_del(old);
+	}
+
+	return pos;
+}
+
 /**
  * efi_var_from_file() - read variables from file
  *
@@ -170,8 +352,34 @@ efi_status_t efi_var_from_file(void)
 		log_err("Failed to load EFI variables\n");
 		goto error;
 	}
-	if (buf->length != len || efi_var_restore(buf, false) != EFI_SUCCESS)
+	if (buf->length != len || efi_var_restore(buf, false) != EFI_SUCCESS) {
 		log_err("Invalid EFI variables file\n");
+		goto error;
+	}
+	efi_var_file_len = len;
+	efi_var_file_crc32 = buf->crc32;
+
+	if (IS_ENABLED(CONFIG_EFI_VARIABLE_FILE_LOG)) {
+		free(buf);
+		buf = NULL;
+		if (efi_set_blk_dev_to_system_partition() != EFI_SUCCESS)
+			goto error;
+		if (fs_size(EFI_VAR_LOG_NAME, &len) || !len) {
+			efi_var_log_len = 0;
+			goto error;
+		}
+		buf = malloc(len);
+		if (!buf ||
+		    efi_set_blk_dev_to_system_partition() != EFI_SUCCESS)
+			goto error;
+		r = fs_read(EFI_VAR_LOG_NAME, map_to_sysmem(buf), 0, len,
+			    &len);
+		if (r) {
+			log_err("Failed to load EFI variables log\n");
+			goto error;
+		}
+		efi_var_log_len = efi_var_log_restore(buf, len);
+	}
 error:
 	free(buf);
 #endif
@@ -7,8 +7,18 @@
 
 #include <efi_loader.h>
 #include <efi_variable.h>
+#include <linux/log2.h>
 #include <u-boot/crc.h>
 
+/*
+ * Variables are looked up via an open-addressed hash table of offsets into
+ * efi_var_buf. An offset of 0 marks an empty slot as it would point to the
+ * header. Each variable takes at least sizeof(struct efi_var_entry) bytes of
+ * the buffer so that the table can never fill up.
+ */
+#define EFI_VAR_INDEX_SIZE \
+	roundup_pow_of_two(EFI_VAR_BUF_SIZE / sizeof(struct efi_var_entry))
+
 /*
  * The variables efi_var_file and efi_var_entry must be static to avoid
  * referencing them via the global offset table (section .got). The GOT
@@ -17,6 +27,109 @@
  */
 static struct efi_var_file __efi_runtime_data *efi_var_buf;
 static struct efi_var_entry __efi_runtime_data *efi_current_var;
+static u32 __efi_runtime_data *efi_var_index;
+static u32 __efi_runtime_data efi_var_index_mask;
+
+/**
+ * efi_var_mem_hash() - compute the hash of a variable's GUID and name
+ *
+ * @guid:	GUID of the variable
+ * @name:	name of the variable
+ * Return:	hash value
+ */
+static u32 __efi_runtime efi_var_mem_hash(const efi_guid_t *guid,
+					  const u16 *name)
+{
+	const u8 *pos = (const u8 *)guid;
+	u32 hash = 2166136261U;
+	int i;
+
+	/* FNV-1a */
+	for (i = 0; i < sizeof(efi_guid_t); ++i)
+		hash = (hash ^ pos[i]) * 16777619U;
+	for (; *name; ++name)
+		hash = (hash ^ *name) * 16777619U;
+
+	return hash;
+}
+
+/**
+ * efi_var_index_entry() - get the variable referenced by an index slot
+ *
+ * @slot:	index slot
+ * Return:	variable
+ */
+static struct efi_var_entry __efi_runtime *efi_var_index_entry(u32 slot)
+{
+	return (struct efi_var_entry *)((uintptr_t)efi_var_buf +
+					efi_var_index[slot]);
+}
+
+/**
+ * efi_var_index_add() - add a variable to the index
+ *
+ * @var:	variable in efi_var_buf
+ */
+static void __efi_runtime efi_var_index_add(struct efi_var_entry *var)
+{
+	u32 slot = efi_var_mem_hash(&var->guid, var->name) & efi_var_index_mask;
+
+	while (efi_var_index[slot])
+		slot = (slot + 1) & efi_var_index_mask;
+	efi_var_index[slot] = (uintptr_t)var - (uintptr_t)efi_var_buf;
+}
+
+/**
+ * efi_var_index_del() - remove a variable from the index
+ *
+ * Entries following the removed one are moved back so that no lookup
+ * stops early at the freed slot.
+ *
+ * @var:	variable in efi_var_buf
+ */
+static void __efi_runtime efi_var_index_del(struct efi_var_entry *var)
+{
+	u32 offset = (uintptr_t)var - (uintptr_t)efi_var_buf;
+	u32 slot, next, home;
+
+	slot = efi_var_mem_hash(&var->guid, var->name) & efi_var_index_mask;
+	while (efi_var_index[slot] != offset) {
+		if (!efi_var_index[slot])
+			return;
+		slot = (slot + 1) & efi_var_index_mask;
+	}
+
+	for (next = slot;;) {
+		next = (next + 1) & efi_var_index_mask;
+		if (!efi_var_index[next])
+			break;
+		var = efi_var_index_entry(next);
+		home = efi_var_mem_hash(&var->guid, var->name) &
+		       efi_var_index_mask;
+		/* Skip entries whose home slot lies after the free slot */
+		if (((next - home) & efi_var_index_mask) <
+		    ((next - slot) & efi_var_index_mask))
+			continue;
+		efi_var_index[slot] = efi_var_index[next];
+		slot = next;
+	}
+	efi_var_index[slot] = 0;
+}
+
+/**
+ * efi_var_index_build() - create the index for the variables in efi_var_buf
+ */
+static void efi_var_index_build(void)
+{
+	struct efi_var_entry *var, *last;
+
+	memset(efi_var_index, 0, EFI_VAR_INDEX_SIZE * sizeof(u32));
+	last = (struct efi_var_entry *)
+	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
+	for (var = efi_var_buf->var; var < last;
+	     var = (void *)var + efi_var_entry_len(var))
+		efi_var_index_add(var);
+}
 
 /**
  * efi_var_mem_compare() - compare GUID and name with a variable
@@ -83,6 +196,7 @@ struct efi_var_entry __efi_runtime
 		  struct efi_var_entry **next)
 {
 	struct efi_var_entry *var, *last;
+	u32 slot;
 
 	last = (struct efi_var_entry *)
 	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
@@ -102,21 +216,15 @@ struct efi_var_entry __efi_runtime
 		return efi_current_var;
 	}
 
-	var = efi_var_buf->var;
-	if (var < last) {
-		for (; var;) {
-			struct efi_var_entry *pos;
-			bool match;
-
-			match = efi_var_mem_compare(var, guid, name, &pos);
-			if (pos >= last)
-				pos = NULL;
-			if (match) {
-				if (next)
-					*next = pos;
-				return var;
-			}
-			var = pos;
+	slot = efi_var_mem_hash(guid, name) & efi_var_index_mask;
+	for (; efi_var_index[slot]; slot = (slot + 1) & efi_var_index_mask) {
+		struct efi_var_entry *pos;
+
+		var = efi_var_index_entry(slot);
+		if (efi_var_mem_compare(var, guid, name, &pos)) {
+			if (next)
+				*next = pos < last ? pos : NULL;
+			return var;
 		}
 	}
 	if (next)
@@ -128,6 +236,7 @@ void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
 {
 	u16 *data;
 	struct efi_var_entry *next, *last;
+	u32 offset, len, slot;
 
 	if (!var)
 		return;
@@ -142,10 +251,17 @@ void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
 	++data;
 	next = (struct efi_var_entry *)
 	       ALIGN((uintptr_t)data + var->length, 8);
-	efi_var_buf->length -= (uintptr_t)next - (uintptr_t)var;
+	offset = (uintptr_t)var - (uintptr_t)efi_var_buf;
+	len = (uintptr_t)next - (uintptr_t)var;
+	efi_var_buf->length -= len;
 
+	efi_var_index_del(var);
 	/* efi_memcpy_runtime() can be used because next >= var. */
 	efi_memcpy_runtime(var, next, (uintptr_t)last - (uintptr_t)next);
+	for (slot = 0; slot <= efi_var_index_mask; ++slot) {
+		if (efi_var_index[slot] > offset)
+			efi_var_index[slot] -= len;
+	}
 	efi_var_buf->crc32 = crc32(0, (u8 *)efi_var_buf->var,
 				   efi_var_buf->length -
 				   sizeof(struct efi_var_file));
@@ -180,6 +296,7 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 			   sizeof(u16) * var_name_len);
 	efi_memcpy_runtime(data, data1, size1);
 	efi_memcpy_runtime((u8 *)data + size1, data2, size2);
+	efi_var_index_add(var);
 
 	var = (struct efi_var_entry *)
 	      ALIGN((uintptr_t)data + var->length, 8);
@@ -211,6 +328,7 @@ static void EFIAPI __efi_runtime
 efi_var_mem_notify_virtual_address_map(struct efi_event *event, void *context)
 {
 	efi_convert_pointer(0, (void **)&efi_var_buf);
+	efi_convert_pointer(0, (void **)&efi_var_index);
 	efi_current_var = NULL;
 }
 
@@ -232,6 +350,17 @@ efi_status_t efi_var_mem_init(void)
 	efi_var_buf->length = (uintptr_t)efi_var_buf->var -
 			      (uintptr_t)efi_var_buf;
 
+	ret = efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES,
+				 EFI_RUNTIME_SERVICES_DATA,
+				 efi_size_in_pages(EFI_VAR_INDEX_SIZE *
+						   sizeof(u32)),
+				 &memory);
+	if (ret != EFI_SUCCESS)
+		return ret;
+	efi_var_index = (u32 *)(uintptr_t)memory;
+	efi_var_index_mask = EFI_VAR_INDEX_SIZE - 1;
+	efi_var_index_build();
+
 	ret = efi_create_event(EVT_SIGNAL_VIRTUAL_ADDRESS_CHANGE, TPL_CALLBACK,
 			       efi_var_mem_notify_virtual_address_map, NULL,
 			       NULL, &event);
@@ -396,4 +525,6 @@ skip:
 void efi_var_buf_update(struct efi_var_file *var_buf)
 {
 	memcpy(efi_var_buf, var_buf, EFI_VAR_BUF_SIZE);
+	efi_current_var = NULL;
+	efi_var_index_build();
 }
@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * efi_selftest_block_read
+ *
+ * Measure how many ReadBlocks() calls per second the first block device
+ * serves. Boot loaders read file systems with many small reads, so reads of
+ * one block and of 4 KiB are timed, moving sequentially through the device.
+ */
+
+#include <efi_selftest.h>
+
+/* Number of blocks at the start of the device which are read */
+#define SPAN_BLOCKS	8192
+
+/* Duration of each measurement, in units of 100 ns */
+#define DURATION	10000000
+
+static const efi_guid_t block_io_protocol_guid = EFI_BLOCK_IO_PROTOCOL_GUID;
+static struct efi_boot_services *boottime;
+static struct efi_block_io *block_io;
+static struct efi_event *timer;
+static u64 buf;
+static efi_uintn_t buf_pages;
+
+/**
+ * setup() - setup unit test
+ *
+ * Find the first block device with media present and create a timer.
+ *
+ * @handle:	handle of the loaded image
+ * @systable:	system table
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int setup(const efi_handle_t handle,
+		 const struct efi_system_table *systable)
+{
+	efi_uintn_t i, count;
+	efi_handle_t *handles;
+	efi_status_t ret;
+
+	boottime = systable->boottime;
+
+	ret = boottime->locate_handle_buffer(BY_PROTOCOL,
+					     &block_io_protocol_guid, NULL,
+					     &count, &handles);
+	if (ret != EFI_SUCCESS) {
+		efi_st_printf("No block device found\n");
+		return EFI_ST_SUCCESS;
+	}
+	for (i = 0; i < count; ++i) {
+		struct efi_block_io *io;
+
+		ret = boottime->open_protocol(handles[i],
+					      &block_io_protocol_guid,
+					      (void **)&io, NULL, NULL,
+					      EFI_OPEN_PROTOCOL_GET_PROTOCOL);
+		if (ret == EFI_SUCCESS && io->media->media_present) {
+			block_io = io;
+			break;
+		}
+	}
+	boottime->free_pool(handles);
+	if (!block_io)
+		return EFI_ST_SUCCESS;
+
+	/* Pages satisfy the alignment required by the media */
+	buf_pages = (max(4096U, block_io->media->block_size) +
+		     EFI_PAGE_MASK) >> EFI_PAGE_SHIFT;
+	ret = boottime->allocate_pages(EFI_ALLOCATE_ANY_PAGES, EFI_LOADER_DATA,
+				       buf_pages, &buf);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("AllocatePages failed\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->create_event(EVT_TIMER, TPL_CALLBACK, NULL, NULL,
+				     &timer);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("Could not create event\n");
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * teardown() - tear down unit test
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int teardown(void)
+{
+	efi_status_t ret;
+
+	if (timer) {
+		ret = boottime->close_event(timer);
+		timer = NULL;
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("Could not close event\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	if (buf) {
+		ret = boottime->free_pages(buf, buf_pages);
+		buf = 0;
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("FreePages failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * measure() - count the reads of a given size completed in one second
+ *
+ * @size:	number of bytes per read, a multiple of the block size
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int measure(efi_uintn_t size)
+{
+	struct efi_block_io_media *media = block_io->media;
+	u64 blocks = size / media->block_size;
+	u64 span = SPAN_BLOCKS;
+	unsigned int reads = 0;
+	efi_status_t ret;
+	u64 lba = 0;
+
+	if (span > media->last_block + 1)
+		span = media->last_block + 1;
+	if (blocks > span)
+		return EFI_ST_SUCCESS;
+
+	ret = boottime->set_timer(timer, EFI_TIMER_RELATIVE, DURATION);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("Could not set timer\n");
+		return EFI_ST_FAILURE;
+	}
+	/* CheckEvent() may poll the console, so only call it now and then */
+	while (reads % 64 || boottime->check_event(timer) == EFI_NOT_READY) {
+		ret = block_io->read_blocks(block_io, media->media_id, lba,
+					    size, (void *)(uintptr_t)buf);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("ReadBlocks failed\n");
+			return EFI_ST_FAILURE;
+		}
+		++reads;
+		lba += blocks;
+		if (lba + blocks > span)
+			lba = 0;
+	}
+	efi_st_printf("%u reads/s of %u bytes\n", reads, (unsigned int)size);
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * execute() - execute unit test
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int execute(void)
+{
+	if (!block_io) {
+		efi_st_printf("No block device with media present\n");
+		return EFI_ST_SUCCESS;
+	}
+
+	if (measure(block_io->media->block_size) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	if (block_io->media->block_size <= 4096 &&
+	    measure(4096) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	return EFI_ST_SUCCESS;
+}
+
+EFI_UNIT_TEST(blkread) = {
+	.name = "block read speed",
+	.phase = EFI_EXECUTE_BEFORE_BOOTTIME_EXIT,
+	.setup = setup,
+	.execute = execute,
+	.teardown = teardown,
+	.on_request = true,
+};
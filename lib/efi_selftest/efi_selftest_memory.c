@@ -93,6 +93,34 @@ static int find_in_memory_map(efi_uintn_t map_size,
 	return EFI_ST_SUCCESS;
 }
 
+/**
+ * check_memory_map_order() - check memory map entries are sorted
+ *
+ * The entries must be in ascending order and must not overlap.
+ *
+ * @map_size:		size of the memory map
+ * @memory_map:		memory map
+ * @desc_size:		size of a memory map entry
+ * Return:		EFI_ST_SUCCESS for success
+ */
+static int check_memory_map_order(efi_uintn_t map_size,
+				  struct efi_mem_desc *memory_map,
+				  efi_uintn_t desc_size)
+{
+	efi_uintn_t i;
+
+	for (i = 1; i < map_size / desc_size; ++i) {
+		struct efi_mem_desc *prev = &memory_map[i - 1];
+
+		if (prev->physical_start + (prev->num_pages << EFI_PAGE_SHIFT) >
+		    memory_map[i].physical_start) {
+			efi_st_error("Memory map entries not sorted\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	return EFI_ST_SUCCESS;
+}
+
 /*
  * execute() - execute unit test
  *
@@ -149,6 +177,9 @@ static int execute(void)
 	}
 
 	/* Check memory map entries */
+	if (check_memory_map_order(map_size, memory_map, desc_size) !=
+	    EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
 	if (find_in_memory_map(map_size, memory_map, desc_size, p1,
 			       EFI_RUNTIME_SERVICES_CODE) != EFI_ST_SUCCESS)
 		return EFI_ST_FAILURE;
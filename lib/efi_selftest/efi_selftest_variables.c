@@ -12,6 +12,7 @@
 
 #define EFI_ST_MAX_DATA_SIZE 16
 #define EFI_ST_MAX_VARNAME_SIZE 80
+#define EFI_ST_NUM_VARS 64
 
 static struct efi_boot_services *boottime;
 static struct efi_runtime_services *runtime;
@@ -37,6 +38,109 @@ static int setup(const efi_handle_t img_handle,
 	return EFI_ST_SUCCESS;
 }
 
+/*
+ * Create the name of the n-th of many variables.
+ *
+ * @name	buffer for the name
+ * @n		number of the variable
+ */
+static void many_var_name(u16 *name, unsigned int n)
+{
+	boottime->copy_mem(name, u"efi_st_many00", sizeof(u"efi_st_many00"));
+	name[11] += n / 10;
+	name[12] += n % 10;
+}
+
+/*
+ * Check that a variable has the expected value.
+ *
+ * @n		number of the variable
+ * @value	expected value
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int check_many_var(unsigned int n, u8 value)
+{
+	u16 name[EFI_ST_MAX_VARNAME_SIZE];
+	efi_status_t ret;
+	efi_uintn_t len;
+	u8 data[2];
+	u32 attr;
+
+	many_var_name(name, n);
+	len = sizeof(data);
+	ret = runtime->get_variable(name, &guid_vendor1, &attr, &len, data);
+	if (ret != EFI_SUCCESS || len != 1 || data[0] != value) {
+		efi_st_error("Wrong value of variable %ps\n", name);
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/*
+ * Create, change, and delete many variables interleaved with each other.
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int test_many_variables(void)
+{
+	u16 name[EFI_ST_MAX_VARNAME_SIZE];
+	efi_status_t ret;
+	efi_uintn_t len;
+	unsigned int i;
+	u8 data[2];
+	u32 attr;
+
+	for (i = 0; i < EFI_ST_NUM_VARS; ++i) {
+		many_var_name(name, i);
+		data[0] = i;
+		ret = runtime->set_variable(name, &guid_vendor1,
+					    EFI_VARIABLE_BOOTSERVICE_ACCESS,
+					    1, data);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	/* Delete the odd variables and change the even ones */
+	for (i = 0; i < EFI_ST_NUM_VARS; ++i) {
+		many_var_name(name, i);
+		data[0] = i + 0x80;
+		ret = runtime->set_variable(name, &guid_vendor1,
+					    EFI_VARIABLE_BOOTSERVICE_ACCESS,
+					    i & 1 ? 0 : 1, data);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	for (i = 0; i < EFI_ST_NUM_VARS; ++i) {
+		if (!(i & 1)) {
+			if (check_many_var(i, i + 0x80) != EFI_ST_SUCCESS)
+				return EFI_ST_FAILURE;
+			continue;
+		}
+		many_var_name(name, i);
+		len = sizeof(data);
+		ret = runtime->get_variable(name, &guid_vendor1, &attr, &len,
+					    data);
+		if (ret != EFI_NOT_FOUND) {
+			efi_st_error("Variable was not deleted\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	for (i = 0; i < EFI_ST_NUM_VARS; i += 2) {
+		many_var_name(name, i);
+		ret = runtime->set_variable(name, &guid_vendor1, 0, 0, NULL);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
 /*
  * Execute unit test.
  */
@@ -277,7 +381,7 @@ static int execute(void)
 		return EFI_ST_FAILURE;
 	}
 
-	return EFI_ST_SUCCESS;
+	return test_many_variables();
 }
 
 EFI_UNIT_TEST(variables) = {
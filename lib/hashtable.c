@@ -16,6 +16,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <sort.h>
+#include <vsprintf.h>
 
 #ifdef USE_HOSTCC		/* HOST build */
 # include <string.h>
@@ -114,11 +115,17 @@ int hcreate_r(size_t nel, struct hsearch_data *htab)
 
 	htab->size = nel;
 	htab->filled = 0;
+	htab->unsorted = false;
 
 	/* allocate memory and zero out */
 	htab->table = (struct env_entry_node *)calloc(htab->size + 1,
 						sizeof(struct env_entry_node));
-	if (htab->table == NULL) {
+	htab->sorted = malloc(htab->size * sizeof(struct env_entry *));
+	if (htab->table == NULL || htab->sorted == NULL) {
+		free(htab->table);
+		free(htab->sorted);
+		htab->table = NULL;
+		htab->sorted = NULL;
 		__set_errno(ENOMEM);
 		return 0;
 	}
@@ -157,11 +164,99 @@ void hdestroy_r(struct hsearch_data *htab)
 		}
 	}
 	free(htab->table);
+	free(htab->sorted);
+	htab->sorted = NULL;
 
 	/* the sign for an existing table is an value != NULL in htable */
 	htab->table = NULL;
 }
 
+/*
+ * hsort()
+ */
+
+/*
+ * The entries are kept in the order of their keys in htab->sorted, so that
+ * hexport_r() does not need to sort them. New entries are inserted at their
+ * position found by a binary search. A bulk import sorts all entries once at
+ * the end instead.
+ */
+
+static int cmpkey(const void *p1, const void *p2)
+{
+	struct env_entry *e1 = *(struct env_entry **)p1;
+	struct env_entry *e2 = *(struct env_entry **)p2;
+
+	return (strcmp(e1->key, e2->key));
+}
+
+/*
+ * Return the position of the entry with the given key among the first
+ * "count" sorted entries, or else the position where it would be inserted.
+ */
+static unsigned int hsort_find(struct hsearch_data *htab, const char *key,
+			       unsigned int count)
+{
+	unsigned int low = 0, high = count;
+
+	while (low < high) {
+		unsigned int mid = low + (high - low) / 2;
+
+		if (strcmp(htab->sorted[mid]->key, key) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/* Add a new entry, which is already counted in htab->filled */
+static void hsort_add(struct hsearch_data *htab, struct env_entry *ep)
+{
+	unsigned int count = htab->filled - 1;
+	unsigned int pos;
+
+	if (htab->unsorted)
+		return;
+	pos = hsort_find(htab, ep->key, count);
+	memmove(&htab->sorted[pos + 1], &htab->sorted[pos],
+		(count - pos) * sizeof(struct env_entry *));
+	htab->sorted[pos] = ep;
+}
+
+/* Remove an entry, which is still counted in htab->filled */
+static void hsort_del(struct hsearch_data *htab, struct env_entry *ep)
+{
+	unsigned int count = htab->filled;
+	unsigned int pos;
+
+	if (htab->unsorted)
+		return;
+	pos = hsort_find(htab, ep->key, count);
+	if (pos == count || htab->sorted[pos] != ep) {
+		htab->unsorted = true;
+		return;
+	}
+	memmove(&htab->sorted[pos], &htab->sorted[pos + 1],
+		(count - pos - 1) * sizeof(struct env_entry *));
+}
+
+/* Rebuild the list of sorted entries if needed */
+static void hsort_r(struct hsearch_data *htab)
+{
+	unsigned int i, n;
+
+	if (!htab->unsorted)
+		return;
+	for (i = 1, n = 0; i <= htab->size; ++i) {
+		if (htab->table[i].used > 0)
+			htab->sorted[n++] = &htab->table[i].entry;
+	}
+	qsort(htab->sorted, n, sizeof(struct env_entry *), cmpkey);
+	htab->unsorted = false;
+}
+
 /*
  * hsearch()
  */
@@ -290,13 +385,13 @@ int hsearch_r(struct env_entry item, enum env_action action,
 	unsigned int first_deleted = 0;
 	int ret;
 
-	/* Compute an value for the given string. Perhaps use a better method. */
-	hval = len;
-	count = len;
-	while (count-- > 0) {
-		hval <<= 4;
-		hval += item.key[count];
-	}
+	/*
+	 * Compute a value for the given string (FNV-1a). All characters
+	 * contribute, so that keys sharing a long prefix do not collide.
+	 */
+	hval = 2166136261U;
+	for (count = 0; count < len; ++count)
+		hval = (hval ^ (unsigned char)item.key[count]) * 16777619U;
 
 	/*
 	 * First hash function:
@@ -391,6 +486,16 @@ int hsearch_r(struct env_entry item, enum env_action action,
 
 		++htab->filled;
 
+		if (flag & H_BULK) {
+			/* himport_r() sets up all new entries at the end */
+			htab->table[idx].entry.flags = 0;
+#ifndef CONFIG_SPL_BUILD
+			htab->table[idx].entry.callback = NULL;
+#endif
+			*retval = &htab->table[idx].entry;
+			return 1;
+		}
+
 		/* This is a new entry, so look up a possible callback */
 		env_callback_init(&htab->table[idx].entry);
 		/* Also look for flags */
@@ -420,6 +525,7 @@ int hsearch_r(struct env_entry item, enum env_action action,
 
 		/* return new entry */
 		*retval = &htab->table[idx].entry;
+		hsort_add(htab, *retval);
 		return 1;
 	}
 
@@ -485,6 +591,7 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
 		return -EINVAL;
 	}
 
+	hsort_del(htab, ep);
 	_hdelete(key, htab, ep, idx);
 
 	return 0;
@@ -533,14 +640,6 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
  *		bytes in the string will be '\0'-padded.
  */
 
-static int cmpkey(const void *p1, const void *p2)
-{
-	struct env_entry *e1 = *(struct env_entry **)p1;
-	struct env_entry *e2 = *(struct env_entry **)p2;
-
-	return (strcmp(e1->key, e2->key));
-}
-
 static int match_string(int flag, const char *str, const char *pat, void *priv)
 {
 	switch (flag & H_MATCH_METHOD) {
@@ -603,7 +702,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		 char **resp, size_t size,
 		 int argc, char *const argv[])
 {
-	struct env_entry *list[htab->size];
+	struct env_entry *list[htab->filled];
 	char *res, *p;
 	size_t totlen;
 	int i, n;
@@ -616,56 +715,43 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 
 	debug("EXPORT  table = %p, htab.size = %d, htab.filled = %d, size = %lu\n",
 	      htab, htab->size, htab->filled, (ulong)size);
+	hsort_r(htab);
+
 	/*
 	 * Pass 1:
-	 * search used entries,
+	 * search used entries in the order of their keys,
 	 * save addresses and compute total length
 	 */
-	for (i = 1, n = 0, totlen = 0; i <= htab->size; ++i) {
+	for (i = 0, n = 0, totlen = 0; i < htab->filled; ++i) {
+		struct env_entry *ep = htab->sorted[i];
+		int found = match_entry(ep, flag, argc, argv);
 
-		if (htab->table[i].used > 0) {
-			struct env_entry *ep = &htab->table[i].entry;
-			int found = match_entry(ep, flag, argc, argv);
-
-			if ((argc > 0) && (found == 0))
-				continue;
+		if ((argc > 0) && (found == 0))
+			continue;
 
-			if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
-				continue;
+		if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
+			continue;
 
-			list[n++] = ep;
+		list[n++] = ep;
 
-			totlen += strlen(ep->key);
+		totlen += strlen(ep->key);
 
-			if (sep == '\0') {
-				totlen += strlen(ep->data);
-			} else {	/* check if escapes are needed */
-				char *s = ep->data;
+		if (sep == '\0') {
+			totlen += strlen(ep->data);
+		} else {	/* check if escapes are needed */
+			char *s = ep->data;
 
-				while (*s) {
+			while (*s) {
+				++totlen;
+				/* add room for needed escape chars */
+				if ((*s == sep) || (*s == '\\'))
 					++totlen;
-					/* add room for needed escape chars */
-					if ((*s == sep) || (*s == '\\'))
-						++totlen;
-					++s;
-				}
+				++s;
 			}
-			totlen += 2;	/* for '=' and 'sep' char */
 		}
+		totlen += 2;	/* for '=' and 'sep' char */
 	}
 
-#ifdef DEBUG
-	/* Pass 1a: print unsorted list */
-	printf("Unsorted: n=%d\n", n);
-	for (i = 0; i < n; ++i) {
-		printf("\t%3d: %p ==> %-10s => %s\n",
-		       i, list[i], list[i]->key, list[i]->data);
-	}
-#endif
-
-	/* Sort list by keys */
-	qsort(list, n, sizeof(struct env_entry *), cmpkey);
-
 	/* Check if the user supplied buffer size is sufficient */
 	if (size) {
 		if (size < totlen + 1) {	/* provided buffer too small */
@@ -751,6 +837,64 @@ static int drop_var_from_set(const char *name, int nvars, char * vars[])
 	return res;
 }
 
+/*
+ * Count the "name=value" pairs in the data to be imported, which is used to
+ * size a new hash table. Comments and escaped separators are counted as
+ * well, which does no harm.
+ */
+static int hcount_entries(const char *data, size_t size, const char sep)
+{
+	const char *p = data, *end = data + size;
+	int count = 0;
+
+	while (p < end && *p) {
+		++count;
+		while (p < end && *p && *p != sep)
+			++p;
+		++p;
+	}
+
+	return count;
+}
+
+/*
+ * Set up the entries created by a bulk import: Look up the flags and
+ * callbacks of all of them at once, which is much faster than doing so for
+ * each entry. Then check and announce each entry as hsearch_r() does for a
+ * single new one.
+ */
+static void hbulk_done(struct hsearch_data *htab, int flag)
+{
+	int i;
+
+	env_flags_init_all(htab);
+	env_callback_init_all(htab);
+
+	for (i = 1; i <= htab->size; ++i) {
+		struct env_entry *ep = &htab->table[i].entry;
+
+		if (htab->table[i].used <= 0)
+			continue;
+
+		/* check for permission */
+		if (htab->change_ok != NULL &&
+		    htab->change_ok(ep, ep->data, env_op_create, flag)) {
+			debug("change_ok() rejected setting variable "
+				"%s, skipping it!\n", ep->key);
+			_hdelete(ep->key, htab, ep, i);
+			continue;
+		}
+
+		/* If there is a callback, call it */
+		if (do_callback(ep, ep->key, ep->data, env_op_create, flag)) {
+			debug("callback() rejected setting variable "
+				"%s, skipping it!\n", ep->key);
+			_hdelete(ep->key, htab, ep, i);
+		}
+	}
+	hsort_r(htab);
+}
+
 /*
  * Import linearized data into hash table.
  *
@@ -768,6 +912,10 @@ static int drop_var_from_set(const char *name, int nvars, char * vars[])
  * the linear list of "name=value" pairs will be removed from the
  * current hash table.
  *
+ * When all variables are imported into a new hash table, their flags and
+ * callbacks are set up only once all of them have been entered. This also
+ * means that the callbacks see the complete imported environment.
+ *
  * The separator character for the "name=value" pairs can be selected,
  * so we both support importing from externally stored environment
  * data (separated by NUL characters) and from plain text files
@@ -849,16 +997,27 @@ int himport_r(struct hsearch_data *htab,
 
 	if (!htab->table) {
 		int nent = CONFIG_ENV_MIN_ENTRIES + size / 8;
+		int count;
 
 		if (nent > CONFIG_ENV_MAX_ENTRIES)
 			nent = CONFIG_ENV_MAX_ENTRIES;
 
+		/* Never clip below what is needed for the data to import */
+		count = hcount_entries(data, size, sep);
+		if (nent < count + count / 2)
+			nent = count + count / 2;
+
 		debug("Create Hash Table: N=%d\n", nent);
 
 		if (hcreate_r(nent, htab) == 0) {
 			free(data);
 			return 0;
 		}
+
+		if (!nvars) {
+			flag |= H_BULK;
+			htab->unsorted = true;
+		}
 	}
 
 	if (!size) {
@@ -927,6 +1086,8 @@ int himport_r(struct hsearch_data *htab,
 
 		if (*name == 0) {
 			debug("INSERT: unable to use an empty key\n");
+			if (flag & H_BULK)
+				hbulk_done(htab, flag & ~H_BULK);
 			__set_errno(EINVAL);
 			free(data);
 			return 0;
@@ -956,6 +1117,9 @@ int himport_r(struct hsearch_data *htab,
 	debug("INSERT: free(data = %p)\n", data);
 	free(data);
 
+	if (flag & H_BULK)
+		hbulk_done(htab, flag & ~H_BULK);
+
 	if (flag & H_NOCLEAR)
 		goto end;
 
@@ -1005,3 +1169,47 @@ int hwalk_r(struct hsearch_data *htab, int (*callback)(struct env_entry *entry))
 
 	return 0;
 }
+
+/*
+ * hwalk_key_r()
+ */
+
+int hwalk_key_r(struct hsearch_data *htab, const char *name,
+		int (*callback)(struct env_entry *entry, void *priv),
+		void *priv)
+{
+	struct env_entry e, *ep;
+
+#ifdef CONFIG_REGEX
+	if (strpbrk(name, "\\^$.|?*+()[]")) {
+		char regex[strlen(name) + 3];
+		struct slre slre;
+		int i, retval;
+
+		/* Require the whole key to be described by the regex */
+		sprintf(regex, "^%s$", name);
+		if (!slre_compile(&slre, regex)) {
+			printf("Error compiling regex: %s\n", slre.err_str);
+			return -EINVAL;
+		}
+
+		for (i = 1; i <= htab->size; ++i) {
+			if (htab->table[i].used <= 0)
+				continue;
+			ep = &htab->table[i].entry;
+			if (!slre_match(&slre, ep->key, strlen(ep->key), NULL))
+				continue;
+			retval = callback(ep, priv);
+			if (retval)
+				return retval;
+		}
+
+		return 0;
+	}
+#endif
+	e.key = name;
+	e.data = NULL;
+	hsearch_r(e, ENV_FIND, &ep, htab, 0);
+
+	return ep ? callback(ep, priv) : 0;
+}
@@ -49,98 +49,177 @@
 
 static void default_log(const char *ignored, char *response) {}
 
-static lbaint_t write_sparse_chunk_raw(struct sparse_storage *info,
-				       lbaint_t blk, lbaint_t blkcnt,
-				       void *data,
-				       char *response)
+static int sparse_stream_fail(struct sparse_stream *s, const char *msg,
+			      char *response)
 {
-	lbaint_t n = blkcnt, write_blks, blks = 0;
-	lbaint_t aligned_buf_blks = FASTBOOT_MAX_BLK_WRITE;
-	uint32_t *aligned_buf = NULL;
+	s->info->mssg(msg, response);
+	s->state = SPARSE_STREAM_ERROR;
 
-	if (CONFIG_IS_ENABLED(SYS_DCACHE_OFF)) {
-		write_blks = info->write(info, blk, n, data);
-		if (write_blks < n)
-			goto write_fail;
+	return -EIO;
+}
 
-		return write_blks;
-	}
+static int sparse_write_blocks(struct sparse_stream *s, lbaint_t blkcnt,
+			       const void *data, char *response)
+{
+	struct sparse_storage *info = s->info;
+	lbaint_t blks;
 
-	aligned_buf = memalign(ARCH_DMA_MINALIGN, info->blksz * aligned_buf_blks);
-	if (!aligned_buf) {
-		info->mssg("Malloc failed for: CHUNK_TYPE_RAW", response);
-		return -ENOMEM;
+	/* blks might be > blkcnt due to NAND bad-blocks */
+	blks = info->write(info, s->blk, blkcnt, data);
+	if (IS_ERR_VALUE(blks)) {
+		printf("%s: Write failed, block #" LBAFU " [" LBAFU "] (%lld)\n",
+		       __func__, s->blk, blkcnt, (long long)blks);
+		return sparse_stream_fail(s, "flash write failure", response);
+	}
+	if (blks < blkcnt) {
+		printf("%s: Write failed, block #" LBAFU " [" LBAFU "]\n",
+		       __func__, s->blk, blkcnt);
+		return sparse_stream_fail(s, "flash write failure(incomplete)",
+					  response);
 	}
 
-	while (blkcnt > 0) {
-		n = min(aligned_buf_blks, blkcnt);
-		memcpy(aligned_buf, data, n * info->blksz);
-
-		/* write_blks might be > n due to NAND bad-blocks */
-		write_blks = info->write(info, blk + blks, n, aligned_buf);
-		if (write_blks < n) {
-			free(aligned_buf);
-			goto write_fail;
+	s->blk += blks;
+	s->bytes_written += ((u64)blkcnt) * info->blksz;
+
+	return 0;
+}
+
+static int sparse_write_fill(struct sparse_stream *s, lbaint_t blkcnt,
+			     char *response)
+{
+	struct sparse_storage *info = s->info;
+	lbaint_t fill_buf_num_blks, blks, n;
+	int i, ret;
+
+	if (!s->run_val && info->erase) {
+		blks = info->erase(info, s->blk, blkcnt);
+		if (IS_ERR_VALUE(blks) || blks < blkcnt) {
+			printf("%s: Erase failed, block #" LBAFU " [" LBAFU "]\n",
+			       __func__, s->blk, blkcnt);
+			return sparse_stream_fail(s, "flash erase failure",
+						  response);
 		}
+		s->blk += blks;
+		s->bytes_written += ((u64)blkcnt) * info->blksz;
+
+		return 0;
+	}
 
-		blks += write_blks;
-		data += n * info->blksz;
+	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
+	if (!s->fill_buf) {
+		s->fill_buf = memalign(ARCH_DMA_MINALIGN,
+				       ROUNDUP(info->blksz * fill_buf_num_blks,
+					       ARCH_DMA_MINALIGN));
+		if (!s->fill_buf)
+			return sparse_stream_fail(s,
+				"Malloc failed for: CHUNK_TYPE_FILL", response);
+		s->fill_val = ~s->run_val;
+	}
+	if (s->fill_val != s->run_val) {
+		for (i = 0; i < info->blksz * fill_buf_num_blks /
+				sizeof(s->fill_val); i++)
+			s->fill_buf[i] = s->run_val;
+		s->fill_val = s->run_val;
+	}
+
+	while (blkcnt > 0) {
+		n = min(blkcnt, fill_buf_num_blks);
+		ret = sparse_write_blocks(s, n, s->fill_buf, response);
+		if (ret)
+			return ret;
 		blkcnt -= n;
 	}
 
-	free(aligned_buf);
-	return blks;
+	return 0;
+}
 
-write_fail:
-	if (IS_ERR_VALUE(write_blks)) {
-		printf("%s: Write failed, block #" LBAFU " [" LBAFU "] (%lld)\n",
-		       __func__, blk + blks, n, (long long)write_blks);
-		info->mssg("flash write failure", response);
-		return write_blks;
+/* Issue the pending run of DONT_CARE or FILL chunks */
+static int sparse_flush_run(struct sparse_stream *s, char *response)
+{
+	struct sparse_storage *info = s->info;
+	lbaint_t blkcnt = s->run_blks;
+	int ret = 0;
+
+	switch (s->run) {
+	case SPARSE_RUN_NONE:
+		break;
+	case SPARSE_RUN_DONT_CARE:
+		s->blk += info->reserve(info, s->blk, blkcnt);
+		break;
+	case SPARSE_RUN_FILL:
+		ret = sparse_write_fill(s, blkcnt, response);
+		break;
 	}
+	s->run = SPARSE_RUN_NONE;
+	s->run_blks = 0;
 
-	/* write_blks < n */
-	printf("%s: Write failed, block #" LBAFU " [" LBAFU "]\n",
-	       __func__, blk + blks, n);
-	info->mssg("flash write failure(incomplete)", response);
-	return -1;
+	return ret;
 }
 
-int write_sparse_image(struct sparse_storage *info,
-		       const char *part_name, void *data, char *response)
+static int sparse_queue_run(struct sparse_stream *s, enum sparse_run_type run,
+			    u32 val, lbaint_t blkcnt, char *response)
 {
-	lbaint_t blk;
-	lbaint_t blkcnt;
-	lbaint_t blks;
-	uint64_t bytes_written = 0;
-	unsigned int chunk;
-	unsigned int offset;
-	uint64_t chunk_data_sz;
-	uint32_t *fill_buf = NULL;
-	uint32_t fill_val;
-	sparse_header_t *sparse_header;
-	chunk_header_t *chunk_header;
-	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
-	int i;
-	int j;
+	int ret;
+
+	if (s->run != run || s->run_val != val) {
+		ret = sparse_flush_run(s, response);
+		if (ret)
+			return ret;
+		s->run = run;
+		s->run_val = val;
+	}
+	s->run_blks += blkcnt;
 
-	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
+	return 0;
+}
 
-	/* Read and skip over sparse image header */
-	sparse_header = (sparse_header_t *)data;
+static int sparse_flush_buf(struct sparse_stream *s, char *response)
+{
+	lbaint_t blkcnt = s->buf_len / s->info->blksz;
 
-	data += sparse_header->file_hdr_sz;
-	if (sparse_header->file_hdr_sz > sizeof(sparse_header_t)) {
-		/*
-		 * Skip the remaining bytes in a header that is longer than
-		 * we expected.
-		 */
-		data += (sparse_header->file_hdr_sz - sizeof(sparse_header_t));
+	s->buf_len = 0;
+	if (!blkcnt)
+		return 0;
+
+	return sparse_write_blocks(s, blkcnt, s->buf, response);
+}
+
+static int sparse_check_range(struct sparse_stream *s, lbaint_t blkcnt,
+			      char *response)
+{
+	struct sparse_storage *info = s->info;
+
+	if (s->blk + s->run_blks + blkcnt > info->start + info->size) {
+		printf("%s: Request would exceed partition size!\n", __func__);
+		return sparse_stream_fail(s,
+			"Request would exceed partition size!", response);
 	}
 
-	if (!info->mssg)
-		info->mssg = default_log;
+	return 0;
+}
+
+static int sparse_end_chunk(struct sparse_stream *s, char *response)
+{
+	int ret;
+
+	s->partial = 0;
+	if (++s->chunk_idx < s->hdr.total_chunks) {
+		s->state = SPARSE_STREAM_CHUNK_HDR;
+		return 0;
+	}
+
+	ret = sparse_flush_run(s, response);
+	if (ret)
+		return ret;
+	s->state = SPARSE_STREAM_DONE;
+
+	return 0;
+}
+
+static int sparse_start_image(struct sparse_stream *s, char *response)
+{
+	sparse_header_t *sparse_header = &s->hdr;
+	unsigned int offset;
 
 	debug("=== Sparse Image Header ===\n");
 	debug("magic: 0x%x\n", sparse_header->magic);
@@ -152,167 +231,350 @@ int write_sparse_image(struct sparse_storage *info,
 	debug("total_blks: %d\n", sparse_header->total_blks);
 	debug("total_chunks: %d\n", sparse_header->total_chunks);
 
+	if (!is_sparse_image(sparse_header) ||
+	    sparse_header->file_hdr_sz < sizeof(sparse_header_t) ||
+	    sparse_header->chunk_hdr_sz < sizeof(chunk_header_t)) {
+		printf("%s: Invalid sparse image header\n", __func__);
+		return sparse_stream_fail(s, "invalid sparse image header",
+					  response);
+	}
+
 	/*
 	 * Verify that the sparse block size is a multiple of our
 	 * storage backend block size
 	 */
-	div_u64_rem(sparse_header->blk_sz, info->blksz, &offset);
+	div_u64_rem(sparse_header->blk_sz, s->info->blksz, &offset);
 	if (offset) {
 		printf("%s: Sparse image block size issue [%u]\n",
 		       __func__, sparse_header->blk_sz);
-		info->mssg("sparse image block size issue", response);
-		return -1;
+		return sparse_stream_fail(s, "sparse image block size issue",
+					  response);
 	}
 
 	puts("Flashing Sparse Image\n");
 
-	/* Start processing chunks */
-	blk = info->start;
-	for (chunk = 0; chunk < sparse_header->total_chunks; chunk++) {
-		/* Read and skip over chunk header */
-		chunk_header = (chunk_header_t *)data;
-		data += sizeof(chunk_header_t);
-
-		if (chunk_header->chunk_type != CHUNK_TYPE_RAW) {
-			debug("=== Chunk Header ===\n");
-			debug("chunk_type: 0x%x\n", chunk_header->chunk_type);
-			debug("chunk_data_sz: 0x%x\n", chunk_header->chunk_sz);
-			debug("total_size: 0x%x\n", chunk_header->total_sz);
+	/*
+	 * Skip the remaining bytes in a header that is longer than we
+	 * expected.
+	 */
+	s->skip = sparse_header->file_hdr_sz - sizeof(sparse_header_t);
+	s->partial = 0;
+	s->state = sparse_header->total_chunks ? SPARSE_STREAM_CHUNK_HDR :
+		   SPARSE_STREAM_DONE;
+
+	return 0;
+}
+
+static int sparse_start_chunk(struct sparse_stream *s, char *response)
+{
+	struct sparse_storage *info = s->info;
+	chunk_header_t *chunk_header = &s->chunk;
+	u32 chunk_hdr_sz = s->hdr.chunk_hdr_sz;
+	uint64_t chunk_data_sz;
+	lbaint_t blkcnt;
+	int ret;
+
+	if (chunk_header->chunk_type != CHUNK_TYPE_RAW) {
+		debug("=== Chunk Header ===\n");
+		debug("chunk_type: 0x%x\n", chunk_header->chunk_type);
+		debug("chunk_data_sz: 0x%x\n", chunk_header->chunk_sz);
+		debug("total_size: 0x%x\n", chunk_header->total_sz);
+	}
+
+	/*
+	 * Skip the remaining bytes in a header that is longer than we
+	 * expected.
+	 */
+	s->skip = chunk_hdr_sz - sizeof(chunk_header_t);
+	s->partial = 0;
+
+	chunk_data_sz = ((u64)s->hdr.blk_sz) * chunk_header->chunk_sz;
+	blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, info->blksz);
+	switch (chunk_header->chunk_type) {
+	case CHUNK_TYPE_RAW:
+		if (chunk_header->total_sz != (chunk_hdr_sz + chunk_data_sz))
+			return sparse_stream_fail(s,
+				"Bogus chunk size for chunk type Raw", response);
+
+		ret = sparse_flush_run(s, response);
+		if (ret)
+			return ret;
+		ret = sparse_check_range(s, blkcnt, response);
+		if (ret)
+			return ret;
+
+		s->remain = chunk_data_sz;
+		s->state = SPARSE_STREAM_RAW;
+		if (!s->remain)
+			return sparse_end_chunk(s, response);
+		break;
+
+	case CHUNK_TYPE_FILL:
+		if (chunk_header->total_sz != (chunk_hdr_sz + sizeof(uint32_t)))
+			return sparse_stream_fail(s,
+				"Bogus chunk size for chunk type FILL", response);
+
+		ret = sparse_check_range(s, blkcnt, response);
+		if (ret)
+			return ret;
+
+		s->state = SPARSE_STREAM_FILL;
+		break;
+
+	case CHUNK_TYPE_DONT_CARE:
+		ret = sparse_queue_run(s, SPARSE_RUN_DONT_CARE, 0, blkcnt,
+				       response);
+		if (ret)
+			return ret;
+		s->total_blocks += chunk_header->chunk_sz;
+
+		return sparse_end_chunk(s, response);
+
+	case CHUNK_TYPE_CRC32:
+		if (chunk_header->total_sz != chunk_hdr_sz + sizeof(uint32_t))
+			return sparse_stream_fail(s,
+				"Bogus chunk size for chunk type CRC32",
+				response);
+
+		s->total_blocks += chunk_header->chunk_sz;
+		s->skip += sizeof(uint32_t);
+
+		return sparse_end_chunk(s, response);
+
+	default:
+		printf("%s: Unknown chunk type: %x\n", __func__,
+		       chunk_header->chunk_type);
+		return sparse_stream_fail(s, "Unknown chunk type", response);
+	}
+
+	return 0;
+}
+
+static int sparse_stream_raw(struct sparse_stream *s, const u8 **datap,
+			     size_t *lenp, char *response)
+{
+	struct sparse_storage *info = s->info;
+	size_t buf_size = info->blksz * s->buf_blks;
+	size_t len = min_t(u64, *lenp, s->remain);
+	const u8 *data = *datap;
+	lbaint_t blkcnt;
+	size_t n;
+	int ret;
+
+	/*
+	 * Write straight from the caller's buffer if it holds the rest of
+	 * the chunk or at least a bounce buffer's worth of data, and the
+	 * storage can DMA from it.
+	 */
+	if (!s->buf_len && (len == s->remain || len >= buf_size) &&
+	    len >= info->blksz &&
+	    (CONFIG_IS_ENABLED(SYS_DCACHE_OFF) ||
+	     IS_ALIGNED((ulong)data, ARCH_DMA_MINALIGN))) {
+		blkcnt = len / info->blksz;
+		n = blkcnt * info->blksz;
+		ret = sparse_write_blocks(s, blkcnt, data, response);
+	} else {
+		if (!s->buf) {
+			s->buf = memalign(ARCH_DMA_MINALIGN, buf_size);
+			if (!s->buf)
+				return sparse_stream_fail(s,
+					"Malloc failed for: CHUNK_TYPE_RAW",
+					response);
 		}
+		n = min(len, buf_size - s->buf_len);
+		memcpy(s->buf + s->buf_len, data, n);
+		s->buf_len += n;
+		ret = 0;
+		if (s->buf_len == buf_size)
+			ret = sparse_flush_buf(s, response);
+	}
+	if (ret)
+		return ret;
+
+	*datap += n;
+	*lenp -= n;
+	s->remain -= n;
+	if (s->remain)
+		return 0;
+
+	ret = sparse_flush_buf(s, response);
+	if (ret)
+		return ret;
+	s->total_blocks += s->chunk.chunk_sz;
+
+	return sparse_end_chunk(s, response);
+}
+
+/* Gather up to @size bytes of a header or value which may arrive in pieces */
+static size_t sparse_collect(struct sparse_stream *s, void *dst, size_t size,
+			     const u8 *data, size_t len)
+{
+	size_t n = min(len, size - s->partial);
+
+	memcpy(dst + s->partial, data, n);
+	s->partial += n;
+
+	return n;
+}
+
+void sparse_stream_start(struct sparse_stream *stream,
+			 struct sparse_storage *info, const char *part_name)
+{
+	memset(stream, '\0', sizeof(*stream));
+	if (!info->mssg)
+		info->mssg = default_log;
+
+	stream->info = info;
+	stream->part_name = part_name;
+	stream->state = SPARSE_STREAM_FILE_HDR;
+	stream->blk = info->start;
+	stream->buf_blks = FASTBOOT_MAX_BLK_WRITE;
+}
 
-		if (sparse_header->chunk_hdr_sz > sizeof(chunk_header_t)) {
-			/*
-			 * Skip the remaining bytes in a header that is longer
-			 * than we expected.
-			 */
-			data += (sparse_header->chunk_hdr_sz -
-				 sizeof(chunk_header_t));
+int sparse_stream_write(struct sparse_stream *s, const void *data,
+			size_t len, char *response)
+{
+	const u8 *p = data;
+	size_t n;
+	int ret = 0;
+
+	if (s->state == SPARSE_STREAM_ERROR)
+		return -EIO;
+
+	while (len && s->state != SPARSE_STREAM_DONE) {
+		if (s->skip) {
+			n = min_t(size_t, len, s->skip);
+			s->skip -= n;
+			p += n;
+			len -= n;
+			continue;
 		}
 
-		chunk_data_sz = ((u64)sparse_header->blk_sz) * chunk_header->chunk_sz;
-		blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, info->blksz);
-		switch (chunk_header->chunk_type) {
-		case CHUNK_TYPE_RAW:
-			if (chunk_header->total_sz !=
-			    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
-				info->mssg("Bogus chunk size for chunk type Raw",
-					   response);
-				return -1;
-			}
-
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				info->mssg("Request would exceed partition size!",
-					   response);
-				return -1;
-			}
-
-			blks = write_sparse_chunk_raw(info, blk, blkcnt,
-						      data, response);
-			if (IS_ERR_VALUE(blks))
-				return -1;
-
-			blk += blks;
-			bytes_written += ((u64)blkcnt) * info->blksz;
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
+		switch (s->state) {
+		case SPARSE_STREAM_FILE_HDR:
+			n = sparse_collect(s, &s->hdr, sizeof(s->hdr), p, len);
+			p += n;
+			len -= n;
+			if (s->partial == sizeof(s->hdr))
+				ret = sparse_start_image(s, response);
 			break;
-
-		case CHUNK_TYPE_FILL:
-			if (chunk_header->total_sz !=
-			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
-				info->mssg("Bogus chunk size for chunk type FILL", response);
-				return -1;
-			}
-
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
-			if (!fill_buf) {
-				info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
-					   response);
-				return -1;
-			}
-
-			fill_val = *(uint32_t *)data;
-			data = (char *)data + sizeof(uint32_t);
-
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
-				fill_buf[i] = fill_val;
-
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				info->mssg("Request would exceed partition size!",
-					   response);
-				return -1;
-			}
-
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					info->mssg("flash write failure",
-						   response);
-					free(fill_buf);
-					return -1;
-				}
-				blk += blks;
-				i += j;
-			}
-			bytes_written += ((u64)blkcnt) * info->blksz;
-			total_blocks += DIV_ROUND_UP_ULL(chunk_data_sz,
-							 sparse_header->blk_sz);
-			free(fill_buf);
+		case SPARSE_STREAM_CHUNK_HDR:
+			n = sparse_collect(s, &s->chunk, sizeof(s->chunk), p,
+					   len);
+			p += n;
+			len -= n;
+			if (s->partial == sizeof(s->chunk))
+				ret = sparse_start_chunk(s, response);
 			break;
-
-		case CHUNK_TYPE_DONT_CARE:
-			blk += info->reserve(info, blk, blkcnt);
-			total_blocks += chunk_header->chunk_sz;
+		case SPARSE_STREAM_FILL:
+			n = sparse_collect(s, &s->chunk_val,
+					   sizeof(s->chunk_val), p, len);
+			p += n;
+			len -= n;
+			if (s->partial < sizeof(s->chunk_val))
+				break;
+			s->total_blocks += s->chunk.chunk_sz;
+			ret = sparse_queue_run(s, SPARSE_RUN_FILL, s->chunk_val,
+					       DIV_ROUND_UP_ULL((u64)s->hdr.blk_sz *
+								s->chunk.chunk_sz,
+								s->info->blksz),
+					       response);
+			if (!ret)
+				ret = sparse_end_chunk(s, response);
 			break;
-
-		case CHUNK_TYPE_CRC32:
-			if (chunk_header->total_sz !=
-			    sparse_header->chunk_hdr_sz + sizeof(uint32_t)) {
-				info->mssg("Bogus chunk size for chunk type CRC32",
-					   response);
-				return -1;
-			}
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
+		case SPARSE_STREAM_RAW:
+			ret = sparse_stream_raw(s, &p, &len, response);
 			break;
-
 		default:
-			printf("%s: Unknown chunk type: %x\n", __func__,
-			       chunk_header->chunk_type);
-			info->mssg("Unknown chunk type", response);
-			return -1;
+			ret = -EIO;
+			break;
 		}
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+int sparse_stream_finish(struct sparse_stream *s, char *response)
+{
+	int ret = 0;
+
+	if (s->state == SPARSE_STREAM_ERROR) {
+		ret = -EIO;
+	} else if (s->state != SPARSE_STREAM_DONE) {
+		printf("%s: Sparse image is truncated\n", __func__);
+		s->info->mssg("sparse image truncated", response);
+		ret = -EIO;
 	}
 
+	free(s->buf);
+	free(s->fill_buf);
+	s->buf = NULL;
+	s->fill_buf = NULL;
+	if (ret)
+		return ret;
+
 	debug("Wrote %d blocks, expected to write %d blocks\n",
-	      total_blocks, sparse_header->total_blks);
-	printf("........ wrote %llu bytes to '%s'\n", bytes_written, part_name);
+	      s->total_blocks, s->hdr.total_blks);
+	printf("........ wrote %llu bytes to '%s'\n", s->bytes_written,
+	       s->part_name);
 
-	if (total_blocks != sparse_header->total_blks) {
-		info->mssg("sparse image write failure", response);
-		return -1;
+	if (s->total_blocks != s->hdr.total_blks) {
+		s->info->mssg("sparse image write failure", response);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * Work out the length of a sparse image held in memory from its chunks,
+ * reading nothing beyond the first @size bytes. If the image is malformed or
+ * truncated, only the part which shows this is counted, so that the stream
+ * parser reports the problem.
+ */
+static size_t sparse_image_len(void *data, size_t size)
+{
+	const sparse_header_t *sparse_header = data;
+	const chunk_header_t *chunk_header;
+	size_t len, chunk_hdr_sz;
+	unsigned int chunk;
+
+	if (size < sizeof(sparse_header_t))
+		return size;
+	if (!is_sparse_image(data) ||
+	    sparse_header->file_hdr_sz < sizeof(sparse_header_t) ||
+	    sparse_header->chunk_hdr_sz < sizeof(chunk_header_t))
+		return sizeof(sparse_header_t);
+
+	len = sparse_header->file_hdr_sz;
+	chunk_hdr_sz = sparse_header->chunk_hdr_sz;
+	for (chunk = 0; chunk < sparse_header->total_chunks; chunk++) {
+		if (len > size || size - len < chunk_hdr_sz)
+			return size;
+		chunk_header = data + len;
+		if (chunk_header->total_sz < chunk_hdr_sz)
+			return len + chunk_hdr_sz;
+		if (size - len < chunk_header->total_sz)
+			return size;
+		len += chunk_header->total_sz;
 	}
 
+	return min(len, size);
+}
+
+int write_sparse_image(struct sparse_storage *info, const char *part_name,
+		       void *data, size_t size, char *response)
+{
+	struct sparse_stream stream;
+	int ret;
+
+	sparse_stream_start(&stream, info, part_name);
+	ret = sparse_stream_write(&stream, data, sparse_image_len(data, size),
+				  response);
+	if (sparse_stream_finish(&stream, response) || ret)
+		return -1;
+
 	return 0;
 }
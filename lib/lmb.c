@@ -95,14 +95,70 @@ static long lmb_regions_adjacent(struct lmb_region *rgn, unsigned long r1,
 
 static void lmb_remove_region(struct lmb_region *rgn, unsigned long r)
 {
-	unsigned long i;
+	memmove(&rgn->region[r], &rgn->region[r + 1],
+		(rgn->cnt - r - 1) * sizeof(rgn->region[0]));
+	rgn->cnt--;
+}
+
+/**
+ * lmb_find_region() - find the first region which ends at or above an address
+ *
+ * The regions are kept sorted and do not overlap, so their end addresses are
+ * sorted too and a binary search can be used.
+ *
+ * @rgn:	region set to search
+ * @addr:	address to look for
+ * Return:	index of the first region whose last byte is at or above @addr,
+ *		or rgn->cnt if there is none
+ */
+static unsigned long lmb_find_region(struct lmb_region *rgn, phys_addr_t addr)
+{
+	unsigned long lo = 0, hi = rgn->cnt;
 
-	for (i = r; i < rgn->cnt - 1; i++) {
-		rgn->region[i].base = rgn->region[i + 1].base;
-		rgn->region[i].size = rgn->region[i + 1].size;
-		rgn->region[i].flags = rgn->region[i + 1].flags;
+	while (lo < hi) {
+		unsigned long mid = lo + (hi - lo) / 2;
+		struct lmb_property *prop = &rgn->region[mid];
+
+		if (prop->base + prop->size - 1 < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-	rgn->cnt--;
+
+	return lo;
+}
+
+/**
+ * lmb_grow_region() - make space for another region
+ *
+ * With CONFIG_LMB_DYNAMIC_REGIONS the region array is moved to a larger one on
+ * the heap once the statically allocated array is full.
+ *
+ * @rgn:	region set which needs space for another entry
+ * Return:	0 if there is space, -1 if the set is full
+ */
+static int lmb_grow_region(struct lmb_region *rgn)
+{
+#if IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS)
+	struct lmb_property *region;
+
+	if (rgn->cnt < rgn->max)
+		return 0;
+
+	region = malloc(rgn->max * 2 * sizeof(*region));
+	if (!region)
+		return -1;
+	memcpy(region, rgn->region, rgn->cnt * sizeof(*region));
+	if (rgn->allocated)
+		free(rgn->region);
+	rgn->region = region;
+	rgn->max *= 2;
+	rgn->allocated = true;
+
+	return 0;
+#else
+	return rgn->cnt < rgn->max ? 0 : -1;
+#endif
 }
 
 /* Assumption: base addr of region 1 < base addr of region 2 */
@@ -138,13 +194,31 @@ void lmb_init(struct lmb *lmb)
 #else
 	lmb->memory.max = CONFIG_LMB_MEMORY_REGIONS;
 	lmb->reserved.max = CONFIG_LMB_RESERVED_REGIONS;
+#endif
+#if !IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS) || \
+	IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS)
 	lmb->memory.region = lmb->memory_regions;
 	lmb->reserved.region = lmb->reserved_regions;
+#endif
+#if IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS)
+	lmb->memory.allocated = false;
+	lmb->reserved.allocated = false;
 #endif
 	lmb->memory.cnt = 0;
 	lmb->reserved.cnt = 0;
 }
 
+void lmb_uninit(struct lmb *lmb)
+{
+#if IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS)
+	if (lmb->memory.allocated)
+		free(lmb->memory.region);
+	if (lmb->reserved.allocated)
+		free(lmb->reserved.region);
+	lmb_init(lmb);
+#endif
+}
+
 void arch_lmb_reserve_generic(struct lmb *lmb, ulong sp, ulong end, ulong align)
 {
 	ulong bank_end;
@@ -267,13 +341,25 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 		return 0;
 	}
 
-	/* First try and coalesce this LMB with another. */
-	for (i = 0; i < rgn->cnt; i++) {
+	/*
+	 * First try and coalesce this LMB with another. Only the regions from
+	 * the one just below @base up to the one just above the end can touch
+	 * it, so skip the others.
+	 */
+	i = lmb_find_region(rgn, base);
+	if (i > 0 && rgn->region[i - 1].base + rgn->region[i - 1].size == base)
+		i--;
+	for (; i < rgn->cnt; i++) {
 		phys_addr_t rgnbase = rgn->region[i].base;
 		phys_size_t rgnsize = rgn->region[i].size;
 		phys_size_t rgnflags = rgn->region[i].flags;
 		phys_addr_t end = base + size - 1;
 		phys_addr_t rgnend = rgnbase + rgnsize - 1;
+
+		if (rgnbase > end && rgnbase != end + 1) {
+			/* this and all following regions are above the LMB */
+			break;
+		}
 		if (rgnbase <= base && end <= rgnend) {
 			if (flags == rgnflags)
 				/* Already have this region, so we're done */
@@ -302,7 +388,8 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 		}
 	}
 
-	if (i < rgn->cnt - 1 && rgn->region[i].flags == rgn->region[i + 1].flags)  {
+	if (coalesced && i < rgn->cnt - 1 &&
+	    rgn->region[i].flags == rgn->region[i + 1].flags) {
 		if (lmb_regions_adjacent(rgn, i, i + 1)) {
 			lmb_coalesce_regions(rgn, i, i + 1);
 			coalesced++;
@@ -315,29 +402,16 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 
 	if (coalesced)
 		return coalesced;
-	if (rgn->cnt >= rgn->max)
+	if (lmb_grow_region(rgn))
 		return -1;
 
 	/* Couldn't coalesce the LMB, so add it to the sorted table. */
-	for (i = rgn->cnt-1; i >= 0; i--) {
-		if (base < rgn->region[i].base) {
-			rgn->region[i + 1].base = rgn->region[i].base;
-			rgn->region[i + 1].size = rgn->region[i].size;
-			rgn->region[i + 1].flags = rgn->region[i].flags;
-		} else {
-			rgn->region[i + 1].base = base;
-			rgn->region[i + 1].size = size;
-			rgn->region[i + 1].flags = flags;
-			break;
-		}
-	}
-
-	if (base < rgn->region[0].base) {
-		rgn->region[0].base = base;
-		rgn->region[0].size = size;
-		rgn->region[0].flags = flags;
-	}
-
+	i = lmb_find_region(rgn, base);
+	memmove(&rgn->region[i + 1], &rgn->region[i],
+		(rgn->cnt - i) * sizeof(rgn->region[0]));
+	rgn->region[i].base = base;
+	rgn->region[i].size = size;
+	rgn->region[i].flags = flags;
 	rgn->cnt++;
 
 	return 0;
@@ -362,22 +436,18 @@ long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 	struct lmb_region *rgn = &(lmb->reserved);
 	phys_addr_t rgnbegin, rgnend;
 	phys_addr_t end = base + size - 1;
-	int i;
-
-	rgnbegin = rgnend = 0; /* supress gcc warnings */
+	unsigned long i;
 
 	/* Find the region where (base, size) belongs to */
-	for (i = 0; i < rgn->cnt; i++) {
-		rgnbegin = rgn->region[i].base;
-		rgnend = rgnbegin + rgn->region[i].size - 1;
-
-		if ((rgnbegin <= base) && (end <= rgnend))
-			break;
-	}
+	i = lmb_find_region(rgn, base);
 
 	/* Didn't find the region */
 	if (i == rgn->cnt)
 		return -1;
+	rgnbegin = rgn->region[i].base;
+	rgnend = rgnbegin + rgn->region[i].size - 1;
+	if (rgnbegin > base || end > rgnend)
+		return -1;
 
 	/* Check to see if we are removing entire region */
 	if ((rgnbegin == base) && (rgnend == end)) {
@@ -425,14 +495,13 @@ static long lmb_overlaps_region(struct lmb_region *rgn, phys_addr_t base,
 {
 	unsigned long i;
 
-	for (i = 0; i < rgn->cnt; i++) {
-		phys_addr_t rgnbase = rgn->region[i].base;
-		phys_size_t rgnsize = rgn->region[i].size;
-		if (lmb_addrs_overlap(base, size, rgnbase, rgnsize))
-			break;
-	}
+	/* Only the first region ending at or above @base can be the first hit */
+	i = lmb_find_region(rgn, base);
+	if (i < rgn->cnt && lmb_addrs_overlap(base, size, rgn->region[i].base,
+					      rgn->region[i].size))
+		return i;
 
-	return (i < rgn->cnt) ? i : -1;
+	return -1;
 }
 
 phys_addr_t lmb_alloc(struct lmb *lmb, phys_size_t size, ulong align)
@@ -528,22 +597,20 @@ phys_addr_t lmb_alloc_addr(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 /* Return number of bytes from a given address that are free */
 phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr)
 {
-	int i;
+	unsigned long i;
 	long rgn;
 
 	/* check if the requested address is in the memory regions */
 	rgn = lmb_overlaps_region(&lmb->memory, addr, 1);
 	if (rgn >= 0) {
-		for (i = 0; i < lmb->reserved.cnt; i++) {
+		i = lmb_find_region(&lmb->reserved, addr);
+		if (i < lmb->reserved.cnt) {
 			if (addr < lmb->reserved.region[i].base) {
 				/* first reserved range > requested address */
 				return lmb->reserved.region[i].base - addr;
 			}
-			if (lmb->reserved.region[i].base +
-			    lmb->reserved.region[i].size > addr) {
-				/* requested addr is in this reserved range */
-				return 0;
-			}
+			/* requested addr is in this reserved range */
+			return 0;
 		}
 		/* if we come here: no reserved ranges above requested addr */
 		return lmb->memory.region[lmb->memory.cnt - 1].base +
@@ -554,14 +621,12 @@ phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr)
 
 int lmb_is_reserved_flags(struct lmb *lmb, phys_addr_t addr, int flags)
 {
-	int i;
+	unsigned long i;
+
+	i = lmb_find_region(&lmb->reserved, addr);
+	if (i < lmb->reserved.cnt && addr >= lmb->reserved.region[i].base)
+		return (lmb->reserved.region[i].flags & flags) == flags;
 
-	for (i = 0; i < lmb->reserved.cnt; i++) {
-		phys_addr_t upper = lmb->reserved.region[i].base +
-			lmb->reserved.region[i].size - 1;
-		if ((addr >= lmb->reserved.region[i].base) && (addr <= upper))
-			return (lmb->reserved.region[i].flags & flags) == flags;
-	}
 	return 0;
 }
 
@@ -5,7 +5,9 @@
 #include <watchdog.h>
 #include "LzmaDec.h"
 
+#include <linux/compiler.h>
 #include <linux/string.h>
+#include <asm/unaligned.h>
 
 #define kNumTopBits 24
 #define kTopValue ((UInt32)1 << kNumTopBits)
@@ -26,6 +28,18 @@
   { UPDATE_1(p); i = (i + i) + 1; A1; }
 #define GET_BIT(p, i) GET_BIT2(p, i, ; , ;)
 
+/*
+ * U-Boot: the fast path decodes literal bits without branching on their value,
+ * which is hard to predict. The mask m is all ones for a 1 bit and 0 for a 0 bit
+ */
+#define GET_BIT_FAST(p, i, m) ttt = *(p); NORMALIZE; \
+  bound = (range >> kNumBitModelTotalBits) * ttt; \
+  m = (UInt32)0 - (UInt32)(code >= bound); \
+  range = (bound & ~m) | ((range - bound) & m); code -= bound & m; \
+  *(p) = (CLzmaProb)(ttt + (((kBitModelTotal - ttt) >> kNumMoveBits) & ~m) - \
+                     ((ttt >> kNumMoveBits) & m)); \
+  i = (i + i) - m;
+
 #define TREE_GET_BIT(probs, i) { GET_BIT((probs + i), i); }
 #define TREE_DECODE(probs, limit, i) \
   { i = 1; do { TREE_GET_BIT(probs, i); } while (i < limit); i -= limit; }
@@ -130,7 +144,39 @@ Out:
     = kMatchSpecLenStart + 2 : State Init Marker
 */
 
-static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte *bufLimit)
+/*
+ * U-Boot: copy a match of len bytes from dist bytes back, for the fast path,
+ * where the dictionary does not wrap. The source may overlap the destination
+ */
+static __always_inline void LzmaDec_CopyMatch(Byte *dest, SizeT dist, unsigned len)
+{
+  const Byte *src = dest - dist;
+
+  if (dist >= sizeof(ulong))
+  {
+    for (; len >= sizeof(ulong); len -= sizeof(ulong))
+    {
+      put_unaligned(get_unaligned((const ulong *)src), (ulong *)dest);
+      src += sizeof(ulong);
+      dest += sizeof(ulong);
+    }
+  }
+  else if (dist == 1)
+  {
+    memset(dest, *src, len);
+    return;
+  }
+  while (len-- != 0)
+    *dest++ = *src++;
+}
+
+/*
+ * U-Boot: fast is a constant, so this is built twice: as the generic SDK
+ * decoder and as a faster one for a dictionary which never wraps, which is the
+ * case when decoding straight into the output buffer (see LzmaDecode())
+ */
+static __always_inline int LzmaDec_DecodeRealBody(CLzmaDec *p, SizeT limit, const Byte *bufLimit,
+    const Bool fast)
 {
   CLzmaProb *probs = p->probs;
 
@@ -178,7 +224,41 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
         state -= (state < 4) ? state : 3;
         symbol = 1;
 
-        do { GET_BIT(prob + symbol, symbol) } while (symbol < 0x100);
+        if (fast)
+        {
+          UInt32 m;
+
+          GET_BIT_FAST(prob + symbol, symbol, m);
+          GET_BIT_FAST(prob + symbol, symbol, m);
+          GET_BIT_FAST(prob + symbol, symbol, m);
+          GET_BIT_FAST(prob + symbol, symbol, m);
+          GET_BIT_FAST(prob + symbol, symbol, m);
+          GET_BIT_FAST(prob + symbol, symbol, m);
+          GET_BIT_FAST(prob + symbol, symbol, m);
+          GET_BIT_FAST(prob + symbol, symbol, m);
+        }
+        else
+          do { GET_BIT(prob + symbol, symbol) } while (symbol < 0x100);
+      }
+      else if (fast)
+      {
+        unsigned matchByte = dic[dicPos - rep0];
+        unsigned offs = 0x100;
+        state -= (state < 10) ? 3 : 6;
+        symbol = 1;
+
+        do
+        {
+          unsigned bit;
+          CLzmaProb *probLit;
+          UInt32 m;
+          matchByte <<= 1;
+          bit = (matchByte & offs);
+          probLit = prob + offs + bit + symbol;
+          GET_BIT_FAST(probLit, symbol, m);
+          offs &= bit ^ ~m;
+        }
+        while (symbol < 0x100);
       }
       else
       {
@@ -395,7 +475,12 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
         processedPos += curLen;
 
         len -= curLen;
-        if (pos + curLen <= dicBufSize)
+        if (fast)
+        {
+          LzmaDec_CopyMatch(dic + dicPos, rep0, curLen);
+          dicPos += curLen;
+        }
+        else if (pos + curLen <= dicBufSize)
         {
           Byte *dest = dic + dicPos;
           ptrdiff_t src = (ptrdiff_t)pos - (ptrdiff_t)dicPos;
@@ -440,6 +525,16 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
   return SZ_OK;
 }
 
+static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte *bufLimit)
+{
+  return LzmaDec_DecodeRealBody(p, limit, bufLimit, False);
+}
+
+static int MY_FAST_CALL LzmaDec_DecodeRealFast(CLzmaDec *p, SizeT limit, const Byte *bufLimit)
+{
+  return LzmaDec_DecodeRealBody(p, limit, bufLimit, True);
+}
+
 static void MY_FAST_CALL LzmaDec_WriteRem(CLzmaDec *p, SizeT limit)
 {
   if (p->remainLen != 0 && p->remainLen < kMatchSpecLenStart)
@@ -477,7 +572,9 @@ static int MY_FAST_CALL LzmaDec_DecodeReal2(CLzmaDec *p, SizeT limit, const Byte
       if (limit - p->dicPos > rem)
         limit2 = p->dicPos + rem;
     }
-    RINOK(LzmaDec_DecodeReal(p, limit2, bufLimit));
+    RINOK(CONFIG_IS_ENABLED(LZMA_FAST) && p->dicFlat ?
+          LzmaDec_DecodeRealFast(p, limit2, bufLimit) :
+          LzmaDec_DecodeReal(p, limit2, bufLimit));
     if (p->processedPos >= p->prop.dicSize)
       p->checkDicSize = p->prop.dicSize;
     LzmaDec_WriteRem(p, limit);
@@ -981,9 +1078,9 @@ SRes LzmaDec_Allocate(CLzmaDec *p, const Byte *props, unsigned propsSize, ISzAll
   return SZ_OK;
 }
 
-SRes LzmaDecode(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen,
+static SRes LzmaDecode2(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen,
     const Byte *propData, unsigned propSize, ELzmaFinishMode finishMode,
-    ELzmaStatus *status, ISzAlloc *alloc)
+    ELzmaStatus *status, ISzAlloc *alloc, Bool fast)
 {
   CLzmaDec p;
   SRes res;
@@ -999,6 +1096,7 @@ SRes LzmaDecode(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen,
     return res;
   p.dic = dest;
   p.dicBufSize = outSize;
+  p.dicFlat = fast;
 
   LzmaDec_Init(&p);
 
@@ -1012,3 +1110,19 @@ SRes LzmaDecode(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen,
   LzmaDec_FreeProbs(&p, alloc);
   return res;
 }
+
+SRes LzmaDecode(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen,
+    const Byte *propData, unsigned propSize, ELzmaFinishMode finishMode,
+    ELzmaStatus *status, ISzAlloc *alloc)
+{
+  return LzmaDecode2(dest, destLen, src, srcLen, propData, propSize,
+                     finishMode, status, alloc, True);
+}
+
+SRes LzmaDecodeGeneric(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen,
+    const Byte *propData, unsigned propSize, ELzmaFinishMode finishMode,
+    ELzmaStatus *status, ISzAlloc *alloc)
+{
+  return LzmaDecode2(dest, destLen, src, srcLen, propData, propSize,
+                     finishMode, status, alloc, False);
+}
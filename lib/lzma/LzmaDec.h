@@ -62,9 +62,10 @@ typedef struct
   UInt32 numProbs;
   unsigned tempBufSize;
   Byte tempBuf[LZMA_REQUIRED_INPUT_MAX];
+  Bool dicFlat; /* U-Boot: dic is the whole output and never wraps */
 } CLzmaDec;
 
-#define LzmaDec_Construct(p) { (p)->dic = 0; (p)->probs = 0; }
+#define LzmaDec_Construct(p) { (p)->dic = 0; (p)->probs = 0; (p)->dicFlat = False; }
 
 void LzmaDec_Init(CLzmaDec *p);
 
@@ -220,4 +221,13 @@ SRes LzmaDecode(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen,
     const Byte *propData, unsigned propSize, ELzmaFinishMode finishMode,
     ELzmaStatus *status, ISzAlloc *alloc);
 
+/* U-Boot: LzmaDecodeGeneric
+   The same as LzmaDecode(), but always uses the generic decoder, not the fast
+   one enabled by CONFIG_LZMA_FAST. This is useful to compare the two.
+*/
+
+SRes LzmaDecodeGeneric(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen,
+    const Byte *propData, unsigned propSize, ELzmaFinishMode finishMode,
+    ELzmaStatus *status, ISzAlloc *alloc);
+
 #endif
@@ -36,8 +36,8 @@
 static void *SzAlloc(void *p, size_t size) { return malloc(size); }
 static void SzFree(void *p, void *address) { free(address); }
 
-int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
-			     const unsigned char *inStream, SizeT length)
+static int lzmaDecompress(unsigned char *outStream, SizeT *uncompressedSize,
+			  const unsigned char *inStream, SizeT length, bool fast)
 {
     int res = SZ_ERROR_DATA;
     int i;
@@ -105,7 +105,7 @@ int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
 
     schedule();
 
-    res = LzmaDecode(
+    res = (fast ? LzmaDecode : LzmaDecodeGeneric)(
         outStream, &outProcessed,
         inStream + LZMA_DATA_OFFSET, &compressedSize,
         inStream, LZMA_PROPS_SIZE, LZMA_FINISH_END, &state, &g_Alloc);
@@ -120,4 +120,17 @@ int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
     return res;
 }
 
+int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
+			     const unsigned char *inStream, SizeT length)
+{
+    return lzmaDecompress(outStream, uncompressedSize, inStream, length, true);
+}
+
+int lzmaBuffToBuffDecompressGeneric(unsigned char *outStream,
+				    SizeT *uncompressedSize,
+				    const unsigned char *inStream, SizeT length)
+{
+    return lzmaDecompress(outStream, uncompressedSize, inStream, length, false);
+}
+
 #endif
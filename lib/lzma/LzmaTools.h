@@ -28,4 +28,24 @@
 int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
 			     const unsigned char *inStream, SizeT length);
 
+/**
+ * lzmaBuffToBuffDecompressGeneric() - Decompress LZMA data, the slow way
+ *
+ * This is the same as lzmaBuffToBuffDecompress() but always uses the generic
+ * LZMA SDK decoder, even if CONFIG_LZMA_FAST is enabled. It is intended for
+ * comparing the two decoders.
+ *
+ * @outStream: output buffer
+ * @uncompressedSize: On entry, the maximum uncompressed size of the data;
+ *	on exit, the actual uncompressed size after processing
+ * @inStream: Compressed bytes to decompress
+ * @length: Sizeof @inStream
+ * @return 0 if OK, SZ_ERROR_DATA if the data is in a format that cannot be
+ *	decompressed; SZ_ERROR_OUTPUT_EOF if *uncompressedSize is too small;
+ *	see also other SZ_ERROR... values
+ */
+int lzmaBuffToBuffDecompressGeneric(unsigned char *outStream,
+				    SizeT *uncompressedSize,
+				    const unsigned char *inStream, SizeT length);
+
 #endif
@@ -260,6 +260,115 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	return mem;
 }
 
+/**
+ * unflatten_dt_name_size() - Get the size of the value of a "name" property
+ *
+ * @pathp: Node name, as passed to unflatten_dt_node()
+ * Return: size of the node name without the unit address, including the
+ * terminating zero
+ */
+static int unflatten_dt_name_size(const char *pathp)
+{
+	const char *p1 = pathp, *ps = pathp, *pa = NULL;
+
+	while (*p1) {
+		if ((*p1) == '@')
+			pa = p1;
+		if ((*p1) == '/')
+			ps = p1 + 1;
+		p1++;
+	}
+	if (pa < ps)
+		pa = p1;
+
+	return (pa - ps) + 1;
+}
+
+/**
+ * unflatten_dt_size() - Work out the memory needed to unflatten a node
+ *
+ * This gives the same result as a dry run of unflatten_dt_node(), but walks
+ * the structure block once instead of looking up every property and then
+ * skipping over them again to find the next node.
+ *
+ * @blob: The flat device tree
+ * @poffset: Offset of the node, updated to the offset after its end tag
+ * @size: Memory used so far, updated to include the node and its subnodes
+ * @fpsize: Size of the node path up at the current depth
+ * Return: 0 if OK, -ve FDT_ERR_... on error
+ */
+static int unflatten_dt_size(const void *blob, int *poffset,
+			     unsigned long *size, unsigned long fpsize)
+{
+	const struct fdt_property *prop;
+	const char *pathp, *pname;
+	bool has_name = false, props_done = false;
+	int offset, next, l, allocl, ret;
+	uint32_t tag;
+
+	pathp = fdt_get_name(blob, *poffset, &l);
+	if (!pathp)
+		return l;
+
+	allocl = ++l;
+	if ((*pathp) != '/') {
+		if (fpsize == 0) {
+			fpsize = 1;
+			allocl = 2;
+			pathp = "";
+		} else {
+			fpsize += l;
+			allocl = fpsize;
+		}
+	}
+	*size = ALIGN(*size, __alignof__(struct device_node)) +
+		sizeof(struct device_node) + allocl;
+
+	fdt_next_tag(blob, *poffset, &offset);
+	while (1) {
+		tag = fdt_next_tag(blob, offset, &next);
+		if (next < 0)
+			return next;
+
+		/* Properties come first, then the "name" one made up for us */
+		if (!props_done && tag != FDT_PROP && tag != FDT_NOP) {
+			props_done = true;
+			if (!has_name)
+				*size = ALIGN(*size,
+					      __alignof__(struct property)) +
+					sizeof(struct property) +
+					unflatten_dt_name_size(pathp);
+		}
+
+		switch (tag) {
+		case FDT_PROP:
+			prop = fdt_offset_ptr(blob, offset, sizeof(*prop));
+			if (!prop)
+				return -FDT_ERR_BADSTRUCTURE;
+			pname = fdt_string(blob, fdt32_to_cpu(prop->nameoff));
+			if (pname && !strcmp(pname, "name"))
+				has_name = true;
+			*size = ALIGN(*size, __alignof__(struct property)) +
+				sizeof(struct property);
+			offset = next;
+			break;
+		case FDT_NOP:
+			offset = next;
+			break;
+		case FDT_BEGIN_NODE:
+			ret = unflatten_dt_size(blob, &offset, size, fpsize);
+			if (ret)
+				return ret;
+			break;
+		case FDT_END_NODE:
+			*poffset = next;
+			return 0;
+		default:
+			return -FDT_ERR_BADSTRUCTURE;
+		}
+	}
+}
+
 int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 {
 	unsigned long size;
@@ -285,10 +394,15 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 
 	/* First pass, scan for size */
 	start = 0;
-	size = (unsigned long)unflatten_dt_node(blob, NULL, &start, NULL, NULL,
-						0, true);
-	if (!size)
+	size = 0;
+	if (unflatten_dt_size(blob, &start, &size, 0) || !size)
 		return -EFAULT;
+#ifdef DEBUG
+	start = 0;
+	if ((unsigned long)unflatten_dt_node(blob, NULL, &start, NULL, NULL,
+					     0, true) != size)
+		debug("Size scan does not match dry run\n");
+#endif
 	size = ALIGN(size, 4);
 
 	debug("  size is %lx, allocating...\n", size);
@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Statistical profiler
+ *
+ * Samples of the program counter are added up in a small open-addressed hash
+ * table, keyed by the link-time address, so that the result can be looked up
+ * in u-boot.map or with addr2line. Samples come either from a periodic timer
+ * interrupt provided by the architecture or from calls to schedule().
+ */
+
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <profile.h>
+#include <sort.h>
+#include <time.h>
+#include <asm/global_data.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	BUCKET_COUNT	= CONFIG_PROFILER_BUCKETS,
+	/* Number of buckets to try before giving up on a new program counter */
+	MAX_PROBES	= 16,
+};
+
+/**
+ * struct profile_state - State of the profiler
+ *
+ * @bucket: Hash table of samples; an empty bucket has a weight of 0
+ * @info: Summary of the samples
+ * @last_us: Time of the last poll, for PROFILE_SRC_POLL
+ */
+static struct profile_state {
+	struct profile_entry *bucket;
+	struct profile_info info;
+	ulong last_us;
+} state;
+
+static void profile_add(ulong pc, ulong weight)
+{
+	struct profile_info *info = &state.info;
+	uint i, idx;
+
+	if (!weight)
+		return;
+	pc -= gd->reloc_off;
+	info->samples++;
+	info->total += weight;
+
+	/* Fibonacci hashing; instructions are at least 2-byte aligned */
+	idx = (u32)((pc >> 1) * 0x9e3779b1U) % BUCKET_COUNT;
+	for (i = 0; i < MAX_PROBES; i++) {
+		struct profile_entry *ent = &state.bucket[idx];
+
+		if (!ent->weight)
+			ent->pc = pc;
+		if (ent->pc == pc) {
+			ent->weight += weight;
+			return;
+		}
+		idx = (idx + 1) % BUCKET_COUNT;
+	}
+	info->dropped += weight;
+}
+
+void profile_tick(ulong pc)
+{
+	if (state.info.active && state.info.src == PROFILE_SRC_TIMER)
+		profile_add(pc, 1);
+}
+
+void profile_poll(ulong pc)
+{
+	ulong now;
+
+	if (!state.info.active || state.info.src != PROFILE_SRC_POLL)
+		return;
+	now = timer_get_us();
+	profile_add(pc, now - state.last_us);
+	state.last_us = now;
+}
+
+__weak int arch_profile_start(uint interval_us)
+{
+	return -ENOSYS;
+}
+
+__weak void arch_profile_stop(void)
+{
+}
+
+int profile_start(enum profile_src src, uint interval_us)
+{
+	int ret;
+
+	profile_stop();
+	if (src == PROFILE_SRC_POLL && !IS_ENABLED(CONFIG_CYCLIC))
+		return -ENOSYS;
+	if (!state.bucket) {
+		state.bucket = calloc(BUCKET_COUNT, sizeof(*state.bucket));
+		if (!state.bucket)
+			return -ENOMEM;
+	} else {
+		memset(state.bucket, '\0', BUCKET_COUNT * sizeof(*state.bucket));
+	}
+	memset(&state.info, '\0', sizeof(state.info));
+	state.info.src = src;
+	state.last_us = timer_get_us();
+	state.info.active = true;
+
+	if (src == PROFILE_SRC_TIMER) {
+		ret = arch_profile_start(interval_us);
+		if (ret) {
+			state.info.active = false;
+			return log_msg_ret("arc", ret);
+		}
+	}
+
+	return 0;
+}
+
+void profile_stop(void)
+{
+	if (!state.info.active)
+		return;
+	if (state.info.src == PROFILE_SRC_TIMER)
+		arch_profile_stop();
+	state.info.active = false;
+}
+
+void profile_get_info(struct profile_info *info)
+{
+	*info = state.info;
+}
+
+static int h_cmp_weight(const void *v1, const void *v2)
+{
+	const struct profile_entry *e1 = v1, *e2 = v2;
+
+	if (e1->weight != e2->weight)
+		return e1->weight < e2->weight ? 1 : -1;
+
+	return e1->pc < e2->pc ? -1 : e1->pc > e2->pc;
+}
+
+int profile_get_top(struct profile_entry *ent, int count)
+{
+	struct profile_entry *list;
+	bool active = state.info.active;
+	int i, used;
+
+	if (!state.bucket)
+		return 0;
+	list = malloc(BUCKET_COUNT * sizeof(*list));
+	if (!list)
+		return -ENOMEM;
+
+	/* Don't let new samples arrive while copying */
+	state.info.active = false;
+	for (i = 0, used = 0; i < BUCKET_COUNT; i++) {
+		if (state.bucket[i].weight)
+			list[used++] = state.bucket[i];
+	}
+	state.info.active = active;
+
+	qsort(list, used, sizeof(*list), h_cmp_weight);
+	count = min(count, used);
+	memcpy(ent, list, count * sizeof(*ent));
+	free(list);
+
+	return count;
+}
@@ -12,6 +12,77 @@
 
 #ifndef ASMINF
 
+#include <asm/unaligned.h>
+
+/*
+   U-Boot: with CONFIG_ZLIB_WORD_ACCESS the bit accumulator is a whole machine
+   word and is refilled a word at a time, without branches. The refill loads
+   the next sizeof(hold) input bytes at once and ORs them in above the bits
+   already held, then advances 'in' by however many whole bytes fitted. The
+   bits loaded above 'bits' are just the following input, so loading them
+   again on the next refill does not change them. With a 64-bit accumulator
+   one refill is enough for a whole length/distance pair (48 bits), or for up
+   to three literals.
+
+   Matches at least a word back are copied a word at a time. Each copy may
+   write up to sizeof(hold) - 1 bytes past the end of the match, which is
+   allowed for by INFLATE_FAST_MIN_LEFT, and is overwritten by whatever is
+   decoded next.
+
+   This relies on unaligned loads and stores being cheap, so other
+   architectures use zlib's byte-wise code. In particular ARM64 is built with
+   -mstrict-align, which turns every unaligned word access into byte accesses.
+ */
+#define WORD_ACCESS     CONFIG_IS_ENABLED(ZLIB_WORD_ACCESS)
+#define WORD_BYTES      (sizeof(unsigned long))
+#define WORD_BITS       (WORD_BYTES * 8)
+
+#define REFILL() \
+    do { \
+        hold |= load_word(in) << bits; \
+        in += (WORD_BITS - 1 - bits) >> 3; \
+        bits |= WORD_BITS - 8; \
+    } while (0)
+
+local unsigned long load_word(const unsigned char FAR *p)
+{
+    if (WORD_BYTES == 8)
+        return get_unaligned_le64(p);
+    return get_unaligned_le32(p);
+}
+
+local unsigned char FAR *copy_match(unsigned char FAR *out,
+                                    const unsigned char FAR *from,
+                                    unsigned len, unsigned dist)
+{
+    unsigned char FAR *end = out + len;
+
+    if (dist >= WORD_BYTES) {
+        /* each word read was written before this copy, or earlier in it */
+        do {
+            put_unaligned(get_unaligned((unsigned long *)from),
+                          (unsigned long *)out);
+            out += WORD_BYTES;
+            from += WORD_BYTES;
+        } while (out < end);
+    }
+    else if (dist == 1) {
+        unsigned long pattern = *from * (~0UL / 0xff);
+
+        do {
+            put_unaligned(pattern, (unsigned long *)out);
+            out += WORD_BYTES;
+        } while (out < end);
+    }
+    else {
+        do {
+            *out++ = *from++;
+        } while (out < end);
+    }
+
+    return end;
+}
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -23,8 +94,8 @@
    Entry assumptions:
 
         state->mode == LEN
-        strm->avail_in >= 6
-        strm->avail_out >= 258
+        strm->avail_in >= INFLATE_FAST_MIN_HAVE
+        strm->avail_out >= INFLATE_FAST_MIN_LEFT
         start >= strm->avail_out
         state->bits < 8
 
@@ -39,13 +110,16 @@
     - The maximum input bits used by a length/distance pair is 15 bits for the
       length code, 5 bits for the length extra, 15 bits for the distance code,
       and 13 bits for the distance extra.  This totals 48 bits, or six bytes.
-      Therefore if strm->avail_in >= 6, then there is enough input to avoid
-      checking for available input while decoding.
+      Each refill may read a word beyond the bits it keeps, and 'in' may be up
+      to a word ahead of the bits actually used, so if there are at least
+      INFLATE_FAST_MIN_HAVE bytes left there is no need to check for available
+      input while decoding.
 
     - The maximum bytes that a single length/distance pair can output is 258
-      bytes, which is the maximum length that can be coded.  inflate_fast()
-      requires strm->avail_out >= 258 for each loop to avoid checking for
-      output space.
+      bytes, which is the maximum length that can be coded, plus up to a word
+      of overrun from the match copy and two literals decoded just before it.
+      inflate_fast() requires strm->avail_out >= INFLATE_FAST_MIN_LEFT for
+      each loop to avoid checking for output space.
  */
 void ZLIB_INTERNAL inflate_fast(strm, start)
 z_streamp strm;
@@ -80,18 +154,18 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     /* copy state to local variables */
     state = (struct inflate_state FAR *)strm->state;
     in = strm->next_in;
-    last = in + (strm->avail_in - 5);
-    if (in > last && strm->avail_in > 5) {
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_HAVE - 1));
+    if (in > last && strm->avail_in > INFLATE_FAST_MIN_HAVE - 1) {
         /*
          * overflow detected, limit strm->avail_in to the
          * max. possible size and recalculate last
          */
 	strm->avail_in = 0xffffffff - (uintptr_t)in;
-        last = in + (strm->avail_in - 5);
+        last = in + (strm->avail_in - (INFLATE_FAST_MIN_HAVE - 1));
     }
     out = strm->next_out;
     beg = out - (start - strm->avail_out);
-    end = out + (strm->avail_out - 257);
+    end = out + (strm->avail_out - (INFLATE_FAST_MIN_LEFT - 1));
 #ifdef INFLATE_STRICT
     dmax = state->dmax;
 #endif
@@ -109,13 +183,35 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
-        if (bits < 15) {
+        if (WORD_ACCESS) {
+            REFILL();
+        }
+        else if (bits < 15) {
             hold += (unsigned long)(*in++) << bits;
             bits += 8;
             hold += (unsigned long)(*in++) << bits;
             bits += 8;
         }
         here = lcode[hold & lmask];
+        if (WORD_ACCESS && WORD_BYTES == 8 && here.op == 0) {
+            /* a run of literals: there are enough bits for three codes */
+            hold >>= here.bits;
+            bits -= here.bits;
+            *out++ = (unsigned char)(here.val);
+            here = lcode[hold & lmask];
+            if (here.op == 0) {
+                hold >>= here.bits;
+                bits -= here.bits;
+                *out++ = (unsigned char)(here.val);
+                here = lcode[hold & lmask];
+            }
+            if (here.op == 0) {
+                hold >>= here.bits;
+                bits -= here.bits;
+                *out++ = (unsigned char)(here.val);
+                continue;
+            }
+        }
       dolen:
         op = (unsigned)(here.bits);
         hold >>= op;
@@ -131,7 +227,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
             len = (unsigned)(here.val);
             op &= 15;                           /* number of extra bits */
             if (op) {
-                if (bits < op) {
+                if (!WORD_ACCESS && bits < op) {
                     hold += (unsigned long)(*in++) << bits;
                     bits += 8;
                 }
@@ -140,7 +236,11 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                 bits -= op;
             }
             Tracevv((stderr, "inflate:         length %u\n", len));
-            if (bits < 15) {
+            if (WORD_ACCESS) {
+                if (WORD_BYTES < 8)
+                    REFILL();
+            }
+            else if (bits < 15) {
                 hold += (unsigned long)(*in++) << bits;
                 bits += 8;
                 hold += (unsigned long)(*in++) << bits;
@@ -155,7 +255,10 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
             if (op & 16) {                      /* distance base */
                 dist = (unsigned)(here.val);
                 op &= 15;                       /* number of extra bits */
-                if (bits < op) {
+                if (WORD_ACCESS && bits < op) {
+                    REFILL();
+                }
+                else if (bits < op) {
                     hold += (unsigned long)(*in++) << bits;
                     bits += 8;
                     if (bits < op) {
@@ -235,6 +338,10 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                             *out++ = *from++;
                     }
                 }
+                else if (WORD_ACCESS) {
+                    /* copy direct from output, minimum length is three */
+                    out = copy_match(out, out - dist, len, dist);
+                }
                 else {
                     from = out - dist;          /* copy direct from output */
                     do {                        /* minimum length is three */
@@ -280,14 +387,13 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     len = bits >> 3;
     in -= len;
     bits -= len << 3;
-    hold &= (1U << bits) - 1;
+    hold &= (1UL << bits) - 1;
 
     /* update state and return */
+    strm->avail_in -= (unsigned)(in - strm->next_in);
+    strm->avail_out -= (unsigned)(out - strm->next_out);
     strm->next_in = in;
     strm->next_out = out;
-    strm->avail_in = (unsigned)(in < last ? 5 + (last - in) : 5 - (in - last));
-    strm->avail_out = (unsigned)(out < end ?
-                                 257 + (end - out) : 257 - (out - end));
     state->hold = hold;
     state->bits = bits;
     return;
@@ -8,4 +8,18 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/*
+ * U-Boot: with CONFIG_ZLIB_WORD_ACCESS, inflate_fast() refills its bit buffer
+ * a word at a time, copies matches a word at a time and may write two literals
+ * before a match, so it needs some slack beyond zlib's usual six bytes of
+ * input and 258 bytes of output
+ */
+#if CONFIG_IS_ENABLED(ZLIB_WORD_ACCESS)
+#define INFLATE_FAST_MIN_HAVE   (2 * sizeof(unsigned long) + 6)
+#define INFLATE_FAST_MIN_LEFT   (260 + sizeof(unsigned long))
+#else
+#define INFLATE_FAST_MIN_HAVE   6
+#define INFLATE_FAST_MIN_LEFT   258
+#endif
+
 void inflate_fast OF((z_streamp strm, unsigned start));
@@ -15,6 +15,7 @@
 #include <os.h>
 #include <test/suites.h>
 #include <test/ut.h>
+#include <dm/uclass-internal.h>
 #include "bootstd_common.h"
 
 /* Allow reseting the USB-started flag */
@@ -393,6 +394,59 @@ static int bootdev_test_hunter(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootdev_test_hunter, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
 
+/* Check starting the hunters and finishing later */
+static int bootdev_test_hunt_start(struct unit_test_state *uts)
+{
+	static const char *const mmc_labels[] = {"mmc1", NULL};
+	static const char *const usb_labels[] = {"mmc1", "usb", NULL};
+	struct bootdev_hunter *start, *usb;
+	struct bootstd_priv *std;
+	struct udevice *bus, *dev;
+
+	if (!IS_ENABLED(CONFIG_BOOTSTD_HUNT_START))
+		return -EAGAIN;
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	usb = BOOTDEV_HUNTER_GET(usb_bootdev_hunter);
+
+	usb_started = false;
+	test_set_skip_delays(true);
+	ut_assertok(bootstd_get_priv(&std));
+	ut_assertok(uclass_find_device_by_name(UCLASS_USB, "usb@1", &bus));
+
+	/* Only the hunters for the given labels are started */
+	console_record_reset_enable();
+	ut_assertok(bootdev_hunt_start(mmc_labels, false));
+	ut_assert(!device_active(bus));
+
+	/* Without a boot order nothing is started */
+	ut_assertok(bootdev_hunt_start(NULL, false));
+	ut_assert(!device_active(bus));
+
+	/* USB is powered up but no devices are found yet */
+	ut_assertok(bootdev_hunt_start(usb_labels, false));
+	ut_assert_console_end();
+	ut_assert(device_active(bus));
+	ut_assert(!usb_started);
+	ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_BOOTDEV,
+				"usb_mass_storage.lun0.bootdev", &dev));
+	ut_asserteq(0, std->hunters_used);
+
+	/* The hunt completes the job */
+	ut_assertok(bootdev_hunt("usb", false));
+	ut_assert_nextline(
+		"Bus usb@1: scanning bus usb@1 for devices... 5 USB Device(s) found");
+	ut_assert_console_end();
+	ut_assert(usb_started);
+	ut_assertok(uclass_find_device_by_name(UCLASS_BOOTDEV,
+					       "usb_mass_storage.lun0.bootdev",
+					       &dev));
+	ut_asserteq(BIT(usb - start), std->hunters_used);
+
+	return 0;
+}
+BOOTSTD_TEST(bootdev_test_hunt_start, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
 /* Check 'bootdev hunt' command */
 static int bootdev_test_cmd_hunt(struct unit_test_state *uts)
 {
@@ -14,6 +14,7 @@
 #include <cli.h>
 #include <dm.h>
 #include <efi_default_filename.h>
+#include <env.h>
 #include <expo.h>
 #ifdef CONFIG_SANDBOX
 #include <asm/test.h>
@@ -272,6 +273,77 @@ static int bootflow_scan_boot(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootflow_scan_boot, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
 
+/* Check recording a bootflow and reading it back without a scan */
+static int bootflow_cache(struct unit_test_state *uts)
+{
+	struct bootflow bflow, cached;
+	char rec[BOOTFLOW_CACHE_MAX], bad[BOOTFLOW_CACHE_MAX];
+	struct bootflow_iter iter;
+	struct bootstd_priv *std;
+	char *field;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_BOOTSTD_CACHE))
+		return -EAGAIN;
+
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, NULL));
+	ut_asserteq(-ENOENT, bootflow_cache_read(0, &cached));
+
+	bootstd_clear_glob();
+	ut_assertok(bootflow_scan_first(NULL, "mmc1", &iter,
+					BOOTFLOWIF_SKIP_GLOBAL, &bflow));
+	bootflow_iter_uninit(&iter);
+	ut_asserteq_str("mmc1.bootdev.part_1", bflow.name);
+
+	ut_assertok(bootflow_cache_save(&bflow));
+	ut_assertnonnull(env_get(BOOTFLOW_CACHE_VAR));
+	strlcpy(rec, env_get(BOOTFLOW_CACHE_VAR), sizeof(rec));
+
+	ut_assertok(bootflow_cache_read(0, &cached));
+	ut_asserteq_str(bflow.name, cached.name);
+	ut_asserteq_str(bflow.fname, cached.fname);
+	ut_asserteq(bflow.size, cached.size);
+	ut_asserteq_mem(bflow.buf, cached.buf, bflow.size);
+	bootflow_free(&cached);
+
+	/* A change to the ordering means the bootflow is not used */
+	ut_assertok(env_set("boot_targets", "mmc2 mmc1"));
+	ut_asserteq(-ESTALE, bootflow_cache_read(0, &cached));
+	ut_assertok(env_set("boot_targets", NULL));
+	ut_assertok(bootflow_cache_read(0, &cached));
+	bootflow_free(&cached);
+
+	/* Only the hunter for the recorded uclass is used */
+	ut_assertok(bootstd_get_priv(&std));
+	std->hunters_used = 0;
+	field = strchr(rec, ' ');
+	ut_assertnonnull(field);
+	snprintf(bad, sizeof(bad), "nosuch.bootdev%s", field);
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, bad));
+	ut_asserteq(-ENODEV, bootflow_cache_read(BOOTFLOWIF_HUNT, &cached));
+	ut_asserteq(BIT(MMC_HUNTER), std->hunters_used);
+
+	/* A change to the file means the bootflow is not used */
+	strcpy(bad, rec);
+	for (i = 0, field = bad; i < 5; i++) {
+		field = strchr(field, ' ');
+		ut_assertnonnull(field);
+		field++;
+	}
+	memset(field, '0', 8);
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, bad));
+	ut_asserteq(-ESTALE, bootflow_cache_read(0, &cached));
+
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, "mmc1.bootdev 1"));
+	ut_asserteq(-EINVAL, bootflow_cache_read(0, &cached));
+
+	bootflow_free(&bflow);
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, NULL));
+
+	return 0;
+}
+BOOTSTD_TEST(bootflow_cache, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
 /* Check iterating through available bootflows */
 static int bootflow_iter(struct unit_test_state *uts)
 {
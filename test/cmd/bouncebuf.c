@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for bouncebuf command
+ */
+
+#include <bouncebuf.h>
+#include <console.h>
+#include <malloc.h>
+#include <asm/cache.h>
+#include <test/cmd.h>
+#include <test/ut.h>
+
+#define BUF_SIZE	(ARCH_DMA_MINALIGN * 4)
+
+/* Run a bounce buffer session on @len bytes at @data */
+static int bb_session(struct unit_test_state *uts, void *data, size_t len,
+		      unsigned int flags)
+{
+	struct bounce_buffer state;
+
+	ut_assertok(bounce_buffer_start(&state, data, len, flags));
+	ut_assertok(bounce_buffer_stop(&state));
+
+	return 0;
+}
+
+/* Test that the statistics count bounced transfers */
+static int cmd_bouncebuf_stats(struct unit_test_state *uts)
+{
+	struct bounce_buffer_stats stats;
+	u8 *buf;
+
+	buf = memalign(ARCH_DMA_MINALIGN, BUF_SIZE + ARCH_DMA_MINALIGN);
+	ut_assertnonnull(buf);
+	bounce_buffer_reset_stats();
+
+	/* aligned, so used in place */
+	ut_assertok(bb_session(uts, buf, BUF_SIZE, GEN_BB_RW));
+
+	/* unaligned start */
+	ut_assertok(bb_session(uts, buf + 1, BUF_SIZE, GEN_BB_WRITE));
+
+	/* unaligned length is only a problem if the device writes */
+	ut_assertok(bb_session(uts, buf, BUF_SIZE - 1, GEN_BB_READ));
+	ut_assertok(bb_session(uts, buf, BUF_SIZE - 1, GEN_BB_WRITE));
+
+	bounce_buffer_add_shifted(0x200);
+
+	bounce_buffer_stats(&stats);
+	ut_asserteq(4, stats.sessions);
+	ut_asserteq(2, stats.bounced);
+	ut_asserteq(BUF_SIZE * 2 - 1, stats.bounced_bytes);
+	ut_asserteq(0x200, stats.shifted_bytes);
+
+	/* reading the statistics must not reset them */
+	bounce_buffer_stats(&stats);
+	ut_asserteq(4, stats.sessions);
+
+	bounce_buffer_reset_stats();
+	bounce_buffer_stats(&stats);
+	ut_asserteq(0, stats.sessions);
+	ut_asserteq(0, stats.bounced);
+	ut_asserteq(0, stats.bounced_bytes);
+	ut_asserteq(0, stats.shifted_bytes);
+
+	free(buf);
+
+	return 0;
+}
+CMD_TEST(cmd_bouncebuf_stats, 0);
+
+/* Test the 'bouncebuf show' and 'bouncebuf reset' subcommands */
+static int cmd_bouncebuf_cmd(struct unit_test_state *uts)
+{
+	u8 *buf;
+
+	buf = memalign(ARCH_DMA_MINALIGN, BUF_SIZE + ARCH_DMA_MINALIGN);
+	ut_assertnonnull(buf);
+	bounce_buffer_reset_stats();
+	ut_assertok(bb_session(uts, buf + 1, BUF_SIZE, GEN_BB_RW));
+	ut_assertok(bb_session(uts, buf, BUF_SIZE, GEN_BB_RW));
+	bounce_buffer_add_shifted(0x400);
+	free(buf);
+
+	/* showing twice gives the same values */
+	ut_assertok(console_record_reset_enable());
+	ut_assertok(run_command("bouncebuf show", 0));
+	ut_assert_nextline("sessions: 2");
+	ut_assert_nextline("bounced: 1");
+	ut_assert_nextline("bounced bytes: %d", BUF_SIZE);
+	ut_assert_nextline("shifted bytes: 1024");
+	ut_assert_console_end();
+
+	ut_assertok(run_command("bouncebuf show", 0));
+	ut_assert_nextline("sessions: 2");
+	ut_assert_nextline("bounced: 1");
+	ut_assert_nextline("bounced bytes: %d", BUF_SIZE);
+	ut_assert_nextline("shifted bytes: 1024");
+	ut_assert_console_end();
+
+	ut_assertok(run_command("bouncebuf reset", 0));
+	ut_assert_console_end();
+
+	ut_assertok(run_command("bouncebuf show", 0));
+	ut_assert_nextline("sessions: 0");
+	ut_assert_nextline("bounced: 0");
+	ut_assert_nextline("bounced bytes: 0");
+	ut_assert_nextline("shifted bytes: 0");
+	ut_assert_console_end();
+
+	return 0;
+}
+CMD_TEST(cmd_bouncebuf_cmd, UT_TESTF_CONSOLE_REC);
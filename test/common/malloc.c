@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the small-chunk cache in malloc()
+ */
+
+#include <malloc.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+enum {
+	/* Request size giving the largest chunk which is cached */
+	REQ_SIZE	= CONFIG_SYS_MALLOC_SMALL_CACHE_MAX - 2 * sizeof(size_t),
+	COUNT		= CONFIG_SYS_MALLOC_SMALL_CACHE_DEPTH + 4,
+};
+
+/* Test that freed small chunks are reused and that the cache is bounded */
+static int malloc_test_small_cache(struct unit_test_state *uts)
+{
+	struct malloc_info before, after;
+	char *ptr[COUNT], *buf;
+	int i;
+
+	/* Use up any chunks of this size already in the cache */
+	for (i = 0; i < COUNT; i++) {
+		ptr[i] = malloc(REQ_SIZE);
+		ut_assertnonnull(ptr[i]);
+		memset(ptr[i], 0xaa, REQ_SIZE);
+	}
+
+	malloc_get_info(&before);
+	for (i = 0; i < COUNT; i++)
+		free(ptr[i]);
+	malloc_get_info(&after);
+	ut_asserteq(CONFIG_SYS_MALLOC_SMALL_CACHE_DEPTH *
+		    CONFIG_SYS_MALLOC_SMALL_CACHE_MAX,
+		    after.cached_bytes - before.cached_bytes);
+
+	/* The most recently cached chunk comes back first */
+	buf = malloc(REQ_SIZE);
+	ut_asserteq_ptr(ptr[CONFIG_SYS_MALLOC_SMALL_CACHE_DEPTH - 1], buf);
+	malloc_get_info(&before);
+	ut_asserteq(after.cache_hits + 1, before.cache_hits);
+	ut_asserteq(after.cached_bytes - CONFIG_SYS_MALLOC_SMALL_CACHE_MAX,
+		    before.cached_bytes);
+	free(buf);
+
+	/* A cached chunk must still be cleared by calloc() */
+	buf = calloc(1, REQ_SIZE);
+	ut_asserteq_ptr(ptr[CONFIG_SYS_MALLOC_SMALL_CACHE_DEPTH - 1], buf);
+	for (i = 0; i < REQ_SIZE; i++)
+		ut_asserteq(0, buf[i]);
+	free(buf);
+
+	return 0;
+}
+COMMON_TEST(malloc_test_small_cache, 0);
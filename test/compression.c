@@ -245,6 +245,21 @@ static int uncompress_using_lzma(struct unit_test_state *uts,
 	return (ret != SZ_OK);
 }
 
+static int uncompress_using_lzma_generic(struct unit_test_state *uts,
+					 void *in, unsigned long in_size,
+					 void *out, unsigned long out_max,
+					 unsigned long *out_size)
+{
+	int ret;
+	SizeT inout_size = out_max;
+
+	ret = lzmaBuffToBuffDecompressGeneric(out, &inout_size, in, in_size);
+	if (out_size)
+		*out_size = inout_size;
+
+	return (ret != SZ_OK);
+}
+
 static int compress_using_lzo(struct unit_test_state *uts,
 			      void *in, unsigned long in_size,
 			      void *out, unsigned long out_max,
@@ -475,6 +490,57 @@ static int compression_test_gzip(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_gzip, 0);
 
+/*
+ * Check inflate's fast path, which only runs with more data than in plain[],
+ * using runs and repeats at every short distance, long matches and literals
+ */
+static int compression_test_gzip_large(struct unit_test_state *uts)
+{
+	const ulong size = 0x40000;
+	unsigned long out_size;
+	u8 *orig, *comp, *out;
+	uint seed = 1;
+	ulong i, pos;
+
+	orig = malloc(size);
+	comp = malloc(size);
+	out = malloc(size + 1);
+	ut_assertnonnull(orig);
+	ut_assertnonnull(comp);
+	ut_assertnonnull(out);
+
+	for (pos = 0; pos < size; pos += i) {
+		uint dist = pos % 11 + 1;
+		uint len = 3 + (seed >> 16) % 300;
+
+		seed = seed * 1103515245 + 12345;
+		for (i = 0; i < len && pos + i < size; i++) {
+			if (pos % 3 && pos + i >= dist)
+				orig[pos + i] = orig[pos + i - dist];
+			else
+				orig[pos + i] = (seed >> (i % 24)) ^ i;
+		}
+	}
+
+	out_size = size;
+	ut_assertok(gzip(comp, &out_size, orig, size));
+	ut_assert(out_size < size);
+
+	/* the output exactly fills the buffer, so check it does not overrun */
+	out[size] = 'A';
+	ut_assertok(gunzip(out, size, comp, &out_size));
+	ut_asserteq(size, out_size);
+	ut_asserteq_mem(orig, out, size);
+	ut_asserteq('A', out[size]);
+
+	free(out);
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_large, 0);
+
 static int compression_test_bzip2(struct unit_test_state *uts)
 {
 	return run_test(uts, "bzip2", compress_using_bzip2,
@@ -489,6 +555,14 @@ static int compression_test_lzma(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_lzma, 0);
 
+/* Check the generic decoder too, since the fast one is normally used */
+static int compression_test_lzma_generic(struct unit_test_state *uts)
+{
+	return run_test(uts, "lzma_generic", compress_using_lzma,
+			uncompress_using_lzma_generic);
+}
+COMPRESSION_TEST(compression_test_lzma_generic, 0);
+
 static int compression_test_lzo(struct unit_test_state *uts)
 {
 	return run_test(uts, "lzo", compress_using_lzo, uncompress_using_lzo);
@@ -9,6 +9,7 @@
 #include <common.h>
 #include <dm.h>
 #include <malloc.h>
+#include <asm/cache.h>
 #include <dm/test.h>
 #include <dma.h>
 #include <test/test.h>
@@ -37,6 +38,50 @@ static int dm_test_dma_m2m(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_dma_m2m, UT_TESTF_SCAN_FDT);
 
+/*
+ * Test copies are only offloaded when large enough, not overlapping and
+ * aligned to cache lines
+ */
+static int dm_test_dma_memcpy_offload(struct unit_test_state *uts)
+{
+	const size_t align = ARCH_DMA_MINALIGN;
+	size_t len = CONFIG_DMA_MEMCPY_OFFLOAD_MIN;
+	u8 *buf, *dst;
+	int i;
+
+	buf = memalign(align, 2 * len + 2 * align);
+	ut_assertnonnull(buf);
+	for (i = 0; i < len + align; i++)
+		buf[i] = i;
+	dst = buf + len + align;
+	memset(dst, '\0', len + align);
+
+	ut_asserteq(-EINVAL, dma_memcpy_offload(dst, buf, len - align, 0));
+	ut_asserteq(-EINVAL, dma_memcpy_offload(buf + align, buf, len, 0));
+	ut_asserteq(0, buf[len + align]);
+
+	/* unaligned destination, source or length */
+	ut_asserteq(-EINVAL, dma_memcpy_offload(dst + 1, buf, len, 0));
+	ut_asserteq(-EINVAL, dma_memcpy_offload(dst, buf + 1, len, 0));
+	ut_asserteq(-EINVAL, dma_memcpy_offload(dst, buf, len + 1, 0));
+	ut_asserteq(-EINVAL, dma_memcpy_offload(dst, buf, len, align + 1));
+	for (i = 0; i < len + align; i++)
+		ut_asserteq(0, dst[i]);
+
+	ut_assertok(dma_memcpy_offload(dst, buf, len, 0));
+	ut_asserteq_mem(buf, dst, len);
+	ut_asserteq(0, dst[len]);
+
+	/* copy in chunks, with the last one shorter than the others */
+	memset(dst, '\0', len + align);
+	ut_assertok(dma_memcpy_offload(dst, buf, len + align, len / 4));
+	ut_asserteq_mem(buf, dst, len + align);
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_dma_memcpy_offload, UT_TESTF_SCAN_FDT);
+
 static int dm_test_dma(struct unit_test_state *uts)
 {
 	struct udevice *dev;
@@ -7,6 +7,7 @@
 #include <dm.h>
 #include <mmc.h>
 #include <part.h>
+#include <asm/test.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -52,3 +53,43 @@ static int dm_test_mmc_blk(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_mmc_blk, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Check that multi-block transfers use CMD23 rather than CMD12 if possible */
+static int dm_test_mmc_cmd23(struct unit_test_state *uts)
+{
+	char write[4 * 512], read[4 * 512];
+	struct blk_desc *dev_desc;
+	struct udevice *dev;
+	struct mmc *mmc;
+	uint set, stop;
+
+	ut_assertok(uclass_get_device(UCLASS_MMC, 0, &dev));
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	mmc = mmc_get_mmc_dev(dev);
+	memset(write, 0xa5, sizeof(write));
+
+	set = sandbox_mmc_get_cmd_count(dev, MMC_CMD_SET_BLOCK_COUNT);
+	stop = sandbox_mmc_get_cmd_count(dev, MMC_CMD_STOP_TRANSMISSION);
+	ut_asserteq(4, blk_dwrite(dev_desc, 0, 4, write));
+	ut_asserteq(4, blk_dread(dev_desc, 0, 4, read));
+	ut_asserteq_mem(write, read, sizeof(write));
+	ut_asserteq(set + 2,
+		    sandbox_mmc_get_cmd_count(dev, MMC_CMD_SET_BLOCK_COUNT));
+	ut_asserteq(stop,
+		    sandbox_mmc_get_cmd_count(dev, MMC_CMD_STOP_TRANSMISSION));
+
+	/* Without the host capability, transfers are stopped with CMD12 */
+	mmc->host_caps &= ~MMC_CAP_CMD23;
+	memset(write, 0x5a, sizeof(write));
+	ut_asserteq(4, blk_dwrite(dev_desc, 0, 4, write));
+	ut_asserteq(4, blk_dread(dev_desc, 0, 4, read));
+	mmc->host_caps |= MMC_CAP_CMD23;
+	ut_asserteq_mem(write, read, sizeof(write));
+	ut_asserteq(set + 2,
+		    sandbox_mmc_get_cmd_count(dev, MMC_CMD_SET_BLOCK_COUNT));
+	ut_asserteq(stop + 2,
+		    sandbox_mmc_get_cmd_count(dev, MMC_CMD_STOP_TRANSMISSION));
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_cmd23, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -8,6 +8,7 @@
 #include <common.h>
 #include <dm.h>
 #include <p2sb.h>
+#include <pci.h>
 #include <asm/test.h>
 #include <dm/test.h>
 #include <test/ut.h>
@@ -26,3 +27,25 @@ static int dm_test_p2sb_base(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_p2sb_base, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that a hidden device reads as all ones, even if its IDs were cached */
+static int dm_test_p2sb_hide(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	u16 vendor;
+
+	ut_assertok(uclass_first_device_err(UCLASS_P2SB, &dev));
+	ut_assertok(dm_pci_read_config16(dev, PCI_VENDOR_ID, &vendor));
+	ut_asserteq(SANDBOX_PCI_VENDOR_ID, vendor);
+
+	ut_assertok(dm_pci_clrset_config8(dev, 0xe1, 0, 1));
+	ut_assertok(dm_pci_read_config16(dev, PCI_VENDOR_ID, &vendor));
+	ut_asserteq(0xffff, vendor);
+
+	ut_assertok(dm_pci_clrset_config8(dev, 0xe1, 1, 0));
+	ut_assertok(dm_pci_read_config16(dev, PCI_VENDOR_ID, &vendor));
+	ut_asserteq(SANDBOX_PCI_VENDOR_ID, vendor);
+
+	return 0;
+}
+DM_TEST(dm_test_p2sb_hide, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
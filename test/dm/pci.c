@@ -361,6 +361,49 @@ static int dm_test_pci_on_bus(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_pci_on_bus, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+/* Test that the config header read when scanning the bus is used later */
+static int dm_test_pci_hdr_cache(struct unit_test_state *uts)
+{
+	struct pci_child_plat *pplat;
+	struct udevice *dev;
+	ulong val;
+	u16 class;
+	u8 hdr;
+
+	ut_assertok(dm_pci_bus_find_bdf(PCI_BDF(0, 0x1f, 0), &dev));
+	pplat = dev_get_parent_plat(dev);
+	ut_asserteq(true, pplat->hdr_cached);
+	ut_asserteq(SANDBOX_PCI_VENDOR_ID, pplat->vendor);
+	ut_asserteq(SANDBOX_PCI_SWAP_CASE_EMUL_ID, pplat->device);
+	ut_asserteq(PCI_HEADER_TYPE_NORMAL, pplat->header_type);
+
+	/*
+	 * The IDs are not cached: the emulator only returns the vendor ID for
+	 * a 32-bit read
+	 */
+	ut_assertok(dm_pci_read_config(dev, PCI_VENDOR_ID, &val, PCI_SIZE_32));
+	ut_asserteq(SANDBOX_PCI_VENDOR_ID, val);
+	ut_assertok(dm_pci_read_config16(dev, PCI_CLASS_DEVICE, &class));
+	ut_asserteq(PCI_CLASS_COMMUNICATION_SERIAL, class);
+	ut_assertok(dm_pci_read_config8(dev, PCI_HEADER_TYPE, &hdr));
+	ut_asserteq(PCI_HEADER_TYPE_NORMAL, hdr);
+
+	/* Writing to other registers leaves the cache alone... */
+	ut_assertok(dm_pci_write_config8(dev, PCI_LATENCY_TIMER, 0x40));
+	ut_assertok(dm_pci_write_config16(dev, PCI_COMMAND, 0));
+	ut_asserteq(true, pplat->hdr_cached);
+
+	/* ...but writing to a cached one means that config space is used */
+	ut_assertok(dm_pci_write_config(dev, PCI_CACHE_LINE_SIZE, 0,
+					PCI_SIZE_32));
+	ut_asserteq(false, pplat->hdr_cached);
+	ut_assertok(dm_pci_read_config16(dev, PCI_CLASS_DEVICE, &class));
+	ut_asserteq(PCI_CLASS_COMMUNICATION_SERIAL, class);
+
+	return 0;
+}
+DM_TEST(dm_test_pci_hdr_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
 /*
  * Test support for multiple memory regions enabled via
  * CONFIG_PCI_REGION_MULTI_ENTRY. When this feature is not enabled,
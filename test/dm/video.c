@@ -84,6 +84,7 @@ static int compress_frame_buffer(struct unit_test_state *uts,
 
 	/* Check here that the copy frame buffer is working correctly */
 	if (IS_ENABLED(CONFIG_VIDEO_COPY)) {
+		ut_assertok(video_sync(dev, false));
 		ut_assertf(!memcmp(uc_priv->fb, uc_priv->copy_fb,
 				   uc_priv->fb_size),
 				   "Copy framebuffer does not match fb");
@@ -548,6 +549,76 @@ static int dm_test_video_comp_bmp8(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_comp_bmp8, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+/* Test drawing a compressed bitmap file on a 32bpp display */
+static int dm_test_video_bmp_comp32(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	ulong addr;
+
+	ut_assertok(uclass_find_first_device(UCLASS_VIDEO, &dev));
+	ut_assertnonnull(dev);
+	ut_assertok(sandbox_sdl_set_bpp(dev, VIDEO_BPP32));
+
+	ut_assertok(read_file(uts, "tools/logos/denx-comp.bmp", &addr));
+
+	/* This should look the same as the uncompressed file */
+	ut_assertok(video_bmp_display(dev, addr, 0, 0, false));
+	ut_asserteq(2024, compress_frame_buffer(uts, dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_bmp_comp32, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test the kernels used to copy and convert pixels */
+static int dm_test_video_blit(struct unit_test_state *uts)
+{
+	u8 buf[64], ref[64], src[48];
+	u32 pix[16];
+	int i, start;
+
+	/* Fill from each alignment, checking nothing around it is touched */
+	for (start = 0; start < 8; start++) {
+		memset(buf, '\0', sizeof(buf));
+		memset(ref, '\0', sizeof(ref));
+		video_fill_pixels(buf + start * 2, VIDEO_BPP16, 0x1234, 21);
+		for (i = 0; i < 21; i++)
+			((u16 *)ref)[start + i] = 0x1234;
+		ut_asserteq_mem(ref, buf, sizeof(buf));
+
+		memset(buf, '\0', sizeof(buf));
+		memset(ref, '\0', sizeof(ref));
+		video_fill_pixels(buf + start * 4, VIDEO_BPP32, 0x12345678, 7);
+		for (i = 0; i < 7; i++)
+			((u32 *)ref)[start + i] = 0x12345678;
+		ut_asserteq_mem(ref, buf, sizeof(buf));
+	}
+
+	/* Overlapping moves in both directions and at any alignment */
+	for (start = 0; start < 16; start++) {
+		for (i = 0; i < sizeof(buf); i++)
+			buf[i] = i;
+		memcpy(ref, buf, sizeof(ref));
+		video_move_pixels(buf + start, buf + 3, 45);
+		memmove(ref + start, ref + 3, 45);
+		ut_asserteq_mem(ref, buf, sizeof(buf));
+	}
+
+	/* Each 24bpp pixel is converted the same way, however it is handled */
+	for (i = 0; i < sizeof(src); i++)
+		src[i] = i * 37;
+	memset(pix, '\0', sizeof(pix));
+	video_conv_bgr24(pix, VIDEO_BPP32, VIDEO_X8R8G8B8, src + 1, 15);
+	for (i = 0; i < 15; i++) {
+		const u8 *bgr = src + 1 + i * 3;
+
+		ut_asserteq(bgr[0] | bgr[1] << 8 | bgr[2] << 16, pix[i]);
+	}
+	ut_asserteq(0, pix[15]);
+
+	return 0;
+}
+DM_TEST(dm_test_video_blit, 0);
+
 /* Test TrueType console */
 static int dm_test_video_truetype(struct unit_test_state *uts)
 {
@@ -557,7 +628,7 @@ static int dm_test_video_truetype(struct unit_test_state *uts)
 	ut_assertok(video_get_nologo(uts, &dev));
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	vidconsole_put_string(con, test_string);
-	ut_asserteq(12174, compress_frame_buffer(uts, dev));
+	ut_asserteq(8817, compress_frame_buffer(uts, dev));
 
 	return 0;
 }
@@ -578,7 +649,7 @@ static int dm_test_video_truetype_scroll(struct unit_test_state *uts)
 	ut_assertok(video_get_nologo(uts, &dev));
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	vidconsole_put_string(con, test_string);
-	ut_asserteq(34287, compress_frame_buffer(uts, dev));
+	ut_asserteq(28986, compress_frame_buffer(uts, dev));
 
 	return 0;
 }
@@ -599,8 +670,132 @@ static int dm_test_video_truetype_bs(struct unit_test_state *uts)
 	ut_assertok(video_get_nologo(uts, &dev));
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	vidconsole_put_string(con, test_string);
-	ut_asserteq(29471, compress_frame_buffer(uts, dev));
+	ut_asserteq(24547, compress_frame_buffer(uts, dev));
 
 	return 0;
 }
 DM_TEST(dm_test_video_truetype_bs, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test the TrueType glyph cache */
+static int dm_test_video_truetype_cache(struct unit_test_state *uts)
+{
+	uint hits, misses, used, budget;
+	struct udevice *dev, *con;
+	int checksum, ch;
+
+	if (!IS_ENABLED(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE))
+		return -EAGAIN;
+	budget = IF_ENABLED_INT(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE,
+				CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE_SIZE);
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	console_truetype_glyph_stats(con, &hits, &misses, &used);
+	ut_asserteq(0, hits);
+	ut_asserteq(0, misses);
+	ut_asserteq(0, used);
+
+	/* The first time a character is drawn it is rendered and cached */
+	ut_assert(vidconsole_putc_xy(con, VID_TO_POS(10), 0, 'g') > 0);
+	console_truetype_glyph_stats(con, &hits, &misses, &used);
+	ut_asserteq(0, hits);
+	ut_asserteq(1, misses);
+	ut_assert(used > 0);
+	checksum = compress_frame_buffer(uts, dev);
+
+	/* ...after that it comes from the cache and looks the same */
+	ut_assertok(video_clear(dev));
+	ut_assert(vidconsole_putc_xy(con, VID_TO_POS(10), 0, 'g') > 0);
+	console_truetype_glyph_stats(con, &hits, &misses, &used);
+	ut_asserteq(1, hits);
+	ut_asserteq(1, misses);
+	ut_asserteq(checksum, compress_frame_buffer(uts, dev));
+
+	/* A different position within the pixel needs another rendering */
+	ut_assert(vidconsole_putc_xy(con, VID_TO_POS(10) + VID_FRAC_DIV / 2, 0,
+				     'g') > 0);
+	console_truetype_glyph_stats(con, &hits, &misses, &used);
+	ut_asserteq(1, hits);
+	ut_asserteq(2, misses);
+
+	/* The cached character is not used for a different font size */
+	ut_assertok(vidconsole_select_font(con, NULL, 40));
+	ut_assert(vidconsole_putc_xy(con, VID_TO_POS(10), 0, 'g') > 0);
+	console_truetype_glyph_stats(con, &hits, &misses, &used);
+	ut_asserteq(1, hits);
+	ut_asserteq(3, misses);
+
+	/* Large characters push out the least recently used ones */
+	ut_assertok(vidconsole_select_font(con, NULL, 200));
+	for (ch = 'A'; ch <= 'Z'; ch++) {
+		ut_assert(vidconsole_putc_xy(con, 0, 0, ch) > 0);
+		console_truetype_glyph_stats(con, &hits, &misses, &used);
+		ut_assert(used <= budget);
+	}
+	ut_asserteq(1, hits);
+	ut_asserteq(3 + 26, misses);
+
+	ut_assert(vidconsole_putc_xy(con, 0, 0, 'Z') > 0);
+	console_truetype_glyph_stats(con, &hits, &misses, &used);
+	ut_asserteq(2, hits);
+
+	ut_assert(vidconsole_putc_xy(con, 0, 0, 'A') > 0);
+	console_truetype_glyph_stats(con, &hits, &misses, &used);
+	ut_asserteq(2, hits);
+	ut_asserteq(3 + 27, misses);
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that only the part of the frame buffer which changed is synced */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+	uint count;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		return -EAGAIN;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	ut_assertok(video_sync(dev, false));
+
+	/* A single character */
+	ut_assertok(vidconsole_put_char(con, 'a'));
+	ut_asserteq(0, priv->damage.x0);
+	ut_asserteq(0, priv->damage.y0);
+	ut_asserteq(8, priv->damage.x1);
+	ut_asserteq(16, priv->damage.y1);
+	ut_assertok(video_sync(dev, false));
+	ut_asserteq(8 * 2 * 16, priv->last_sync_bytes);
+
+	/* Nothing changed */
+	count = priv->sync_count;
+	ut_assertok(video_sync(dev, false));
+	ut_asserteq(count, priv->sync_count);
+
+	/* Two areas are combined, clipped to the display */
+	ut_assertok(video_fill_part(dev, 100, 50, 110, 60, 0));
+	ut_assertok(video_fill_part(dev, 1360, 70, 1366, 80, 0));
+	video_damage(dev, -10, 700, 20, 100);
+	ut_assertok(video_sync(dev, false));
+	ut_asserteq(count + 1, priv->sync_count);
+	ut_asserteq(1366 * 2 * (768 - 50), priv->last_sync_bytes);
+
+	/* Only part of each line */
+	ut_assertok(video_fill_part(dev, 100, 50, 110, 60, 0));
+	ut_assertok(video_sync(dev, false));
+	ut_asserteq(10 * 2 * 10, priv->last_sync_bytes);
+
+	/* The whole display */
+	ut_assertok(video_clear(dev));
+	ut_asserteq(priv->fb_size, priv->last_sync_bytes);
+	ut_asserteq(0, compress_frame_buffer(uts, dev) < 0);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
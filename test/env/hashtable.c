@@ -124,3 +124,37 @@ static int env_test_htab_deletes(struct unit_test_state *uts)
 }
 
 ENV_TEST(env_test_htab_deletes, 0);
+
+/* Check that export returns the entries in order after imports and changes */
+static int env_test_htab_sorted(struct unit_test_state *uts)
+{
+	const char data[] = "c=3\na=1\nd=4\nb=2\n";
+	struct hsearch_data htab;
+	struct env_entry item;
+	struct env_entry *ritem;
+	char *res = NULL;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, himport_r(&htab, data, sizeof(data) - 1, '\n', 0, 0,
+				 0, NULL));
+	ut_asserteq(4, htab.filled);
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("a=1\nb=2\nc=3\nd=4\n", res);
+	free(res);
+	res = NULL;
+
+	item.callback = NULL;
+	item.flags = 0;
+	item.key = "bb";
+	item.data = "5";
+	ut_asserteq(1, hsearch_r(item, ENV_ENTER, &ritem, &htab, 0));
+	ut_asserteq(0, hdelete_r("c", &htab, 0));
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("a=1\nb=2\nbb=5\nd=4\n", res);
+	free(res);
+
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_sorted, 0);
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the journal of environment changes
+ */
+
+#include <env.h>
+#include <env_internal.h>
+#include <malloc.h>
+#include <test/env.h>
+#include <test/ut.h>
+
+/* Records start with a CRC and a length, each 32 bits */
+#define REC_DATA(jnl, pos)	((char *)(jnl)->buf + (pos) + 8)
+
+/* Test that changes are recorded and replayed */
+static int env_test_journal(struct unit_test_state *uts)
+{
+	struct env_journal jnl = { .blank = 0xff };
+	uint first, pos;
+	env_t *ep;
+
+	ep = malloc(sizeof(*ep));
+	ut_assertnonnull(ep);
+	env_set("jnl_a", NULL);
+	env_set("jnl_b", "1");
+	ut_assertok(env_export(ep));
+	env_journal_reset(&jnl, ep);
+	ut_assert(jnl.valid);
+
+	/* Nothing changed */
+	ut_assertok(env_journal_prepare(&jnl));
+	ut_asserteq(0, jnl.len);
+
+	/* One variable added, one changed */
+	ut_assertok(env_set("jnl_a", "x"));
+	ut_assertok(env_set("jnl_b", "2"));
+	ut_assertok(env_journal_prepare(&jnl));
+	ut_asserteq(0, jnl.pos);
+	ut_asserteq(jnl.len, jnl.end);
+	ut_asserteq_mem("jnl_a=x\0jnl_b=2\0", REC_DATA(&jnl, 0), 16);
+	env_journal_commit(&jnl);
+	first = jnl.pos;
+	ut_asserteq(24, first);
+
+	/* One deleted */
+	ut_assertok(env_set("jnl_a", NULL));
+	ut_assertok(env_journal_prepare(&jnl));
+	ut_asserteq_mem("jnl_a=\0", REC_DATA(&jnl, first), 7);
+	env_journal_commit(&jnl);
+	pos = jnl.pos;
+	ut_asserteq((uchar)0xff, jnl.buf[pos]);
+
+	/* Replay both records */
+	ut_assertok(env_set("jnl_a", "stale"));
+	ut_assertok(env_set("jnl_b", "stale"));
+	ut_assertok(env_journal_replay(&jnl, ep));
+	ut_asserteq(pos, jnl.pos);
+	ut_assertnull(env_get("jnl_a"));
+	ut_asserteq_str("2", env_get("jnl_b"));
+
+	/* A torn record is not applied and nothing may be appended after it */
+	REC_DATA(&jnl, first)[0] ^= 1;
+	ut_assertok(env_journal_replay(&jnl, ep));
+	ut_asserteq_str("x", env_get("jnl_a"));
+	ut_asserteq(CONFIG_ENV_JOURNAL_SIZE, jnl.pos);
+	ut_asserteq(-ENOSPC, env_journal_prepare(&jnl));
+
+	/* Records of another environment copy are ignored */
+	REC_DATA(&jnl, first)[0] ^= 1;
+	ut_assertok(env_set("jnl_b", "stale"));
+	ep->crc ^= 1;
+	ut_assertok(env_journal_replay(&jnl, ep));
+	ut_asserteq_str("stale", env_get("jnl_b"));
+	ep->crc ^= 1;
+
+	/* The journal fills up */
+	env_journal_reset(&jnl, ep);
+	for (pos = 0; pos < CONFIG_ENV_JOURNAL_SIZE; pos++) {
+		int ret;
+
+		ut_assertok(env_set_ulong("jnl_a", pos));
+		ret = env_journal_prepare(&jnl);
+		if (ret == -ENOSPC)
+			break;
+		ut_assertok(ret);
+		env_journal_commit(&jnl);
+	}
+	ut_assert(pos < CONFIG_ENV_JOURNAL_SIZE);
+	ut_assert(jnl.pos > CONFIG_ENV_JOURNAL_SIZE - 32);
+
+	env_set("jnl_a", NULL);
+	env_set("jnl_b", NULL);
+	free(ep);
+	free(jnl.buf);
+	free(jnl.shadow);
+	free(jnl.data);
+
+	return 0;
+}
+ENV_TEST(env_test_journal, 0);
@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for writing Android sparse images
+ */
+
+#include <common.h>
+#include <image-sparse.h>
+#include <malloc.h>
+#include <asm/cache.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define TEST_BLKSZ	512
+#define TEST_SPARSE_BLKSZ	1024
+#define TEST_DISK_BLKS	32
+
+/**
+ * struct sparse_test_priv - RAM disk used as the sparse storage backend
+ *
+ * @disk: Disk contents
+ * @writes: Number of calls to write()
+ * @reserves: Number of calls to reserve()
+ * @erases: Number of calls to erase()
+ */
+struct sparse_test_priv {
+	u8 disk[TEST_DISK_BLKS * TEST_BLKSZ];
+	int writes;
+	int reserves;
+	int erases;
+};
+
+static lbaint_t sparse_test_write(struct sparse_storage *info, lbaint_t blk,
+				  lbaint_t blkcnt, const void *buffer)
+{
+	struct sparse_test_priv *priv = info->priv;
+
+	memcpy(priv->disk + blk * TEST_BLKSZ, buffer, blkcnt * TEST_BLKSZ);
+	priv->writes++;
+
+	return blkcnt;
+}
+
+static lbaint_t sparse_test_reserve(struct sparse_storage *info,
+				    lbaint_t blk, lbaint_t blkcnt)
+{
+	struct sparse_test_priv *priv = info->priv;
+
+	priv->reserves++;
+
+	return blkcnt;
+}
+
+static lbaint_t sparse_test_erase(struct sparse_storage *info, lbaint_t blk,
+				  lbaint_t blkcnt)
+{
+	struct sparse_test_priv *priv = info->priv;
+
+	memset(priv->disk + blk * TEST_BLKSZ, '\0', blkcnt * TEST_BLKSZ);
+	priv->erases++;
+
+	return blkcnt;
+}
+
+static void *add_chunk(void *ptr, int type, u32 chunk_sz, u32 data_sz)
+{
+	chunk_header_t *chunk = ptr;
+
+	chunk->chunk_type = type;
+	chunk->reserved1 = 0;
+	chunk->chunk_sz = chunk_sz;
+	chunk->total_sz = sizeof(*chunk) + data_sz;
+
+	return ptr + sizeof(*chunk);
+}
+
+/*
+ * Build a sparse image covering 10 output blocks:
+ *
+ *   raw (2), don't care (1), don't care (2), fill 0xdeadbeef (1),
+ *   fill 0xdeadbeef (1), fill 0 (2), crc32 (0), raw (1)
+ */
+static size_t make_image(u8 *buf)
+{
+	sparse_header_t *hdr = (sparse_header_t *)buf;
+	u8 *ptr = buf + sizeof(*hdr);
+	u32 val;
+	int i;
+
+	hdr->magic = SPARSE_HEADER_MAGIC;
+	hdr->major_version = 1;
+	hdr->minor_version = 0;
+	hdr->file_hdr_sz = sizeof(*hdr);
+	hdr->chunk_hdr_sz = sizeof(chunk_header_t);
+	hdr->blk_sz = TEST_SPARSE_BLKSZ;
+	hdr->total_blks = 10;
+	hdr->total_chunks = 8;
+	hdr->image_checksum = 0;
+
+	ptr = add_chunk(ptr, CHUNK_TYPE_RAW, 2, 2 * TEST_SPARSE_BLKSZ);
+	for (i = 0; i < 2 * TEST_SPARSE_BLKSZ; i++)
+		*ptr++ = i;
+	ptr = add_chunk(ptr, CHUNK_TYPE_DONT_CARE, 1, 0);
+	ptr = add_chunk(ptr, CHUNK_TYPE_DONT_CARE, 2, 0);
+	val = 0xdeadbeef;
+	ptr = add_chunk(ptr, CHUNK_TYPE_FILL, 1, sizeof(val));
+	memcpy(ptr, &val, sizeof(val));
+	ptr += sizeof(val);
+	ptr = add_chunk(ptr, CHUNK_TYPE_FILL, 1, sizeof(val));
+	memcpy(ptr, &val, sizeof(val));
+	ptr += sizeof(val);
+	val = 0;
+	ptr = add_chunk(ptr, CHUNK_TYPE_FILL, 2, sizeof(val));
+	memcpy(ptr, &val, sizeof(val));
+	ptr += sizeof(val);
+	ptr = add_chunk(ptr, CHUNK_TYPE_CRC32, 0, sizeof(val));
+	memcpy(ptr, &val, sizeof(val));
+	ptr += sizeof(val);
+	ptr = add_chunk(ptr, CHUNK_TYPE_RAW, 1, TEST_SPARSE_BLKSZ);
+	memset(ptr, 0xa5, TEST_SPARSE_BLKSZ);
+	ptr += TEST_SPARSE_BLKSZ;
+
+	return ptr - buf;
+}
+
+static int check_disk(struct unit_test_state *uts,
+		      struct sparse_test_priv *priv)
+{
+	const u32 fill = 0xdeadbeef;
+	u8 *disk = priv->disk;
+	int i;
+
+	for (i = 0; i < 2 * TEST_SPARSE_BLKSZ; i++)
+		ut_asserteq((u8)i, disk[i]);
+	disk += 2 * TEST_SPARSE_BLKSZ;
+
+	/* don't care blocks keep their old contents */
+	for (i = 0; i < 3 * TEST_SPARSE_BLKSZ; i++)
+		ut_asserteq(0xff, disk[i]);
+	disk += 3 * TEST_SPARSE_BLKSZ;
+
+	for (i = 0; i < 2 * TEST_SPARSE_BLKSZ; i += sizeof(fill))
+		ut_asserteq_mem(&fill, disk + i, sizeof(fill));
+	disk += 2 * TEST_SPARSE_BLKSZ;
+
+	for (i = 0; i < 2 * TEST_SPARSE_BLKSZ; i++)
+		ut_asserteq(0, disk[i]);
+	disk += 2 * TEST_SPARSE_BLKSZ;
+
+	for (i = 0; i < TEST_SPARSE_BLKSZ; i++)
+		ut_asserteq(0xa5, disk[i]);
+	disk += TEST_SPARSE_BLKSZ;
+
+	/* nothing is written past the end of the image */
+	ut_asserteq(0xff, *disk);
+
+	return 0;
+}
+
+static void init_storage(struct sparse_storage *info,
+			 struct sparse_test_priv *priv)
+{
+	memset(priv, '\0', sizeof(*priv));
+	memset(priv->disk, 0xff, sizeof(priv->disk));
+
+	memset(info, '\0', sizeof(*info));
+	info->blksz = TEST_BLKSZ;
+	info->start = 0;
+	info->size = TEST_DISK_BLKS;
+	info->write = sparse_test_write;
+	info->reserve = sparse_test_reserve;
+	info->erase = sparse_test_erase;
+	info->priv = priv;
+}
+
+/* Test writing a sparse image held completely in memory */
+static int lib_test_sparse_image(struct unit_test_state *uts)
+{
+	struct sparse_test_priv *priv;
+	struct sparse_storage info;
+	sparse_header_t *hdr;
+	u8 *image;
+	ulong start;
+	size_t len;
+
+	start = ut_check_free();
+	priv = malloc(sizeof(*priv));
+	ut_assertnonnull(priv);
+	image = memalign(ARCH_DMA_MINALIGN, 16 << 10);
+	ut_assertnonnull(image);
+
+	len = make_image(image);
+	init_storage(&info, priv);
+	ut_assertok(write_sparse_image(&info, "test", image, len, NULL));
+	ut_assertok(check_disk(uts, priv));
+
+	/* DONT_CARE and FILL runs are issued once each */
+	ut_asserteq(1, priv->reserves);
+	ut_asserteq(1, priv->erases);
+	ut_asserteq(3, priv->writes);
+
+	/* Without an erase() the zero fill is written out */
+	init_storage(&info, priv);
+	info.erase = NULL;
+	ut_assertok(write_sparse_image(&info, "test", image, len, NULL));
+	ut_assertok(check_disk(uts, priv));
+	ut_asserteq(0, priv->erases);
+	ut_asserteq(4, priv->writes);
+
+	/* Nothing is read past the end of the download */
+	init_storage(&info, priv);
+	ut_asserteq(-1, write_sparse_image(&info, "test", image, len - 1,
+					   NULL));
+	ut_asserteq(-1, write_sparse_image(&info, "test", image,
+					   sizeof(*hdr) - 1, NULL));
+
+	/* A bad header is rejected before any chunk is looked at */
+	init_storage(&info, priv);
+	hdr = (sparse_header_t *)image;
+	hdr->file_hdr_sz = 0xffff;
+	ut_asserteq(-1, write_sparse_image(&info, "test", image, len, NULL));
+	hdr->file_hdr_sz = sizeof(*hdr);
+	hdr->chunk_hdr_sz = 0;
+	ut_asserteq(-1, write_sparse_image(&info, "test", image, len, NULL));
+	ut_asserteq(0, priv->writes);
+
+	free(image);
+	free(priv);
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_image, 0);
+
+/* Test feeding a sparse image to the stream in small pieces */
+static int lib_test_sparse_stream(struct unit_test_state *uts)
+{
+	struct sparse_test_priv *priv;
+	struct sparse_storage info;
+	struct sparse_stream stream;
+	size_t len, pos, n;
+	u8 *image;
+	ulong start;
+
+	start = ut_check_free();
+	priv = malloc(sizeof(*priv));
+	ut_assertnonnull(priv);
+	image = malloc(16 << 10);
+	ut_assertnonnull(image);
+
+	len = make_image(image);
+	init_storage(&info, priv);
+	sparse_stream_start(&stream, &info, "test");
+	for (pos = 0, n = 1; pos < len; pos += n, n = n % 7 + 1) {
+		n = min(n, len - pos);
+		ut_assertok(sparse_stream_write(&stream, image + pos, n, NULL));
+	}
+	ut_asserteq(SPARSE_STREAM_DONE, stream.state);
+	ut_assertok(sparse_stream_finish(&stream, NULL));
+	ut_assertok(check_disk(uts, priv));
+	ut_asserteq(1, priv->reserves);
+	ut_asserteq(1, priv->erases);
+	ut_asserteq(3, priv->writes);
+
+	/* A truncated image is rejected */
+	init_storage(&info, priv);
+	sparse_stream_start(&stream, &info, "test");
+	ut_assertok(sparse_stream_write(&stream, image, len - 1, NULL));
+	ut_asserteq(-EIO, sparse_stream_finish(&stream, NULL));
+
+	/* So is a corrupt chunk, and anything sent after it */
+	init_storage(&info, priv);
+	((chunk_header_t *)(image + sizeof(sparse_header_t)))->total_sz++;
+	sparse_stream_start(&stream, &info, "test");
+	ut_asserteq(-EIO, sparse_stream_write(&stream, image, len, NULL));
+	ut_asserteq(-EIO, sparse_stream_write(&stream, image, len, NULL));
+	ut_asserteq(-EIO, sparse_stream_finish(&stream, NULL));
+	ut_asserteq(0, priv->writes);
+
+	free(image);
+	free(priv);
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_stream, 0);
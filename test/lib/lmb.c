@@ -668,7 +668,8 @@ static int lib_test_lmb_get_free_size(struct unit_test_state *uts)
 }
 LIB_TEST(lib_test_lmb_get_free_size, 0);
 
-#ifdef CONFIG_LMB_USE_MAX_REGIONS
+#if IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS) && \
+	!IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS)
 static int lib_test_lmb_max_regions(struct unit_test_state *uts)
 {
 	const phys_addr_t ram = 0x00000000;
@@ -824,3 +825,146 @@ static int lib_test_lmb_flags(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(lib_test_lmb_flags, 0);
+
+/* Check the reserved regions against a map of the reserved pages */
+static int check_lmb_map(struct unit_test_state *uts, struct lmb *lmb,
+			 phys_addr_t ram, ulong page_size, const u8 *map,
+			 int pages)
+{
+	struct lmb_region *rgn = &lmb->reserved;
+	int i, page = 0;
+
+	for (i = 0; i < rgn->cnt; i++) {
+		int first = (rgn->region[i].base - ram) / page_size;
+		int count = rgn->region[i].size / page_size;
+
+		/* sorted, not overlapping and not adjacent */
+		ut_assert(!i || first > page);
+		for (; page < first; page++)
+			ut_asserteq(0, map[page]);
+		for (; page < first + count; page++)
+			ut_asserteq(1, map[page]);
+	}
+	for (; page < pages; page++)
+		ut_asserteq(0, map[page]);
+
+	return 0;
+}
+
+/* Random reserve / free sequence, checked against a map of reserved pages */
+static int lib_test_lmb_stress(struct unit_test_state *uts)
+{
+	const phys_addr_t ram = 0x40000000;
+	const ulong page_size = 0x1000;
+	enum { PAGES = 256, LOOPS = 4000 };
+	u8 map[PAGES];
+	struct lmb lmb;
+	u32 seed = 1;
+	int loop;
+
+	lmb_init(&lmb);
+	ut_asserteq(0, lmb_add(&lmb, ram, PAGES * page_size));
+	memset(map, '\0', sizeof(map));
+
+	for (loop = 0; loop < LOOPS; loop++) {
+		bool full = !IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS) &&
+			lmb.reserved.cnt == lmb.reserved.max;
+		int start, len, page, end;
+		phys_addr_t addr;
+		phys_size_t free;
+		bool used, clear;
+		long ret;
+
+		seed = seed * 1103515245 + 12345;
+		start = (seed >> 8) % PAGES;
+		len = min(1 + (int)(seed >> 20) % 8, PAGES - start);
+		end = start + len;
+		addr = ram + start * page_size;
+
+		used = true;
+		clear = true;
+		for (page = start; page < end; page++) {
+			used &= map[page];
+			clear &= !map[page];
+		}
+
+		if (clear) {
+			bool touches = (start && map[start - 1]) ||
+				(end < PAGES && map[end]);
+
+			ret = lmb_reserve(&lmb, addr, len * page_size);
+			if (full && !touches) {
+				ut_asserteq(-1, ret);
+			} else {
+				ut_assert(ret >= 0);
+				memset(map + start, 1, len);
+			}
+		} else if (used) {
+			bool split = start && map[start - 1] &&
+				end < PAGES && map[end];
+
+			if (!full || !split) {
+				ut_asserteq(0, lmb_free(&lmb, addr,
+							len * page_size));
+				memset(map + start, 0, len);
+			}
+		} else {
+			/* partly reserved: cannot be reserved or freed */
+			ut_asserteq(-1, lmb_free(&lmb, addr, len * page_size));
+		}
+		ut_assertok(check_lmb_map(uts, &lmb, ram, page_size, map,
+					  PAGES));
+
+		ut_asserteq(map[start], lmb_is_reserved(&lmb, addr));
+		for (page = start; page < PAGES && !map[page]; page++)
+			;
+		free = (page - start) * page_size;
+		ut_asserteq(free, lmb_get_free_size(&lmb, addr));
+	}
+	lmb_uninit(&lmb);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_stress, 0);
+
+#if IS_ENABLED(CONFIG_LMB_DYNAMIC_REGIONS)
+/* Test that full region arrays grow and are freed by lmb_uninit() */
+static int lib_test_lmb_dynamic_regions(struct unit_test_state *uts)
+{
+	const phys_addr_t ram = 0x40000000;
+	const phys_size_t blk_size = 0x1000;
+	unsigned long max, i;
+	struct lmb lmb;
+	ulong start;
+
+	start = ut_check_free();
+	lmb_init(&lmb);
+	max = lmb.reserved.max;
+	ut_asserteq(0, lmb_add(&lmb, ram, 0x10000000));
+
+	/* leave a gap between the blocks, so they are not coalesced */
+	for (i = 0; i < 4 * max; i++)
+		ut_asserteq(0, lmb_reserve(&lmb, ram + 2 * i * blk_size,
+					   blk_size));
+	ut_asserteq(4 * max, lmb.reserved.cnt);
+	ut_assert(lmb.reserved.max >= 4 * max);
+	for (i = 0; i < 4 * max; i++)
+		ut_asserteq(ram + 2 * i * blk_size, lmb.reserved.region[i].base);
+	ut_assert(ut_check_delta(start) > 0);
+
+	lmb_uninit(&lmb);
+	ut_asserteq(0, lmb.memory.cnt);
+	ut_asserteq(0, lmb.reserved.cnt);
+	ut_asserteq(max, lmb.reserved.max);
+	ut_asserteq(0, ut_check_delta(start));
+
+	/* the struct can be used again */
+	ut_asserteq(0, lmb_add(&lmb, ram, 0x10000000));
+	ut_asserteq(0, lmb_reserve(&lmb, ram, blk_size));
+	ut_asserteq(1, lmb_is_reserved(&lmb, ram));
+	lmb_uninit(&lmb);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_dynamic_regions, 0);
+#endif
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for building a live tree from a flat device tree
+ */
+
+#include <common.h>
+#include <of_live.h>
+#include <dm/of.h>
+#include <dm/of_access.h>
+#include <linux/libfdt.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define FDT_SIZE	1024
+
+static int make_fdt(struct unit_test_state *uts, void *fdt)
+{
+	ut_assertok(fdt_create(fdt, FDT_SIZE));
+	ut_assertok(fdt_finish_reservemap(fdt));
+	ut_assertok(fdt_begin_node(fdt, ""));
+	ut_assertok(fdt_property_string(fdt, "compatible", "test,root"));
+
+	ut_assertok(fdt_begin_node(fdt, "bus@1000"));
+	ut_assertok(fdt_property_u32(fdt, "phandle", 1));
+	ut_assertok(fdt_begin_node(fdt, "dev@10"));
+	ut_assertok(fdt_property_string(fdt, "device_type", "serial"));
+	ut_assertok(fdt_end_node(fdt));
+	ut_assertok(fdt_begin_node(fdt, "empty"));
+	ut_assertok(fdt_end_node(fdt));
+	ut_assertok(fdt_end_node(fdt));
+
+	ut_assertok(fdt_begin_node(fdt, "named"));
+	ut_assertok(fdt_property_string(fdt, "name", "other"));
+	ut_assertok(fdt_end_node(fdt));
+
+	ut_assertok(fdt_end_node(fdt));
+	ut_assertok(fdt_finish(fdt));
+
+	return 0;
+}
+
+/* Test unflattening a tree with nested and empty nodes */
+static int lib_test_of_live_unflatten(struct unit_test_state *uts)
+{
+	struct device_node *root, *bus, *np;
+	char fdt[FDT_SIZE];
+
+	ut_assertok(make_fdt(uts, fdt));
+	ut_assertok(unflatten_device_tree(fdt, &root));
+
+	ut_asserteq_str("/", root->full_name);
+	bus = root->child;
+	ut_assertnonnull(bus);
+	ut_asserteq_str("bus@1000", bus->name);
+	ut_asserteq_str("/bus@1000", bus->full_name);
+	ut_asserteq(1, bus->phandle);
+	ut_asserteq_ptr(root, bus->parent);
+
+	np = bus->child;
+	ut_assertnonnull(np);
+	ut_asserteq_str("dev@10", np->name);
+	ut_asserteq_str("serial", np->type);
+	ut_asserteq_str("/bus@1000/dev@10", np->full_name);
+
+	np = np->sibling;
+	ut_assertnonnull(np);
+	ut_asserteq_str("/bus@1000/empty", np->full_name);
+	ut_assertnull(np->properties);
+	ut_asserteq_str("<NULL>", np->type);
+	ut_assertnull(np->sibling);
+
+	np = bus->sibling;
+	ut_assertnonnull(np);
+	ut_asserteq_str("named", np->name);
+	ut_asserteq_str("other", of_get_property(np, "name", NULL));
+	ut_asserteq_str("/named", np->full_name);
+	ut_assertnull(np->sibling);
+
+	of_live_free(root);
+
+	return 0;
+}
+LIB_TEST(lib_test_of_live_unflatten, 0);
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the statistical profiler
+ */
+
+#include <profile.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Test adding up samples from schedule() */
+static int lib_test_profile_poll(struct unit_test_state *uts)
+{
+	struct profile_entry ent[3];
+	struct profile_info info;
+
+	ut_assertok(profile_start(PROFILE_SRC_POLL, 0));
+
+	/* Samples are weighted by the time since the previous one */
+	timer_test_add_offset(10);
+	profile_poll(gd->reloc_off + 0x1000);
+	timer_test_add_offset(30);
+	profile_poll(gd->reloc_off + 0x2000);
+	timer_test_add_offset(5);
+	profile_poll(gd->reloc_off + 0x1000);
+	profile_stop();
+
+	/* This should be ignored */
+	timer_test_add_offset(50);
+	profile_poll(gd->reloc_off + 0x3000);
+
+	profile_get_info(&info);
+	ut_assert(!info.active);
+	ut_asserteq(PROFILE_SRC_POLL, info.src);
+	ut_asserteq(3, info.samples);
+	ut_assert(info.total >= 45000 && info.total < 50000);
+	ut_asserteq(0, info.dropped);
+
+	ut_asserteq(2, profile_get_top(ent, ARRAY_SIZE(ent)));
+	ut_asserteq(0x2000, ent[0].pc);
+	ut_assert(ent[0].weight >= 30000);
+	ut_asserteq(0x1000, ent[1].pc);
+	ut_assert(ent[1].weight >= 15000);
+	ut_asserteq(info.total, ent[0].weight + ent[1].weight);
+
+	/* Starting again discards the samples */
+	ut_assertok(profile_start(PROFILE_SRC_POLL, 0));
+	profile_stop();
+	profile_get_info(&info);
+	ut_asserteq(0, info.samples);
+	ut_asserteq(0, profile_get_top(ent, ARRAY_SIZE(ent)));
+
+	return 0;
+}
+LIB_TEST(lib_test_profile_poll, 0);
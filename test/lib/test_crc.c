@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for crc32, crc32c and crc16-ccitt
+ *
+ * These check the table-driven or hardware implementations against a simple
+ * bit-at-a-time calculation, with buffers of various lengths and alignments
+ * so that the head, body and tail of each implementation are exercised
+ */
+
+#include <test/lib.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+
+static const char crc_check_str[] = "123456789";
+
+static u32 crc_ref_reflected32(u32 crc, u32 poly, const u8 *buf, int len)
+{
+	int i;
+
+	while (len--) {
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+	}
+
+	return crc;
+}
+
+static u16 crc_ref_ccitt(u16 crc, const u8 *buf, int len)
+{
+	int i;
+
+	while (len--) {
+		crc ^= *buf++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = (crc << 1) ^ ((crc & 0x8000) ? 0x1021 : 0);
+	}
+
+	return crc;
+}
+
+static void crc_fill(u8 *buf, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = i * 7 + (i >> 8) * 13;
+}
+
+static int lib_crc32(struct unit_test_state *uts)
+{
+	const u8 *check = (const u8 *)crc_check_str;
+	u8 buf[300];
+	int start, len;
+
+	ut_asserteq(0xcbf43926, crc32(0, check, 9));
+	ut_asserteq(0xcbf43926, crc32(crc32(0, check, 4), check + 4, 5));
+
+	crc_fill(buf, sizeof(buf));
+	for (start = 0; start < 8; start++) {
+		for (len = 0; len < sizeof(buf) - start; len += 5) {
+			u32 expect;
+
+			expect = ~crc_ref_reflected32(~0, 0xedb88320, buf + start,
+						      len);
+			ut_asserteq(expect, crc32(0, buf + start, len));
+			ut_asserteq(~expect, crc32_no_comp(~0, buf + start,
+							   len));
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_crc32, 0);
+
+#ifdef CONFIG_CRC32C
+static int lib_crc32c(struct unit_test_state *uts)
+{
+	const u8 *check = (const u8 *)crc_check_str;
+	u8 buf[300];
+	int start, len;
+
+	ut_asserteq(0xe3069283, ~crc32c(~0, check, 9));
+
+	crc_fill(buf, sizeof(buf));
+	for (start = 0; start < 8; start++) {
+		for (len = 0; len < sizeof(buf) - start; len += 5) {
+			ut_asserteq(crc_ref_reflected32(~0, 0x82f63b78,
+							buf + start, len),
+				    crc32c(~0, buf + start, len));
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_crc32c, 0);
+#endif
+
+static int lib_crc16_ccitt(struct unit_test_state *uts)
+{
+	const u8 *check = (const u8 *)crc_check_str;
+	u8 buf[300];
+	int start, len;
+
+	ut_asserteq(0x31c3, crc16_ccitt(0, check, 9));
+	ut_asserteq(0x29b1, crc16_ccitt(0xffff, check, 9));
+
+	crc_fill(buf, sizeof(buf));
+	for (start = 0; start < 8; start++) {
+		for (len = 0; len < sizeof(buf) - start; len += 5) {
+			ut_asserteq(crc_ref_ccitt(0x1d0f, buf + start, len),
+				    crc16_ccitt(0x1d0f, buf + start, len));
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_crc16_ccitt, 0);
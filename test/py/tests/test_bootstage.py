@@ -65,3 +65,23 @@ def test_bootstage_unstash(u_boot_console):
     u_boot_console.run_command('bootstage unstash %x %x' % (addr, size))
     output = u_boot_console.run_command('echo $?')
     assert output.endswith('0')
+
+@pytest.mark.buildconfigspec('bootstage')
+@pytest.mark.buildconfigspec('cmd_bootstage')
+@pytest.mark.buildconfigspec('bootstage_trace')
+def test_bootstage_trace(u_boot_console):
+    output = u_boot_console.run_command('bootstage trace')
+    lines = [line for line in output.splitlines() if line.strip()]
+    assert lines
+    for line in lines:
+        # A comment reports spans dropped when the array is full
+        if line.startswith('#'):
+            continue
+        stack, self_us = line.rsplit(' ', 1)
+        assert stack
+        assert int(self_us) >= 0
+
+    output = u_boot_console.run_command('bootstage trace json')
+    assert output.startswith('{"traceEvents":[')
+    assert '"cat":"initcall","ph":"X"' in output
+    assert '"name":"root_driver","cat":"probe"' in output
@@ -0,0 +1,121 @@
+# SPDX-License-Identifier: GPL-2.0+
+"""Test logging changes to non-volatile UEFI variables
+
+Changed variables are appended to ubootefi.log, replayed when the variables
+are loaded and merged into ubootefi.var once the log grows too large. A log
+which is left over after merging must not be replayed.
+"""
+
+import os
+import re
+import struct
+import pytest
+from tests import fs_helper
+
+def make_esp(config):
+    """Create a disk image holding an empty EFI system partition
+
+    Args:
+        config (u_boot_config): U-Boot configuration
+
+    Returns:
+        str: Filename of the disk image
+    """
+    fat = fs_helper.mk_fs(config, 'fat16', 0x1000000, 'efi_var_log')
+    image = os.path.join(config.persistent_data_dir, 'efi_var_log.img')
+    start = 2048
+
+    with open(fat, 'rb') as inf:
+        data = inf.read()
+    os.remove(fat)
+
+    # MBR with a single partition of type 0xef (EFI system partition)
+    mbr = bytearray(start * 512)
+    struct.pack_into('<B3sB3sII', mbr, 446, 0, b'', 0xef, b'', start,
+                     len(data) // 512)
+    mbr[510:512] = b'\x55\xaa'
+    with open(image, 'wb') as outf:
+        outf.write(mbr + data)
+    return image
+
+def boot(cons, image):
+    """Restart U-Boot and attach the disk image
+
+    The UEFI variables are loaded from the image by the first UEFI command.
+
+    Args:
+        cons (ConsoleBase): U-Boot console
+        image (str): Filename of the disk image
+    """
+    cons.restart_uboot()
+    cons.run_command(f'host bind 0 {image}')
+
+def log_size(cons):
+    """Get the size of ubootefi.log
+
+    Args:
+        cons (ConsoleBase): U-Boot console
+
+    Returns:
+        int: Size of the log file in bytes
+    """
+    output = cons.run_command('ls host 0:1')
+    match = re.search(r'(\d+)\s+ubootefi\.log', output)
+    assert match
+    return int(match.group(1))
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('efi_variable_file_log')
+@pytest.mark.buildconfigspec('cmd_nvedit_efi')
+@pytest.mark.buildconfigspec('cmd_fat')
+@pytest.mark.buildconfigspec('fat_write')
+@pytest.mark.singlethread
+def test_efi_var_log(u_boot_console):
+    """Test appending to, replaying and merging the UEFI variables log"""
+    cons = u_boot_console
+    image = make_esp(cons.config)
+
+    with cons.log.section('Append'):
+        boot(cons, image)
+        # The first change creates ubootefi.var, later ones are logged
+        cons.run_command('setenv -e -nv -bs -rt TestVar old')
+        cons.run_command('setenv -e -nv -bs -rt TestVar mid')
+        cons.run_command('setenv -e -nv -bs -rt TestDel gone')
+        cons.run_command('setenv -e -nv -bs -rt TestDel')
+        assert log_size(cons)
+
+        # Keep this log to put it back after it has been merged
+        cons.run_command('fatload host 0:1 ${loadaddr} ubootefi.log')
+        cons.run_command(
+            'fatwrite host 0:1 ${loadaddr} saved.log ${filesize}')
+
+    with cons.log.section('Replay'):
+        boot(cons, image)
+        output = cons.run_command('printenv -e TestVar')
+        assert 'mid' in output
+        output = cons.run_command('printenv -e TestDel')
+        assert 'Error: "TestDel" not defined' in output
+
+    with cons.log.section('Merge'):
+        cons.run_command('setenv -e -nv -bs -rt TestVar new')
+
+        # A record larger than the log may grow forces a merge
+        cons.run_command('mw.b ${loadaddr} 0x55 0x1400')
+        cons.run_command(
+            'setenv -e -nv -bs -rt -i ${loadaddr}:0x1400 TestBig')
+        assert not log_size(cons)
+
+        # Pretend that power was lost before the log was cleared
+        cons.run_command('fatload host 0:1 ${loadaddr} saved.log')
+        cons.run_command(
+            'fatwrite host 0:1 ${loadaddr} ubootefi.log ${filesize}')
+        assert log_size(cons)
+
+    with cons.log.section('Stale log'):
+        boot(cons, image)
+        output = cons.run_command('printenv -e TestVar')
+        assert 'new' in output
+        output = cons.run_command('printenv -e TestDel')
+        assert 'Error: "TestDel" not defined' in output
+        output = cons.run_command('printenv -e -n TestBig')
+        assert 'DataSize = 0x1400' in output